@@ -0,0 +1,241 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#ifndef CONFIG_IDF_TARGET_LINUX
+#include "esp_heap_caps.h"
+#endif
+#include "buddy_arena.h"
+
+#define BUDDY_LOCK_TIMEOUT_MS  50
+
+// คู่กับ heap_caps_malloc ใน buddy_arena_create
+static void owned_free(void* mem) {
+#ifdef CONFIG_IDF_TARGET_LINUX
+    free(mem);
+#else
+    heap_caps_free(mem);
+#endif
+}
+
+struct buddy_free_node {
+    buddy_free_node_t* next;
+    buddy_free_node_t* prev;
+};
+
+// meta[idx] ของ min block แรกของแต่ละบล็อก: bit7 = ว่าง, bit0..6 = order+1 (0 = ไม่ใช่หัวบล็อก)
+#define META_FREE   0x80u
+#define META_ORDER  0x7Fu
+
+static inline size_t order_bytes(const buddy_arena_t* a, int k) { return (size_t)1 << (a->min_log2 + k); }
+static inline size_t meta_index(const buddy_arena_t* a, size_t off) { return off >> a->min_log2; }
+
+static void push_free(buddy_arena_t* a, size_t off, int k) {
+    buddy_free_node_t* n = (buddy_free_node_t*)(a->base + off);
+    n->prev = NULL;
+    n->next = a->free_list[k];
+    if (n->next) n->next->prev = n;
+    a->free_list[k] = n;
+    a->free_count[k]++;
+    a->meta[meta_index(a, off)] = META_FREE | (uint8_t)(k + 1);
+    a->free_bytes += order_bytes(a, k);
+}
+
+static void unlink_free(buddy_arena_t* a, size_t off, int k) {
+    buddy_free_node_t* n = (buddy_free_node_t*)(a->base + off);
+    if (n->prev) n->prev->next = n->next;
+    else         a->free_list[k] = n->next;
+    if (n->next) n->next->prev = n->prev;
+    a->free_count[k]--;
+    a->meta[meta_index(a, off)] = 0;
+    a->free_bytes -= order_bytes(a, k);
+}
+
+size_t buddy_arena_meta_size(size_t bytes, uint8_t min_log2) {
+    return bytes >> min_log2;
+}
+
+bool buddy_arena_init(buddy_arena_t* a, void* mem, size_t bytes, uint8_t min_log2, uint8_t* meta) {
+    memset(a, 0, sizeof(*a));
+    if (!mem || !meta || (1u << min_log2) < sizeof(buddy_free_node_t)) return false;
+
+    a->base = (uint8_t*)mem;
+    a->min_log2 = min_log2;
+    a->size = bytes & ~(((size_t)1 << min_log2) - 1);
+    a->meta = meta;
+    memset(meta, 0, buddy_arena_meta_size(a->size, min_log2));
+
+    // order สูงสุดที่ region รองรับ
+    int top = 0;
+    while (top + 1 < BUDDY_MAX_ORDERS && order_bytes(a, top + 1) <= a->size) top++;
+    a->order_count = (uint8_t)(top + 1);
+    if (a->size < order_bytes(a, 0)) return false;
+
+    // หั่น region เป็นบล็อก 2^k ที่ใหญ่ที่สุดที่ align ได้ (รองรับขนาดที่ไม่ใช่ 2^n)
+    size_t off = 0;
+    while (off + order_bytes(a, 0) <= a->size) {
+        int k = top;
+        while (k > 0 && ((off & (order_bytes(a, k) - 1)) || off + order_bytes(a, k) > a->size)) k--;
+        push_free(a, off, k);
+        off += order_bytes(a, k);
+    }
+    return true;
+}
+
+static void* arena_malloc_locked(buddy_arena_t* a, size_t size) {
+    if (size == 0) size = 1;
+    int want = 0;
+    while (want < a->order_count && order_bytes(a, want) < size) want++;
+
+    int k = want;
+    while (k < a->order_count && !a->free_list[k]) k++;
+    if (k >= a->order_count) {
+        a->fail_count++;
+        return NULL;
+    }
+
+    size_t off = (size_t)((uint8_t*)a->free_list[k] - a->base);
+    unlink_free(a, off, k);
+    // split ลงมาจนเหลือ order ที่ต้องการ ครึ่งบนคืนเข้า free list
+    while (k > want) {
+        k--;
+        push_free(a, off + order_bytes(a, k), k);
+    }
+    a->meta[meta_index(a, off)] = (uint8_t)(k + 1);
+
+    size_t used = a->size - a->free_bytes;
+    if (used > a->peak_used) a->peak_used = used;
+    a->alloc_count++;
+    return a->base + off;
+}
+
+static void arena_free_locked(buddy_arena_t* a, void* ptr) {
+    if (!buddy_arena_owns(a, ptr)) return;                                // ไม่ใช่ของ arena
+    size_t off = (size_t)((uint8_t*)ptr - a->base);
+    uint8_t m = a->meta[meta_index(a, off)];
+    if ((m & META_FREE) || !(m & META_ORDER)) return;                    // double free / ไม่ใช่หัวบล็อก
+    int k = (m & META_ORDER) - 1;
+
+    // coalesce กับ buddy ตราบใดที่ buddy ว่างและ order เท่ากัน
+    while (k + 1 < a->order_count) {
+        size_t buddy = off ^ order_bytes(a, k);
+        if (buddy + order_bytes(a, k) > a->size) break;
+        if (a->meta[meta_index(a, buddy)] != (META_FREE | (uint8_t)(k + 1))) break;
+        unlink_free(a, buddy, k);
+        a->meta[meta_index(a, off)] = 0;
+        if (buddy < off) off = buddy;
+        k++;
+    }
+    push_free(a, off, k);
+}
+
+static inline bool arena_lock_wait(buddy_arena_t* a, TickType_t wait) {
+    return !a->lock || xSemaphoreTake(a->lock, wait) == pdTRUE;
+}
+
+static inline bool arena_lock(buddy_arena_t* a) {
+    return arena_lock_wait(a, pdMS_TO_TICKS(BUDDY_LOCK_TIMEOUT_MS));
+}
+
+static inline void arena_unlock(buddy_arena_t* a) {
+    if (a->lock) xSemaphoreGive(a->lock);
+}
+
+void* buddy_arena_malloc(buddy_arena_t* a, size_t size) {
+    if (!arena_lock(a)) return NULL;
+    void* p = arena_malloc_locked(a, size);
+    arena_unlock(a);
+    return p;
+}
+
+void buddy_arena_free(buddy_arena_t* a, void* ptr) {
+    if (!ptr) return;
+    // free ล้มเหลวไม่ได้ (ผู้เรียกไม่มีทาง retry) -> รอ lock จนได้ ไม่งั้นบล็อกรั่วเงียบ ๆ
+    arena_lock_wait(a, portMAX_DELAY);
+    arena_free_locked(a, ptr);
+    arena_unlock(a);
+}
+
+bool buddy_arena_owns(const buddy_arena_t* a, const void* ptr) {
+    return (const uint8_t*)ptr >= a->base && (const uint8_t*)ptr < a->base + a->size;
+}
+
+size_t buddy_arena_block_size(const buddy_arena_t* a, const void* ptr) {
+    if (!buddy_arena_owns(a, ptr)) return 0;
+    size_t off = (size_t)((const uint8_t*)ptr - a->base);
+    uint8_t m = a->meta[meta_index(a, off)];
+    return (m & META_ORDER) ? order_bytes(a, (m & META_ORDER) - 1) : 0;
+}
+
+size_t buddy_arena_largest_free(const buddy_arena_t* a) {
+    for (int k = a->order_count - 1; k >= 0; k--) {
+        if (a->free_list[k]) return order_bytes(a, k);
+    }
+    return 0;
+}
+
+// ===== Boot-time arena =====
+bool buddy_arena_create(buddy_arena_t* a, size_t bytes, uint8_t min_log2, uint32_t caps) {
+    size_t meta = buddy_arena_meta_size(bytes, min_log2);
+#ifdef CONFIG_IDF_TARGET_LINUX
+    (void)caps;
+    uint8_t* mem = malloc(bytes + meta);
+#else
+    uint8_t* mem = heap_caps_malloc(bytes + meta, caps);
+#endif
+    if (!mem) return false;
+    // region ก้อนเดียว: [ blocks ... | meta ]
+    if (!buddy_arena_init(a, mem, bytes, min_log2, mem + bytes)) {
+        owned_free(mem);
+        return false;
+    }
+    a->owned_mem = mem;
+    a->lock = xSemaphoreCreateMutex();
+    if (!a->lock) {
+        buddy_arena_destroy(a);
+        return false;
+    }
+    return true;
+}
+
+void buddy_arena_destroy(buddy_arena_t* a) {
+    if (a->lock) vSemaphoreDelete(a->lock);
+    owned_free(a->owned_mem);
+    memset(a, 0, sizeof(*a));
+}
+
+// ===== Per-order view =====
+void buddy_arena_get_stats(buddy_arena_t* a, buddy_arena_stats_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (!arena_lock(a)) return;
+    out->order_count = a->order_count;
+    for (int k = 0; k < a->order_count; k++) {
+        out->block_bytes[k] = order_bytes(a, k);
+        out->free_blocks[k] = a->free_count[k];
+    }
+    out->total_bytes  = a->size;
+    out->free_bytes   = a->free_bytes;
+    out->largest_free = buddy_arena_largest_free(a);
+    out->peak_used    = a->peak_used;
+    out->alloc_count  = a->alloc_count;
+    out->fail_count   = a->fail_count;
+    arena_unlock(a);
+}
+
+void buddy_arena_log_orders(buddy_arena_t* a, const char* tag) {
+    buddy_arena_stats_t st;
+    buddy_arena_get_stats(a, &st);
+    float frag = 0.0f;
+    if (st.free_bytes > 0 && st.largest_free > 0) {
+        frag = (1.0f - (float)st.largest_free / (float)st.free_bytes) * 100.0f;
+    }
+    ESP_LOGI(tag, "Buddy arena: free %u/%u bytes, largest %u, frag %.1f%%, peak used %u, allocs %lu, fails %lu",
+             (unsigned)st.free_bytes, (unsigned)st.total_bytes, (unsigned)st.largest_free, frag,
+             (unsigned)st.peak_used, (unsigned long)st.alloc_count, (unsigned long)st.fail_count);
+    for (int k = st.order_count - 1; k >= 0; k--) {
+        if (st.free_blocks[k] == 0) continue;
+        ESP_LOGI(tag, "  order %2d (%6u B): %3lu free  = %u bytes",
+                 k, (unsigned)st.block_bytes[k], (unsigned long)st.free_blocks[k],
+                 (unsigned)(st.block_bytes[k] * st.free_blocks[k]));
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef BUDDY_ARENA_H
+#define BUDDY_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Buddy allocator บน region เดียว: บล็อกขนาด 2^k, split ตอนจอง / coalesce ตอนคืน
+// ขนาด order เก็บใน side table (ไม่มี header) บัฟเฟอร์ 1/2/4/8/16 KB จึงพอดีบล็อก
+// alloc/free = O(log n) ตามจำนวน order
+
+#define BUDDY_MAX_ORDERS  20
+
+typedef struct buddy_free_node buddy_free_node_t;
+
+typedef struct {
+    uint8_t*           base;
+    size_t             size;            // ขนาด region ที่ใช้ได้จริง
+    uint8_t            min_log2;        // order 0 = 2^min_log2 bytes
+    uint8_t            order_count;
+    uint8_t*           meta;            // 1 byte ต่อ min block
+    buddy_free_node_t* free_list[BUDDY_MAX_ORDERS];
+    uint32_t           free_count[BUDDY_MAX_ORDERS];
+    SemaphoreHandle_t  lock;            // NULL = ผู้เรียกดูแล concurrency เอง
+    void*              owned_mem;       // region ที่ buddy_arena_create() จองให้
+    // stats
+    size_t             free_bytes;
+    size_t             peak_used;
+    uint32_t           alloc_count;
+    uint32_t           fail_count;
+} buddy_arena_t;
+
+// มุมมองต่อ order: อธิบายได้ว่าทำไมจองบล็อกใหญ่ไม่ได้ทั้งที่ free_bytes ยังเหลือ
+typedef struct {
+    uint8_t  order_count;
+    size_t   block_bytes[BUDDY_MAX_ORDERS];
+    uint32_t free_blocks[BUDDY_MAX_ORDERS];
+    size_t   total_bytes;
+    size_t   free_bytes;
+    size_t   largest_free;
+    size_t   peak_used;
+    uint32_t alloc_count;
+    uint32_t fail_count;
+} buddy_arena_stats_t;
+
+// ===== Raw arena (ผู้เรียกเตรียมหน่วยความจำเอง, ไม่มี lock) =====
+size_t buddy_arena_meta_size(size_t bytes, uint8_t min_log2);
+bool   buddy_arena_init(buddy_arena_t* a, void* mem, size_t bytes, uint8_t min_log2, uint8_t* meta);
+
+// ===== Boot-time arena: จอง region ก้อนเดียว + mutex =====
+bool   buddy_arena_create(buddy_arena_t* a, size_t bytes, uint8_t min_log2, uint32_t caps);
+void   buddy_arena_destroy(buddy_arena_t* a);
+
+void*  buddy_arena_malloc(buddy_arena_t* a, size_t size);
+void   buddy_arena_free(buddy_arena_t* a, void* ptr);
+bool   buddy_arena_owns(const buddy_arena_t* a, const void* ptr);
+size_t buddy_arena_block_size(const buddy_arena_t* a, const void* ptr);
+size_t buddy_arena_largest_free(const buddy_arena_t* a);
+void   buddy_arena_get_stats(buddy_arena_t* a, buddy_arena_stats_t* out);
+void   buddy_arena_log_orders(buddy_arena_t* a, const char* tag);
+
+#endif
@@ -0,0 +1,83 @@
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "event_dispatch.h"
+
+void event_dispatch_init(event_dispatcher_t* d, QueueSetHandle_t set) {
+    memset(d, 0, sizeof(*d));
+    d->set = set;
+}
+
+event_source_t* event_dispatch_add(event_dispatcher_t* d, const char* name, QueueSetMemberHandle_t member,
+                                   event_handle_fn_t handle, void* arg) {
+    if (d->count >= EVENT_DISPATCH_MAX_SOURCES || !member || !handle) return NULL;
+    if (xQueueAddToSet(member, d->set) != pdPASS) return NULL;
+
+    event_source_t* src = &d->sources[d->count++];
+    memset(src, 0, sizeof(*src));
+    src->name = name;
+    src->member = member;
+    src->handle = handle;
+    src->arg = arg;
+    lat_hist_init(&src->latency);
+    return src;
+}
+
+static event_source_t* find_source(event_dispatcher_t* d, QueueSetMemberHandle_t member) {
+    for (uint32_t i = 0; i < d->count; i++) {
+        if (d->sources[i].member == member) return &d->sources[i];
+    }
+    return NULL;
+}
+
+uint32_t event_dispatch_run_once(event_dispatcher_t* d, TickType_t wait) {
+    QueueSetMemberHandle_t member = xQueueSelectFromSet(d->set, wait);
+    if (!member) return 0;
+    d->wakes++;
+    int64_t t_wake = esp_timer_get_time();
+
+    uint32_t total = 0;
+    while (member) {
+        d->selects++;
+        event_source_t* src = find_source(d, member);
+        if (src) {
+            int64_t t0 = esp_timer_get_time();
+            if (src->handle(src)) {
+                src->events++;
+                total++;
+            }
+            src->busy_us += esp_timer_get_time() - t0;
+        }
+        member = xQueueSelectFromSet(d->set, 0);     // ของที่มาระหว่างนี้: ไม่ block ไม่ต้องตื่นใหม่
+    }
+
+    if (total == 0) d->empty_wakes++;
+    d->busy_us += esp_timer_get_time() - t_wake;
+    return total;
+}
+
+void event_dispatch_log(event_dispatcher_t* d, const char* tag, float interval_s) {
+    float span_us = interval_s * 1e6f;
+    uint32_t d_wakes = d->wakes - d->last_wakes;
+    ESP_LOGI(tag, "Dispatcher: wakes %lu (empty %lu) | %.2f wakes/s, %.2f selects/wake, cpu %.2f%%",
+             (unsigned long)d->wakes, (unsigned long)d->empty_wakes,
+             interval_s > 0 ? d_wakes / interval_s : 0.0f,
+             d_wakes ? (float)(d->selects - d->last_selects) / d_wakes : 0.0f,
+             span_us > 0 ? 100.0f * (float)(d->busy_us - d->last_busy_us) / span_us : 0.0f);
+    d->last_wakes = d->wakes;
+    d->last_selects = d->selects;
+    d->last_busy_us = d->busy_us;
+    for (uint32_t i = 0; i < d->count; i++) {
+        event_source_t* src = &d->sources[i];
+        uint32_t events = src->events;
+        lat_hist_snapshot_t snap;
+        lat_hist_snapshot(&src->latency, &snap, true);
+        ESP_LOGI(tag, "  %-8s %6.2f ev/s  total %lu  cpu %.2f%%  latency p50 %.1fms p99 %.1fms max %.1fms",
+                 src->name, interval_s > 0 ? (events - src->last_events) / interval_s : 0.0f,
+                 (unsigned long)events,
+                 span_us > 0 ? 100.0f * (float)(src->busy_us - src->last_busy_us) / span_us : 0.0f,
+                 snap.p50_us / 1000.0, snap.p99_us / 1000.0, snap.max_us / 1000.0);
+        src->last_events = events;
+        src->last_busy_us = src->busy_us;
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef EVENT_DISPATCH_H
+#define EVENT_DISPATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "lat_hist.h"
+
+// Event dispatcher บน queue set แบบ table-driven
+//   แต่ละ source ลงทะเบียน member handle + handler ที่รับและประมวลผล 1 ชิ้น
+//   ตื่นหนึ่งครั้ง (select แบบรอ) -> วน select แบบไม่รอต่อจน set ว่าง แล้วค่อยกลับไป block
+//   -> burst หลายชิ้นจากหลาย source ใช้การตื่นครั้งเดียว
+// สัญญาของ queue set: select ได้ handle 1 ครั้ง = รับจาก member นั้น 1 ชิ้นพอดี
+//   (ดึงเกินจะเหลือ handle ค้าง สะสมจน set ล้น -> configASSERT ใน xQueueGenericSend)
+//   ลำดับใน set คือลำดับที่ของเข้ามา -> source ที่ burst หนักแซงของที่มาก่อนจาก source อื่นไม่ได้
+// ไม่มี quantum ต่อ source (round-robin ทีละ quantum แบบเดิมต้องดึงหลายชิ้นต่อ select ซึ่งผิดสัญญาข้างบน)
+//   ความ fair มาจาก set ที่เป็น FIFO แทน: ของที่มาก่อนได้ก่อนเสมอ ไม่ว่ามาจาก source ไหน
+//   ข้อแลกคือ source ที่ burst ยังกิน CPU ได้ตามสัดส่วนของที่ส่งเข้ามา -> ดู busy_us/latency ต่อ source
+// handler บันทึก latency ของแต่ละชิ้นลง src->latency เอง (ต้องรู้ timestamp ของข้อมูลตัวเอง)
+
+#define EVENT_DISPATCH_MAX_SOURCES  8
+
+typedef struct event_source event_source_t;
+
+// รับ 1 ชิ้นแบบไม่รอแล้วประมวลผล; false = member ว่าง (handle ค้างจากของที่ถูกดึงไปทางอื่น)
+typedef bool (*event_handle_fn_t)(event_source_t* src);
+
+struct event_source {
+    const char*            name;
+    QueueSetMemberHandle_t member;
+    event_handle_fn_t      handle;
+    void*                  arg;
+    // stats
+    uint32_t               events;
+    uint32_t               last_events;     // สำหรับคำนวณ events/s ตอน log
+    int64_t                busy_us;         // เวลาใน handler รวม (CPU share ของ source)
+    int64_t                last_busy_us;
+    lat_hist_t             latency;         // เวลาตั้งแต่ข้อมูลเกิดจนถึง handler
+};
+
+typedef struct {
+    QueueSetHandle_t set;
+    event_source_t   sources[EVENT_DISPATCH_MAX_SOURCES];
+    uint32_t         count;
+    // stats
+    uint32_t         wakes;
+    uint32_t         empty_wakes;           // ตื่นจาก handle ค้าง ไม่มีของจริง
+    uint32_t         selects;               // handle ที่ได้จาก set ทั้งหมด (รวมแบบไม่รอ)
+    int64_t          busy_us;               // ตั้งแต่ตื่นจาก select จนระบายเสร็จ
+    uint32_t         last_wakes;
+    uint32_t         last_selects;
+    int64_t          last_busy_us;
+} event_dispatcher_t;
+
+void            event_dispatch_init(event_dispatcher_t* d, QueueSetHandle_t set);
+// member ต้องยังว่างอยู่ (ข้อกำหนดของ xQueueAddToSet); คืน NULL ถ้าเต็มหรือ add ไม่ได้
+event_source_t* event_dispatch_add(event_dispatcher_t* d, const char* name, QueueSetMemberHandle_t member,
+                                   event_handle_fn_t handle, void* arg);
+
+// รอ select แล้วรับทีละชิ้นตาม handle ที่ได้จนกว่า set จะว่าง; คืนจำนวน event ที่ทำได้ (0 = timeout หรือ empty wake)
+uint32_t        event_dispatch_run_once(event_dispatcher_t* d, TickType_t wait);
+
+// log wakes/s, events ต่อการตื่น + CPU share ของ dispatcher และ events/s, CPU share, latency p50/p99/max ต่อ source
+// ของช่วงที่ผ่านมา (reset histogram)
+void            event_dispatch_log(event_dispatcher_t* d, const char* tag, float interval_s);
+
+#endif
@@ -0,0 +1,114 @@
+#include <string.h>
+#include "flow_ctl.h"
+
+void flow_ctl_init(flow_ctl_t* fc, void* q, flow_try_fn_t try_send, flow_try_fn_t try_evict,
+                   int32_t credits, flow_shed_t policy) {
+    atomic_init(&fc->credits, credits);
+    fc->q = q;
+    fc->try_send = try_send;
+    fc->try_evict = try_evict;
+    fc->policy = policy;
+}
+
+void flow_grant(flow_ctl_t* fc, uint32_t n) {
+    atomic_fetch_add_explicit(&fc->credits, (int32_t)n, memory_order_release);
+}
+
+int32_t flow_credits(const flow_ctl_t* fc) {
+    return atomic_load_explicit(&((flow_ctl_t*)fc)->credits, memory_order_relaxed);
+}
+
+static bool take_credit(flow_ctl_t* fc) {
+    int32_t c = atomic_load_explicit(&fc->credits, memory_order_relaxed);
+    while (c > 0) {
+        if (atomic_compare_exchange_weak_explicit(&fc->credits, &c, c - 1,
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void flow_producer_init(flow_producer_t* p, flow_ctl_t* fc, void* pending, uint32_t item_size,
+                        uint32_t backoff_step_ms, uint32_t backoff_max_ms) {
+    memset(p, 0, sizeof(*p));
+    p->fc = fc;
+    p->pending = pending;
+    p->item_size = item_size;
+    p->backoff_step_ms = backoff_step_ms;
+    p->backoff_max_ms = backoff_max_ms;
+}
+
+// AIMD: credit หมด -> หน่วงเพิ่มเท่าตัว, ส่งได้ -> ลดลงทีละ step
+static void pace_ok(flow_producer_t* p) {
+    p->backoff_ms = p->backoff_ms > p->backoff_step_ms ? p->backoff_ms - p->backoff_step_ms : 0;
+}
+
+static void pace_backoff(flow_producer_t* p) {
+    uint32_t next = p->backoff_ms ? p->backoff_ms * 2 : p->backoff_step_ms;
+    p->backoff_ms = next > p->backoff_max_ms ? p->backoff_max_ms : next;
+    p->no_credit++;
+}
+
+static bool send_with_credit(flow_producer_t* p, const void* item) {
+    flow_ctl_t* fc = p->fc;
+    if (!take_credit(fc)) return false;
+    if (fc->try_send(fc->q, (void*)item)) {
+        p->sent++;
+        return true;
+    }
+    flow_grant(fc, 1);      // คิวมีผู้เขียนอื่นนอก flow control -> คืน credit
+    return false;
+}
+
+bool flow_send(flow_producer_t* p, const void* item) {
+    flow_ctl_t* fc = p->fc;
+
+    if (p->has_pending) {
+        if (!send_with_credit(p, p->pending)) {
+            // ยังไม่มี credit: ชิ้นใหม่ทับชิ้นที่พัก
+            memcpy(p->pending, item, p->item_size);
+            p->shed++;
+            pace_backoff(p);
+            return false;
+        }
+        p->has_pending = false;
+    }
+
+    if (send_with_credit(p, item)) {
+        pace_ok(p);
+        return true;
+    }
+    pace_backoff(p);
+
+    switch (fc->policy) {
+        case FLOW_SHED_DROP_OLDEST:
+            // ชิ้นที่ถูกไล่คืนที่ในคิว -> ใช้ที่นั้นแทน credit
+            if (fc->try_evict && fc->try_evict(fc->q, p->pending)) {
+                p->shed++;
+                if (fc->try_send(fc->q, (void*)item)) {
+                    p->sent++;
+                    return true;
+                }
+                flow_grant(fc, 1);
+            }
+            break;
+        case FLOW_SHED_COALESCE:
+            memcpy(p->pending, item, p->item_size);
+            p->has_pending = true;
+            return false;
+        default:
+            break;
+    }
+    p->shed++;
+    return false;
+}
+
+const char* flow_shed_name(flow_shed_t policy) {
+    switch (policy) {
+        case FLOW_SHED_DROP_NEWEST: return "drop-newest";
+        case FLOW_SHED_DROP_OLDEST: return "drop-oldest";
+        case FLOW_SHED_COALESCE:    return "coalesce";
+    }
+    return "?";
+}
@@ -0,0 +1,61 @@
+#ifndef FLOW_CTL_H
+#define FLOW_CTL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Credit-based flow control วางหน้าคิวใดก็ได้ (xQueue, mpmc_queue, ...)
+//   credit 1 ใบ = สิทธิ์ส่ง 1 ชิ้น, เริ่มต้นเท่าความจุคิว
+//   producer ใช้ credit ตอนส่ง, consumer คืน credit (flow_grant) เมื่อทำชิ้นนั้นเสร็จ
+//   -> producer ไม่ต้อง block รอคิวหรือยิงใส่คิวเต็มซ้ำ ๆ
+// เมื่อ credit หมด: producer ชะลอตัวเอง (backoff เพิ่มเป็นเท่าตัว, ลดทีละ step เมื่อส่งได้)
+// แล้วจัดการชิ้นที่ส่งไม่ได้ตาม shed policy
+
+typedef enum {
+    FLOW_SHED_DROP_NEWEST = 0,  // ทิ้งชิ้นใหม่ (เหมือน send timeout 0 เดิม)
+    FLOW_SHED_DROP_OLDEST,      // ไล่ชิ้นเก่าสุดออกจากคิว แล้วใช้ที่ของมันส่งชิ้นใหม่
+    FLOW_SHED_COALESCE,         // พักชิ้นล่าสุดไว้ 1 ชิ้นต่อ producer (ชิ้นใหม่ทับชิ้นที่พัก) ส่งเมื่อมี credit
+} flow_shed_t;
+
+// ส่ง/ดึงออกแบบไม่รอ; q คือ pointer ที่ให้ไว้ตอน init
+typedef bool (*flow_try_fn_t)(void* q, void* item);
+
+typedef struct {
+    _Atomic int32_t credits;
+    void*           q;
+    flow_try_fn_t   try_send;
+    flow_try_fn_t   try_evict;      // ใช้กับ DROP_OLDEST; NULL = ตกไปเป็น drop newest
+    flow_shed_t     policy;
+} flow_ctl_t;
+
+typedef struct {
+    flow_ctl_t* fc;
+    void*       pending;            // buffer ขนาด item_size: ช่องพัก coalesce / ที่ทิ้งชิ้นที่ถูกไล่
+    uint32_t    item_size;
+    bool        has_pending;
+    uint32_t    backoff_ms;         // เวลาหน่วงเพิ่มจากจังหวะปกติของ producer
+    uint32_t    backoff_step_ms;
+    uint32_t    backoff_max_ms;
+    // stats (ของ producer นี้)
+    uint32_t    sent;
+    uint32_t    shed;               // ชิ้นที่หายไป: ถูกทิ้ง, ถูกไล่, หรือถูก coalesce ทับ
+    uint32_t    no_credit;          // ครั้งที่ขอ credit ไม่ได้
+} flow_producer_t;
+
+void    flow_ctl_init(flow_ctl_t* fc, void* q, flow_try_fn_t try_send, flow_try_fn_t try_evict,
+                      int32_t credits, flow_shed_t policy);
+void    flow_grant(flow_ctl_t* fc, uint32_t n);                    // consumer คืน credit
+int32_t flow_credits(const flow_ctl_t* fc);
+
+void    flow_producer_init(flow_producer_t* p, flow_ctl_t* fc, void* pending, uint32_t item_size,
+                           uint32_t backoff_step_ms, uint32_t backoff_max_ms);
+
+// true = ชิ้นนี้เข้าคิวแล้ว; false = ถูกทิ้งหรือถูกพักไว้ (ดู has_pending)
+// ถ้ามีชิ้นที่พักไว้จะลองส่งชิ้นนั้นก่อน
+bool    flow_send(flow_producer_t* p, const void* item);
+static inline uint32_t flow_backoff_ms(const flow_producer_t* p) { return p->backoff_ms; }
+
+const char* flow_shed_name(flow_shed_t policy);
+
+#endif
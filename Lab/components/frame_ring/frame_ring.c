@@ -0,0 +1,167 @@
+#include <stdlib.h>
+#include <string.h>
+#include "frame_ring.h"
+
+#define WRAP_MARKER  0xFFFFFFFFu
+
+static inline uint32_t next_pow2(uint32_t x) {
+    uint32_t p = 1;
+    while (p < x) p <<= 1;
+    return p;
+}
+
+bool frame_ring_create(frame_ring_t* r, uint32_t size_bytes) {
+    memset(r, 0, sizeof(*r));
+    if (size_bytes < 4 * FRAME_RING_HDR) return false;
+    r->size = next_pow2(size_bytes);
+    r->mask = r->size - 1;
+    r->buf = malloc(r->size);
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    atomic_init(&r->consumer_wait, NULL);
+    atomic_init(&r->producer_wait, NULL);
+    return r->buf != NULL;
+}
+
+void frame_ring_destroy(frame_ring_t* r) {
+    free(r->buf);
+    memset(r, 0, sizeof(*r));
+}
+
+uint32_t frame_ring_max_payload(const frame_ring_t* r) {
+    return r->size / 2 - FRAME_RING_HDR;
+}
+
+static inline void wake(_Atomic(TaskHandle_t)* slot) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(slot, memory_order_relaxed) != NULL) {
+        TaskHandle_t t = atomic_exchange_explicit(slot, NULL, memory_order_acq_rel);
+        if (t) xTaskNotifyGive(t);
+    }
+}
+
+static inline void put_hdr(frame_ring_t* r, uint32_t pos, uint32_t v) {
+    memcpy(r->buf + pos, &v, sizeof(v));
+}
+
+static inline uint32_t get_hdr(const frame_ring_t* r, uint32_t pos) {
+    uint32_t v;
+    memcpy(&v, r->buf + pos, sizeof(v));
+    return v;
+}
+
+// ===== Producer side =====
+bool frame_ring_try_send(frame_ring_t* r, const void* data, uint32_t len) {
+    if (len > frame_ring_max_payload(r)) return false;
+    uint32_t rec = frame_ring_record_bytes(len);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t pos = head & r->mask;
+    uint32_t to_end = r->size - pos;
+    uint32_t need = rec <= to_end ? rec : to_end + rec;      // รวม padding ท้าย ring
+
+    if (r->size - (head - r->cached_tail) < need) {
+        r->cached_tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+        if (r->size - (head - r->cached_tail) < need) return false;
+    }
+    if (rec > to_end) {
+        put_hdr(r, pos, WRAP_MARKER);
+        head += to_end;
+        pos = 0;
+    }
+    put_hdr(r, pos, len);
+    memcpy(r->buf + pos + FRAME_RING_HDR, data, len);
+    atomic_store_explicit(&r->head, head + rec, memory_order_release);
+    wake(&r->consumer_wait);
+    return true;
+}
+
+// ===== Consumer side =====
+const void* frame_ring_peek(frame_ring_t* r, uint32_t* len) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    if (tail == r->cached_head) {
+        r->cached_head = atomic_load_explicit(&r->head, memory_order_acquire);
+        if (tail == r->cached_head) return NULL;
+    }
+    uint32_t pos = tail & r->mask;
+    uint32_t hdr = get_hdr(r, pos);
+    if (hdr == WRAP_MARKER) {
+        // ข้าม padding ท้าย ring; record จริงอยู่ที่ offset 0 (producer publish พร้อมกันแล้ว)
+        tail += r->size - pos;
+        atomic_store_explicit(&r->tail, tail, memory_order_release);
+        pos = 0;
+        hdr = get_hdr(r, 0);
+    }
+    if (len) *len = hdr;
+    return r->buf + pos + FRAME_RING_HDR;
+}
+
+void frame_ring_consume(frame_ring_t* r) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t len = get_hdr(r, tail & r->mask);
+    atomic_store_explicit(&r->tail, tail + frame_ring_record_bytes(len), memory_order_release);
+    wake(&r->producer_wait);
+}
+
+// ===== Blocking =====
+// ประกาศตัวใน slot -> ลองอีกครั้ง -> รอ notification (เหมือน spsc_ring)
+static bool wait_turn(TickType_t start, TickType_t wait, uint32_t* wait_count) {
+    TickType_t remaining = portMAX_DELAY;
+    if (wait != portMAX_DELAY) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= wait) return false;
+        remaining = wait - elapsed;
+    }
+    (*wait_count)++;
+    ulTaskNotifyTake(pdTRUE, remaining);
+    return true;
+}
+
+BaseType_t frame_ring_send(frame_ring_t* r, const void* data, uint32_t len, TickType_t wait) {
+    if (frame_ring_try_send(r, data, len)) return pdPASS;
+    if (wait == 0 || len > frame_ring_max_payload(r)) return pdFAIL;
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TickType_t start = xTaskGetTickCount();
+    BaseType_t ok = pdFAIL;
+    do {
+        atomic_store_explicit(&r->producer_wait, self, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (frame_ring_try_send(r, data, len)) {
+            ok = pdPASS;
+            break;
+        }
+    } while (wait_turn(start, wait, &r->full_waits));
+    atomic_store_explicit(&r->producer_wait, NULL, memory_order_relaxed);
+    return ok;
+}
+
+const void* frame_ring_peek_wait(frame_ring_t* r, uint32_t* len, TickType_t wait) {
+    const void* p = frame_ring_peek(r, len);
+    if (p || wait == 0) return p;
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TickType_t start = xTaskGetTickCount();
+    do {
+        atomic_store_explicit(&r->consumer_wait, self, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if ((p = frame_ring_peek(r, len)) != NULL) break;
+    } while (wait_turn(start, wait, &r->empty_waits));
+    atomic_store_explicit(&r->consumer_wait, NULL, memory_order_relaxed);
+    return p;
+}
+
+BaseType_t frame_ring_receive(frame_ring_t* r, void* out, uint32_t max_len, uint32_t* len, TickType_t wait) {
+    uint32_t n;
+    const void* p = frame_ring_peek_wait(r, &n, wait);
+    if (!p || n > max_len) return pdFAIL;
+    memcpy(out, p, n);
+    frame_ring_consume(r);
+    if (len) *len = n;
+    return pdPASS;
+}
+
+uint32_t frame_ring_used_bytes(const frame_ring_t* r) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    return head - tail;
+}
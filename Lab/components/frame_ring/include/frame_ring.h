@@ -0,0 +1,59 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Ring ของ record ความยาวไม่คงที่ (length-prefixed) สำหรับ producer 1 ตัว + consumer 1 ตัว
+//   record = header 4 byte (ความยาว) + payload ปัดขึ้นให้ลง 4 byte -> เก็บเฉพาะ byte ที่ใช้จริง
+//   record ไม่ถูกตัดข้ามขอบ ring: ถ้าท้าย ring ไม่พอ จะใส่ wrap marker แล้วเริ่มที่ต้น ring
+//   -> consumer อ่าน payload ได้ในที่ (peek) โดยไม่ต้อง copy แล้วค่อย consume
+// ordering/การรอ เหมือน spsc_ring: release/acquire บน head/tail, block ด้วย task notification (index 0)
+// payload ยาวสุด = size/2 - 4 (รับประกันว่ามีที่พอเสมอเมื่อ ring ว่าง ไม่ว่า head อยู่ตรงไหน)
+
+#define FRAME_RING_CACHE_LINE  32
+#define FRAME_RING_HDR         4
+
+typedef struct {
+    // --- producer line ---
+    _Atomic uint32_t head;                  // byte offset ถัดไปที่จะเขียน (free-running)
+    uint32_t         cached_tail;
+    uint32_t         full_waits;
+    uint8_t          _pad0[FRAME_RING_CACHE_LINE - 3 * sizeof(uint32_t)];
+    // --- consumer line ---
+    _Atomic uint32_t tail;                  // byte offset ถัดไปที่จะอ่าน (free-running)
+    uint32_t         cached_head;
+    uint32_t         empty_waits;
+    uint8_t          _pad1[FRAME_RING_CACHE_LINE - 3 * sizeof(uint32_t)];
+    // --- อ่านอย่างเดียวหลัง create ---
+    _Atomic(TaskHandle_t) consumer_wait;
+    _Atomic(TaskHandle_t) producer_wait;
+    uint8_t*         buf;
+    uint32_t         size;                  // 2^n bytes
+    uint32_t         mask;
+} __attribute__((aligned(FRAME_RING_CACHE_LINE))) frame_ring_t;
+
+bool        frame_ring_create(frame_ring_t* r, uint32_t size_bytes);   // ปัดขึ้นเป็น 2^n
+void        frame_ring_destroy(frame_ring_t* r);
+uint32_t    frame_ring_max_payload(const frame_ring_t* r);
+static inline uint32_t frame_ring_record_bytes(uint32_t len) { return FRAME_RING_HDR + ((len + 3) & ~3u); }
+
+// producer
+bool        frame_ring_try_send(frame_ring_t* r, const void* data, uint32_t len);
+BaseType_t  frame_ring_send(frame_ring_t* r, const void* data, uint32_t len, TickType_t wait);
+
+// consumer: peek คืน pointer ไปยัง payload ใน ring (ใช้ได้จนกว่าจะ consume) หรือ NULL ถ้าว่าง
+const void* frame_ring_peek(frame_ring_t* r, uint32_t* len);
+const void* frame_ring_peek_wait(frame_ring_t* r, uint32_t* len, TickType_t wait);
+void        frame_ring_consume(frame_ring_t* r);
+// copy ออก (peek + memcpy + consume); out เล็กกว่า record -> คืน pdFAIL และ record ยังอยู่
+BaseType_t  frame_ring_receive(frame_ring_t* r, void* out, uint32_t max_len, uint32_t* len, TickType_t wait);
+
+uint32_t    frame_ring_used_bytes(const frame_ring_t* r);
+
+#endif
@@ -0,0 +1,315 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#ifndef CONFIG_IDF_TARGET_LINUX
+#include "esp_heap_caps.h"
+#endif
+#include "handle_heap.h"
+
+static const char *TAG = "HANDLE_HEAP";
+
+// ===== Block layout =====
+// region = [hdr|payload][hdr|payload]... ต่อกันตลอด; handle = 0 คือบล็อกว่าง
+typedef struct {
+    uint32_t size;          // payload (align 8)
+    uint16_t handle;
+    uint16_t magic;
+} hh_block_t;
+
+#define HH_ALIGN          8
+#define HH_HDR            ((uint32_t)sizeof(hh_block_t))
+#define HH_MAGIC          0xB10C
+#define HH_LOCK_TIMEOUT   pdMS_TO_TICKS(100)
+#define HH_STEP_MOVES     4         // จำนวนบล็อกที่ย้ายต่อการถือ lock หนึ่งครั้ง
+
+static inline uint32_t align8(size_t x) { return (uint32_t)((x + HH_ALIGN - 1) & ~(size_t)(HH_ALIGN - 1)); }
+static inline hh_block_t* blk_at(const handle_heap_t* h, uint32_t off) { return (hh_block_t*)(h->base + off); }
+
+static void write_free(handle_heap_t* h, uint32_t off, uint32_t payload) {
+    hh_block_t* b = blk_at(h, off);
+    b->size = payload;
+    b->handle = 0;
+    b->magic = HH_MAGIC;
+}
+
+static inline hh_entry_t* entry_of(handle_heap_t* h, hh_handle_t hd) {
+    if (hd == HH_INVALID_HANDLE || hd > h->table_len) return NULL;
+    hh_entry_t* e = &h->table[hd - 1];
+    return e->in_use ? e : NULL;
+}
+
+// รวมบล็อกว่างที่อยู่ติดกันเข้ากับ b
+static void coalesce_forward(handle_heap_t* h, uint32_t off) {
+    hh_block_t* b = blk_at(h, off);
+    uint32_t next = off + HH_HDR + b->size;
+    while (next < h->size && blk_at(h, next)->handle == 0) {
+        b->size += HH_HDR + blk_at(h, next)->size;
+        next = off + HH_HDR + b->size;
+    }
+}
+
+static size_t largest_free_locked(const handle_heap_t* h, size_t* free_total) {
+    size_t best = 0, total = 0, run = 0;
+    bool in_run = false;
+    for (uint32_t off = 0; off < h->size; off += HH_HDR + blk_at(h, off)->size) {
+        const hh_block_t* b = blk_at(h, off);
+        if (b->handle == 0) {
+            // บล็อกว่างติดกันหลายก้อนนับเป็นช่องเดียว (header ที่ถูกรวมกลายเป็นพื้นที่ใช้ได้)
+            run += in_run ? HH_HDR + b->size : b->size;
+            total += b->size;
+            in_run = true;
+            if (run > best) best = run;
+        } else {
+            in_run = false;
+            run = 0;
+        }
+    }
+    if (free_total) *free_total = total;
+    return best;
+}
+
+// ===== Create / destroy =====
+bool handle_heap_create(handle_heap_t* h, size_t bytes, uint16_t max_handles, uint32_t caps) {
+    memset(h, 0, sizeof(*h));
+    bytes &= ~(size_t)(HH_ALIGN - 1);
+    if (bytes < 2 * HH_HDR || max_handles == 0) return false;
+#ifdef CONFIG_IDF_TARGET_LINUX
+    (void)caps;
+    h->base = malloc(bytes);
+#else
+    h->base = heap_caps_malloc(bytes, caps);
+#endif
+    h->table = calloc(max_handles, sizeof(hh_entry_t));
+    h->lock = xSemaphoreCreateMutex();
+    if (!h->base || !h->table || !h->lock) {
+        handle_heap_destroy(h);
+        return false;
+    }
+    h->size = bytes;
+    h->table_len = max_handles;
+    write_free(h, 0, (uint32_t)bytes - HH_HDR);
+    return true;
+}
+
+void handle_heap_destroy(handle_heap_t* h) {
+    if (h->compactor) vTaskDelete(h->compactor);
+    if (h->lock) vSemaphoreDelete(h->lock);
+    free(h->base);
+    free(h->table);
+    memset(h, 0, sizeof(*h));
+}
+
+// ===== Compaction =====
+// เดิน region ครั้งเดียว: บล็อกที่ unlock เลื่อนลงไปที่ dst, บล็อกที่ lock อยู่เป็นกำแพง
+static size_t compact_locked(handle_heap_t* h, uint32_t max_moves) {
+    uint32_t dst = 0, off = 0, moves = 0;
+    size_t moved = 0;
+
+    while (off < h->size) {
+        hh_block_t* b = blk_at(h, off);
+        uint32_t total = HH_HDR + b->size;
+        if (b->handle == 0) {
+            off += total;
+            continue;
+        }
+        hh_entry_t* e = &h->table[b->handle - 1];
+        if (e->lock_count > 0 || moves >= max_moves) {
+            if (dst < off) write_free(h, dst, off - dst - HH_HDR);
+            dst = off = off + total;
+            continue;
+        }
+        if (dst < off) {
+            memmove(h->base + dst, h->base + off, total);
+            e->offset = dst;
+            moves++;
+            moved += total;
+        }
+        dst += total;
+        off += total;
+    }
+    if (dst < h->size) write_free(h, dst, (uint32_t)h->size - dst - HH_HDR);
+
+    h->bytes_moved += moved;
+    return moved;
+}
+
+size_t handle_heap_compact(handle_heap_t* h, uint32_t max_moves) {
+    if (xSemaphoreTake(h->lock, HH_LOCK_TIMEOUT) != pdTRUE) return 0;
+    size_t moved = compact_locked(h, max_moves);
+    xSemaphoreGive(h->lock);
+    return moved;
+}
+
+// ===== Alloc / free =====
+static bool try_alloc_locked(handle_heap_t* h, uint32_t need, hh_handle_t hd) {
+    for (uint32_t off = 0; off < h->size; off += HH_HDR + blk_at(h, off)->size) {
+        hh_block_t* b = blk_at(h, off);
+        if (b->handle != 0) continue;
+        coalesce_forward(h, off);
+        if (b->size < need) continue;
+
+        uint32_t rest = b->size - need;
+        if (rest >= HH_HDR) {
+            b->size = need;
+            write_free(h, off + HH_HDR + need, rest - HH_HDR);
+        }
+        b->handle = hd;
+        b->magic = HH_MAGIC;
+        hh_entry_t* e = &h->table[hd - 1];
+        e->offset = off;
+        e->lock_count = 0;
+        e->in_use = 1;
+        h->used_bytes += HH_HDR + b->size;
+        h->live_handles++;
+        return true;
+    }
+    return false;
+}
+
+hh_handle_t handle_heap_alloc(handle_heap_t* h, size_t size) {
+    uint32_t need = align8(size ? size : 1);
+    hh_handle_t hd = HH_INVALID_HANDLE;
+
+    if (xSemaphoreTake(h->lock, HH_LOCK_TIMEOUT) != pdTRUE) return HH_INVALID_HANDLE;
+    for (uint16_t i = 0; i < h->table_len; i++) {
+        if (!h->table[i].in_use) { hd = (hh_handle_t)(i + 1); break; }
+    }
+    if (hd != HH_INVALID_HANDLE && !try_alloc_locked(h, need, hd)) {
+        // พื้นที่ว่างรวมพอแต่แตกเป็นชิ้น -> compact ทันทีแล้วลองใหม่
+        size_t free_total = 0;
+        size_t largest = largest_free_locked(h, &free_total);
+        if (free_total >= need) {
+            compact_locked(h, UINT32_MAX);
+            h->compactions++;
+            h->last_largest_before = largest;
+            h->last_largest_after = largest_free_locked(h, NULL);
+            ESP_LOGD(TAG, "on-demand compaction for %u bytes: largest %u -> %u",
+                     (unsigned)need, (unsigned)largest, (unsigned)h->last_largest_after);
+        }
+        if (!try_alloc_locked(h, need, hd)) hd = HH_INVALID_HANDLE;
+    }
+    if (hd == HH_INVALID_HANDLE) h->alloc_fail++;
+    xSemaphoreGive(h->lock);
+    return hd;
+}
+
+// free/unlock ต้องไม่ล้มเหลว (ทิ้ง = handle รั่ว / lock_count ค้างจน compaction ย้ายบล็อกนั้นไม่ได้อีก)
+// -> รอ lock นานเท่าไรก็ได้ แม้ compactor ถือ lock ระหว่าง memmove ยาว ๆ
+void handle_heap_free(handle_heap_t* h, hh_handle_t hd) {
+    xSemaphoreTake(h->lock, portMAX_DELAY);
+    hh_entry_t* e = entry_of(h, hd);
+    if (e) {
+        if (e->lock_count) ESP_LOGW(TAG, "free of locked handle %u", (unsigned)hd);
+        hh_block_t* b = blk_at(h, e->offset);
+        h->used_bytes -= HH_HDR + b->size;
+        h->live_handles--;
+        b->handle = 0;
+        coalesce_forward(h, e->offset);
+        memset(e, 0, sizeof(*e));
+    } else {
+        ESP_LOGE(TAG, "invalid free: handle %u", (unsigned)hd);
+    }
+    xSemaphoreGive(h->lock);
+}
+
+void* handle_heap_lock(handle_heap_t* h, hh_handle_t hd) {
+    void* p = NULL;
+    if (xSemaphoreTake(h->lock, HH_LOCK_TIMEOUT) != pdTRUE) return NULL;
+    hh_entry_t* e = entry_of(h, hd);
+    if (e) {
+        e->lock_count++;
+        p = h->base + e->offset + HH_HDR;
+    }
+    xSemaphoreGive(h->lock);
+    return p;
+}
+
+void handle_heap_unlock(handle_heap_t* h, hh_handle_t hd) {
+    xSemaphoreTake(h->lock, portMAX_DELAY);
+    hh_entry_t* e = entry_of(h, hd);
+    if (e && e->lock_count) e->lock_count--;
+    xSemaphoreGive(h->lock);
+}
+
+size_t handle_heap_size(handle_heap_t* h, hh_handle_t hd) {
+    size_t sz = 0;
+    if (xSemaphoreTake(h->lock, HH_LOCK_TIMEOUT) != pdTRUE) return 0;
+    hh_entry_t* e = entry_of(h, hd);
+    if (e) sz = blk_at(h, e->offset)->size;
+    xSemaphoreGive(h->lock);
+    return sz;
+}
+
+// ===== Stats =====
+void handle_heap_get_stats(handle_heap_t* h, handle_heap_stats_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (xSemaphoreTake(h->lock, HH_LOCK_TIMEOUT) != pdTRUE) return;
+    for (uint32_t off = 0; off < h->size; off += HH_HDR + blk_at(h, off)->size) {
+        const hh_block_t* b = blk_at(h, off);
+        out->blocks++;
+        if (b->handle == 0) out->free_blocks++;
+        else if (h->table[b->handle - 1].lock_count) out->locked_blocks++;
+    }
+    out->largest_free        = largest_free_locked(h, &out->free_bytes);
+    out->total_bytes         = h->size;
+    out->used_bytes          = h->used_bytes;
+    out->live_handles        = h->live_handles;
+    out->alloc_fail          = h->alloc_fail;
+    out->compactions         = h->compactions;
+    out->bytes_moved         = h->bytes_moved;
+    out->last_largest_before = h->last_largest_before;
+    out->last_largest_after  = h->last_largest_after;
+    xSemaphoreGive(h->lock);
+}
+
+// ===== Background compactor =====
+typedef struct {
+    handle_heap_t* heap;
+    uint32_t       period_ms;
+    float          threshold;
+} compactor_cfg_t;
+
+static void compactor_task(void* arg) {
+    compactor_cfg_t cfg = *(compactor_cfg_t*)arg;
+    free(arg);
+    handle_heap_t* h = cfg.heap;
+    handle_heap_stats_t st;
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(cfg.period_ms));
+        handle_heap_get_stats(h, &st);
+        if (st.free_bytes == 0 || st.largest_free == 0) continue;
+        float frag = (1.0f - (float)st.largest_free / (float)st.free_bytes) * 100.0f;
+        if (frag < cfg.threshold) continue;
+
+        // ย้ายทีละไม่กี่บล็อก แล้วปล่อย lock ให้ task อื่นได้ใช้ heap ระหว่างทาง
+        size_t before = st.largest_free;
+        while (handle_heap_compact(h, HH_STEP_MOVES) > 0) {
+            vTaskDelay(1);
+        }
+        handle_heap_get_stats(h, &st);
+        if (xSemaphoreTake(h->lock, HH_LOCK_TIMEOUT) == pdTRUE) {
+            h->compactions++;
+            h->last_largest_before = before;
+            h->last_largest_after = st.largest_free;
+            xSemaphoreGive(h->lock);
+        }
+        ESP_LOGI(TAG, "compaction: frag %.1f%%, largest free %u -> %u bytes",
+                 frag, (unsigned)before, (unsigned)st.largest_free);
+    }
+}
+
+bool handle_heap_start_compactor(handle_heap_t* h, UBaseType_t priority,
+                                 uint32_t period_ms, float frag_threshold_pct) {
+    compactor_cfg_t* cfg = malloc(sizeof(*cfg));
+    if (!cfg) return false;
+    cfg->heap = h;
+    cfg->period_ms = period_ms;
+    cfg->threshold = frag_threshold_pct;
+    if (xTaskCreate(compactor_task, "hh_compact", 3072, cfg, priority, &h->compactor) != pdPASS) {
+        free(cfg);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,74 @@
+#ifndef HANDLE_HEAP_H
+#define HANDLE_HEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// Handle-based heap สำหรับบัฟเฟอร์ใหญ่ที่อยู่นาน (opt-in)
+// ผู้ใช้ถือ handle แทน pointer: lock -> ได้ pointer, unlock -> บล็อกย้ายได้
+// compactor (task priority ต่ำ) เลื่อนบล็อกที่ unlock อยู่ให้ชิดกัน
+// เพื่อรวมช่องว่างกลับเป็นบล็อกใหญ่ (largest free block ฟื้นตัว)
+
+typedef uint16_t hh_handle_t;              // 0 = invalid
+#define HH_INVALID_HANDLE  ((hh_handle_t)0)
+
+typedef struct {
+    uint32_t offset;        // ตำแหน่ง header ใน region
+    uint16_t lock_count;
+    uint16_t in_use;
+} hh_entry_t;
+
+typedef struct {
+    uint8_t*          base;
+    size_t            size;
+    hh_entry_t*       table;               // index = handle - 1
+    uint16_t          table_len;
+    SemaphoreHandle_t lock;
+    TaskHandle_t      compactor;
+    // stats
+    size_t            used_bytes;          // payload + header ของบล็อกที่ใช้อยู่
+    uint32_t          live_handles;
+    uint32_t          alloc_fail;
+    uint32_t          compactions;
+    uint64_t          bytes_moved;
+    size_t            last_largest_before; // รอบ compaction ล่าสุด
+    size_t            last_largest_after;
+} handle_heap_t;
+
+typedef struct {
+    size_t   total_bytes;
+    size_t   used_bytes;
+    size_t   free_bytes;
+    size_t   largest_free;
+    uint32_t blocks;
+    uint32_t free_blocks;
+    uint32_t locked_blocks;
+    uint32_t live_handles;
+    uint32_t alloc_fail;
+    uint32_t compactions;
+    uint64_t bytes_moved;
+    size_t   last_largest_before;
+    size_t   last_largest_after;
+} handle_heap_stats_t;
+
+bool        handle_heap_create(handle_heap_t* h, size_t bytes, uint16_t max_handles, uint32_t caps);
+void        handle_heap_destroy(handle_heap_t* h);
+
+hh_handle_t handle_heap_alloc(handle_heap_t* h, size_t size);
+void        handle_heap_free(handle_heap_t* h, hh_handle_t hd);
+void*       handle_heap_lock(handle_heap_t* h, hh_handle_t hd);     // pointer ใช้ได้จนกว่าจะ unlock
+void        handle_heap_unlock(handle_heap_t* h, hh_handle_t hd);
+size_t      handle_heap_size(handle_heap_t* h, hh_handle_t hd);
+
+// ย้ายบล็อกที่ unlock อยู่ไม่เกิน max_moves ครั้งต่อการถือ lock หนึ่งรอบ คืนค่า = bytes ที่ย้าย
+size_t      handle_heap_compact(handle_heap_t* h, uint32_t max_moves);
+bool        handle_heap_start_compactor(handle_heap_t* h, UBaseType_t priority,
+                                        uint32_t period_ms, float frag_threshold_pct);
+void        handle_heap_get_stats(handle_heap_t* h, handle_heap_stats_t* out);
+
+#endif
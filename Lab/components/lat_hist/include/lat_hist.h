@@ -0,0 +1,40 @@
+#ifndef LAT_HIST_H
+#define LAT_HIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Streaming latency histogram (หน่วย µs) แบบ log-linear
+//   ค่า < 8 µs มี bucket ของตัวเอง, ที่เหลือแบ่งทุกช่วง 2^n ออกเป็น 8 bucket
+//   -> error ของ percentile ไม่เกิน 12.5% ใช้หน่วยความจำคงที่ ไม่ต้องเก็บ sample
+// record เป็น atomic relaxed: consumer หลายตัวบันทึกลง histogram เดียวกันได้โดยไม่ต้องมี lock
+// snapshot ระหว่างมีคน record อยู่อาจคลาดไปไม่กี่ sample (พอสำหรับ stats)
+
+#define LAT_HIST_SUB_BITS  3
+#define LAT_HIST_SUB       (1u << LAT_HIST_SUB_BITS)
+#define LAT_HIST_BUCKETS   ((32 - LAT_HIST_SUB_BITS + 1) * LAT_HIST_SUB)   // 240
+
+typedef struct {
+    _Atomic uint32_t buckets[LAT_HIST_BUCKETS];
+    _Atomic uint32_t count;
+    _Atomic uint32_t max_us;
+    _Atomic uint64_t sum_us;
+} lat_hist_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t p50_us;        // ขอบบนของ bucket ที่ percentile ตกอยู่ (ไม่เกิน max)
+    uint32_t p99_us;
+    uint32_t max_us;
+    uint32_t mean_us;
+} lat_hist_snapshot_t;
+
+void lat_hist_init(lat_hist_t* h);
+void lat_hist_record(lat_hist_t* h, uint32_t us);
+void lat_hist_record_since(lat_hist_t* h, int64_t t0_us);     // บันทึก now - t0 (esp_timer)
+
+// อ่านค่า interval ปัจจุบัน; reset = true จะล้าง histogram เพื่อเริ่ม interval ใหม่
+void lat_hist_snapshot(lat_hist_t* h, lat_hist_snapshot_t* out, bool reset);
+
+#endif
@@ -0,0 +1,82 @@
+#include <string.h>
+#include "esp_timer.h"
+#include "lat_hist.h"
+
+static inline uint32_t bucket_of(uint32_t us) {
+    if (us < LAT_HIST_SUB) return us;
+    uint32_t msb = 31u - (uint32_t)__builtin_clz(us);
+    uint32_t sub = (us >> (msb - LAT_HIST_SUB_BITS)) & (LAT_HIST_SUB - 1);
+    return (msb - LAT_HIST_SUB_BITS + 1) * LAT_HIST_SUB + sub;
+}
+
+// ค่าสูงสุดที่ตกใน bucket b
+static inline uint32_t bucket_upper(uint32_t b) {
+    if (b < LAT_HIST_SUB) return b;
+    uint32_t shift = b / LAT_HIST_SUB - 1;
+    uint32_t lower = (LAT_HIST_SUB + b % LAT_HIST_SUB) << shift;
+    return lower + ((1u << shift) - 1);
+}
+
+void lat_hist_init(lat_hist_t* h) {
+    for (uint32_t i = 0; i < LAT_HIST_BUCKETS; i++) atomic_init(&h->buckets[i], 0);
+    atomic_init(&h->count, 0);
+    atomic_init(&h->max_us, 0);
+    atomic_init(&h->sum_us, 0);
+}
+
+void lat_hist_record(lat_hist_t* h, uint32_t us) {
+    atomic_fetch_add_explicit(&h->buckets[bucket_of(us)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum_us, us, memory_order_relaxed);
+    uint32_t cur = atomic_load_explicit(&h->max_us, memory_order_relaxed);
+    while (us > cur &&
+           !atomic_compare_exchange_weak_explicit(&h->max_us, &cur, us,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void lat_hist_record_since(lat_hist_t* h, int64_t t0_us) {
+    int64_t dt = esp_timer_get_time() - t0_us;
+    if (dt < 0) dt = 0;
+    lat_hist_record(h, dt > UINT32_MAX ? UINT32_MAX : (uint32_t)dt);
+}
+
+void lat_hist_snapshot(lat_hist_t* h, lat_hist_snapshot_t* out, bool reset) {
+    static uint32_t counts[LAT_HIST_BUCKETS];   // เรียกจาก stats task เดียว
+    uint32_t total = 0;
+
+    memset(out, 0, sizeof(*out));
+    for (uint32_t i = 0; i < LAT_HIST_BUCKETS; i++) {
+        counts[i] = reset ? atomic_exchange_explicit(&h->buckets[i], 0, memory_order_relaxed)
+                          : atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        total += counts[i];
+    }
+    uint64_t sum = reset ? atomic_exchange_explicit(&h->sum_us, 0, memory_order_relaxed)
+                         : atomic_load_explicit(&h->sum_us, memory_order_relaxed);
+    out->max_us  = reset ? atomic_exchange_explicit(&h->max_us, 0, memory_order_relaxed)
+                         : atomic_load_explicit(&h->max_us, memory_order_relaxed);
+    if (reset) atomic_store_explicit(&h->count, 0, memory_order_relaxed);
+
+    out->count = total;
+    if (total == 0) return;
+    out->mean_us = (uint32_t)(sum / total);
+
+    // rank แบบ nearest-rank: ชิ้นที่ ceil(p * n)
+    uint32_t rank50 = (uint32_t)(((uint64_t)total * 50 + 99) / 100);
+    uint32_t rank99 = (uint32_t)(((uint64_t)total * 99 + 99) / 100);
+    uint32_t seen = 0;
+    bool got50 = false;
+    for (uint32_t i = 0; i < LAT_HIST_BUCKETS; i++) {
+        seen += counts[i];
+        if (!got50 && seen >= rank50) {
+            out->p50_us = bucket_upper(i);
+            got50 = true;
+        }
+        if (seen >= rank99) {
+            out->p99_us = bucket_upper(i);
+            break;
+        }
+    }
+    if (out->p50_us > out->max_us) out->p50_us = out->max_us;
+    if (out->p99_us > out->max_us) out->p99_us = out->max_us;
+}
@@ -0,0 +1,44 @@
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Mailbox ค่าล่าสุด (overwrite-latest) สำหรับข้อมูลที่ผู้อ่านสนใจแค่ค่าใหม่สุด เช่น ค่า sensor
+//   slot เดียวป้องกันด้วย seqlock: writer ทำ seq เป็นคี่ -> copy -> seq เป็นคู่
+//   reader copy ออกแล้วเช็ค seq ซ้ำ ถ้าชนกับ writer ก็อ่านใหม่ (ไม่มี lock, writer ไม่เคยรอ)
+//   ทุกครั้งที่เขียนจะ give binary semaphore "changed" -> ใช้เป็นสมาชิก queue set ได้
+//   เขียนหลายครั้งก่อนผู้อ่านมาหยิบ = ค่าเก่าถูกทับ (นับไว้ใน overwrites) ไม่มี backlog
+// writer เขียนใน critical section สั้น ๆ (memcpy ค่าเดียว) -> reader ที่ priority สูงกว่าบน core เดียวกัน
+// ไม่มีทางเจอ writer ค้างกลางทาง, reader อีก core รออย่างมากแค่ช่วง memcpy -> ใช้กับค่าขนาดเล็ก
+// writer ได้ทีละ 1 task (หรือ caller ต้อง serialize เอง), reader กี่ตัวก็ได้
+// แต่ "changed" มีตัวเดียว: reader ที่รอ notification ควรมีตัวเดียว
+
+typedef struct {
+    _Atomic uint32_t  seq;              // คี่ = กำลังเขียน, 0 = ยังไม่เคยเขียน
+    uint8_t*          data;
+    uint32_t          size;
+    portMUX_TYPE      lock;             // กัน preempt ระหว่างที่ seq เป็นคี่
+    SemaphoreHandle_t changed;          // binary: มีค่าใหม่ที่ยังไม่ได้หยิบ
+    // stats (relaxed)
+    _Atomic uint32_t  writes;
+    _Atomic uint32_t  overwrites;       // ค่าที่ถูกทับก่อนมีคนหยิบ
+    _Atomic uint32_t  read_retries;     // reader ชน writer แล้วต้องอ่านใหม่
+} mailbox_t;
+
+bool       mailbox_create(mailbox_t* m, uint32_t size);
+void       mailbox_destroy(mailbox_t* m);
+
+void       mailbox_write(mailbox_t* m, const void* value);
+bool       mailbox_peek(mailbox_t* m, void* out, uint32_t* seq_out);   // false = ยังไม่เคยเขียน
+// รอ notification (wait เหมือน xSemaphoreTake) แล้วอ่านค่าล่าสุด
+BaseType_t mailbox_receive(mailbox_t* m, void* out, TickType_t wait);
+bool       mailbox_pending(const mailbox_t* m);                         // มีค่าใหม่ที่ยังไม่ได้หยิบ
+
+static inline QueueSetMemberHandle_t mailbox_set_member(mailbox_t* m) { return m->changed; }
+
+#endif
@@ -0,0 +1,68 @@
+#include <stdlib.h>
+#include <string.h>
+#include "mailbox.h"
+
+bool mailbox_create(mailbox_t* m, uint32_t size) {
+    memset(m, 0, sizeof(*m));
+    if (size == 0) return false;
+    m->data = calloc(1, size);
+    m->changed = xSemaphoreCreateBinary();
+    if (!m->data || !m->changed) {
+        mailbox_destroy(m);
+        return false;
+    }
+    m->size = size;
+    m->lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    atomic_init(&m->seq, 0);
+    return true;
+}
+
+void mailbox_destroy(mailbox_t* m) {
+    if (m->changed) vSemaphoreDelete(m->changed);
+    free(m->data);
+    memset(m, 0, sizeof(*m));
+}
+
+void mailbox_write(mailbox_t* m, const void* value) {
+    portENTER_CRITICAL(&m->lock);
+    uint32_t s = atomic_load_explicit(&m->seq, memory_order_relaxed);
+    atomic_store_explicit(&m->seq, s + 1, memory_order_relaxed);        // คี่: reader จะอ่านซ้ำ
+    atomic_thread_fence(memory_order_release);
+    memcpy(m->data, value, m->size);
+    atomic_store_explicit(&m->seq, s + 2, memory_order_release);
+    portEXIT_CRITICAL(&m->lock);
+
+    atomic_fetch_add_explicit(&m->writes, 1, memory_order_relaxed);
+    // give ซ้ำตอนยังไม่มีใครหยิบจะ fail = ค่าก่อนหน้าถูกทับ
+    if (xSemaphoreGive(m->changed) != pdPASS) {
+        atomic_fetch_add_explicit(&m->overwrites, 1, memory_order_relaxed);
+    }
+}
+
+bool mailbox_peek(mailbox_t* m, void* out, uint32_t* seq_out) {
+    uint32_t s0, s1;
+    while (1) {
+        s0 = atomic_load_explicit(&m->seq, memory_order_acquire);
+        if (s0 == 0) return false;
+        if (s0 & 1) {
+            atomic_fetch_add_explicit(&m->read_retries, 1, memory_order_relaxed);
+            continue;                       // writer กำลังเขียน (ช่วงสั้นมาก, ไม่ block)
+        }
+        memcpy(out, m->data, m->size);
+        atomic_thread_fence(memory_order_acquire);
+        s1 = atomic_load_explicit(&m->seq, memory_order_relaxed);
+        if (s0 == s1) break;
+        atomic_fetch_add_explicit(&m->read_retries, 1, memory_order_relaxed);
+    }
+    if (seq_out) *seq_out = s0 / 2;         // จำนวนครั้งที่เขียน ณ ค่านี้
+    return true;
+}
+
+BaseType_t mailbox_receive(mailbox_t* m, void* out, TickType_t wait) {
+    if (xSemaphoreTake(m->changed, wait) != pdPASS) return pdFAIL;
+    return mailbox_peek(m, out, NULL) ? pdPASS : pdFAIL;
+}
+
+bool mailbox_pending(const mailbox_t* m) {
+    return uxSemaphoreGetCount(m->changed) > 0;
+}
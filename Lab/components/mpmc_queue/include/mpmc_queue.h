@@ -0,0 +1,56 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Bounded MPMC queue แบบ Vyukov: ทุก slot มี sequence number
+//   producer จอง slot ด้วย CAS บน enqueue_pos, consumer ด้วย CAS บน dequeue_pos
+//   ไม่มี lock กลาง -> producer หลายตัวไม่ต้องต่อคิวรอ critical section เดียวกัน
+// ข้อควรรู้: ถ้า producer ถูก preempt ระหว่างจอง slot กับ publish, consumer จะเห็นว่า "ว่าง"
+// ชั่วคราวจนกว่า producer ตัวนั้นจะได้รันต่อ (ไม่เสียข้อมูล แค่ช้าลง)
+//
+// เมื่อเต็ม/ว่าง task ที่รอจะลงชื่อใน waiter table แล้ว block ด้วย task notification (index 0)
+// ฝั่งที่ทำสำเร็จจะปลุกผู้รอ 1 ตัว; ถ้า table เต็มจะ poll ทุก 1 tick แทน
+
+#define MPMC_CACHE_LINE   32
+#define MPMC_MAX_WAITERS  8
+
+typedef struct {
+    _Atomic uint32_t enqueue_pos;
+    uint8_t          _pad0[MPMC_CACHE_LINE - sizeof(uint32_t)];
+    _Atomic uint32_t dequeue_pos;
+    uint8_t          _pad1[MPMC_CACHE_LINE - sizeof(uint32_t)];
+    uint8_t*         cells;                 // [seq | item] * capacity
+    uint32_t         cell_stride;
+    uint32_t         item_size;
+    uint32_t         capacity;              // 2^n
+    uint32_t         mask;
+    _Atomic(TaskHandle_t) producer_waiters[MPMC_MAX_WAITERS];
+    _Atomic(TaskHandle_t) consumer_waiters[MPMC_MAX_WAITERS];
+    // stats (relaxed)
+    _Atomic uint32_t full_waits;
+    _Atomic uint32_t empty_waits;
+    _Atomic uint32_t cas_retries;
+} __attribute__((aligned(MPMC_CACHE_LINE))) mpmc_queue_t;
+
+bool       mpmc_queue_create(mpmc_queue_t* q, uint32_t item_size, uint32_t capacity);   // capacity ปัดขึ้นเป็น 2^n
+void       mpmc_queue_destroy(mpmc_queue_t* q);
+
+bool       mpmc_queue_try_send(mpmc_queue_t* q, const void* item);
+bool       mpmc_queue_try_receive(mpmc_queue_t* q, void* item);
+BaseType_t mpmc_queue_send(mpmc_queue_t* q, const void* item, TickType_t wait);
+BaseType_t mpmc_queue_receive(mpmc_queue_t* q, void* item, TickType_t wait);
+
+// batch: timeout ใช้กับชิ้นแรกเท่านั้น คืนจำนวนชิ้นที่ส่ง/รับได้
+uint32_t   mpmc_queue_send_batch(mpmc_queue_t* q, const void* items, uint32_t count, TickType_t first_wait);
+uint32_t   mpmc_queue_receive_batch(mpmc_queue_t* q, void* items, uint32_t max_count, TickType_t first_wait);
+
+uint32_t   mpmc_queue_count(const mpmc_queue_t* q);   // ค่าประมาณ
+
+#endif
@@ -0,0 +1,200 @@
+#include <stdlib.h>
+#include <string.h>
+#include "mpmc_queue.h"
+
+static inline uint32_t next_pow2(uint32_t x) {
+    uint32_t p = 1;
+    while (p < x) p <<= 1;
+    return p;
+}
+
+static inline _Atomic uint32_t* cell_seq(const mpmc_queue_t* q, uint32_t pos) {
+    return (_Atomic uint32_t*)(q->cells + (size_t)(pos & q->mask) * q->cell_stride);
+}
+
+static inline uint8_t* cell_data(const mpmc_queue_t* q, uint32_t pos) {
+    return q->cells + (size_t)(pos & q->mask) * q->cell_stride + sizeof(uint32_t);
+}
+
+bool mpmc_queue_create(mpmc_queue_t* q, uint32_t item_size, uint32_t capacity) {
+    memset(q, 0, sizeof(*q));
+    if (item_size == 0 || capacity < 2) return false;
+    q->capacity = next_pow2(capacity);
+    q->mask = q->capacity - 1;
+    q->item_size = item_size;
+    q->cell_stride = (uint32_t)((sizeof(uint32_t) + item_size + 3) & ~3u);
+    q->cells = malloc((size_t)q->cell_stride * q->capacity);
+    if (!q->cells) return false;
+    for (uint32_t i = 0; i < q->capacity; i++) {
+        atomic_init(cell_seq(q, i), i);
+    }
+    atomic_init(&q->enqueue_pos, 0);
+    atomic_init(&q->dequeue_pos, 0);
+    for (int i = 0; i < MPMC_MAX_WAITERS; i++) {
+        atomic_init(&q->producer_waiters[i], NULL);
+        atomic_init(&q->consumer_waiters[i], NULL);
+    }
+    return true;
+}
+
+void mpmc_queue_destroy(mpmc_queue_t* q) {
+    free(q->cells);
+    memset(q, 0, sizeof(*q));
+}
+
+// ===== Waiter table =====
+// ปลุกผู้รอ 1 ตัว (exchange เป็น NULL = ถอดชื่อให้ด้วย)
+static void wake_one(_Atomic(TaskHandle_t)* table) {
+    atomic_thread_fence(memory_order_seq_cst);
+    for (int i = 0; i < MPMC_MAX_WAITERS; i++) {
+        if (atomic_load_explicit(&table[i], memory_order_relaxed) == NULL) continue;
+        TaskHandle_t t = atomic_exchange_explicit(&table[i], NULL, memory_order_acq_rel);
+        if (t) {
+            xTaskNotifyGive(t);
+            return;
+        }
+    }
+}
+
+static int register_waiter(_Atomic(TaskHandle_t)* table, TaskHandle_t self) {
+    for (int i = 0; i < MPMC_MAX_WAITERS; i++) {
+        TaskHandle_t expected = NULL;
+        if (atomic_compare_exchange_strong(&table[i], &expected, self)) return i;
+    }
+    return -1;
+}
+
+// คืน false = ผู้ปลุกถอดชื่อเราไปแล้ว (notification ถูกส่งมาหรือกำลังจะมา)
+static bool unregister_waiter(_Atomic(TaskHandle_t)* table, int slot, TaskHandle_t self) {
+    if (slot < 0) return true;
+    TaskHandle_t expected = self;
+    return atomic_compare_exchange_strong(&table[slot], &expected, NULL);
+}
+
+// ออกจาก table โดยไม่ได้ใช้ wake ที่ส่งมาหาเรา: ส่งต่อให้ผู้รอตัวอื่น ไม่งั้นตัวที่ block
+// แบบ portMAX_DELAY อาจไม่ตื่นทั้งที่มีของในคิว แล้วล้าง notification ค้างของตัวเอง
+// (ถ้า give ยังมาไม่ถึง รอบหน้าแค่ตื่นฟรี 1 ครั้งแล้ว try_op ใหม่)
+static void leave_waiters(_Atomic(TaskHandle_t)* table, int slot, TaskHandle_t self) {
+    if (unregister_waiter(table, slot, self)) return;
+    wake_one(table);
+    ulTaskNotifyTake(pdTRUE, 0);
+}
+
+// ===== Non-blocking core =====
+bool mpmc_queue_try_send(mpmc_queue_t* q, const void* item) {
+    uint32_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    while (1) {
+        uint32_t seq = atomic_load_explicit(cell_seq(q, pos), memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+            atomic_fetch_add_explicit(&q->cas_retries, 1, memory_order_relaxed);
+        } else if (diff < 0) {
+            return false;                   // เต็ม
+        } else {
+            pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+        }
+    }
+    memcpy(cell_data(q, pos), item, q->item_size);
+    atomic_store_explicit(cell_seq(q, pos), pos + 1, memory_order_release);
+    wake_one(q->consumer_waiters);
+    return true;
+}
+
+bool mpmc_queue_try_receive(mpmc_queue_t* q, void* item) {
+    uint32_t pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    while (1) {
+        uint32_t seq = atomic_load_explicit(cell_seq(q, pos), memory_order_acquire);
+        int32_t diff = (int32_t)(seq - (pos + 1));
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+            atomic_fetch_add_explicit(&q->cas_retries, 1, memory_order_relaxed);
+        } else if (diff < 0) {
+            return false;                   // ว่าง
+        } else {
+            pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+        }
+    }
+    memcpy(item, cell_data(q, pos), q->item_size);
+    atomic_store_explicit(cell_seq(q, pos), pos + q->mask + 1, memory_order_release);
+    wake_one(q->producer_waiters);
+    return true;
+}
+
+// ===== Blocking wrappers =====
+typedef bool (*try_fn_t)(mpmc_queue_t*, void*);
+
+static BaseType_t wait_for(mpmc_queue_t* q, _Atomic(TaskHandle_t)* table, try_fn_t try_op,
+                           void* item, TickType_t wait, _Atomic uint32_t* wait_count) {
+    if (try_op(q, item)) return pdPASS;
+    if (wait == 0) return pdFAIL;
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TickType_t start = xTaskGetTickCount();
+    while (1) {
+        int slot = register_waiter(table, self);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (try_op(q, item)) {
+            leave_waiters(table, slot, self);
+            return pdPASS;
+        }
+
+        TickType_t remaining = portMAX_DELAY;
+        if (wait != portMAX_DELAY) {
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= wait) {
+                leave_waiters(table, slot, self);
+                break;
+            }
+            remaining = wait - elapsed;
+        }
+        atomic_fetch_add_explicit(wait_count, 1, memory_order_relaxed);
+        if (slot < 0) {
+            vTaskDelay(1);                  // waiter table เต็ม: poll
+        } else {
+            ulTaskNotifyTake(pdTRUE, remaining);
+            unregister_waiter(table, slot, self);   // ถูกถอดแล้ว = wake นี้เป็นของเรา -> try_op รอบหน้า
+        }
+    }
+    return try_op(q, item) ? pdPASS : pdFAIL;
+}
+
+static bool try_send_cb(mpmc_queue_t* q, void* item) { return mpmc_queue_try_send(q, item); }
+
+BaseType_t mpmc_queue_send(mpmc_queue_t* q, const void* item, TickType_t wait) {
+    return wait_for(q, q->producer_waiters, try_send_cb, (void*)item, wait, &q->full_waits);
+}
+
+BaseType_t mpmc_queue_receive(mpmc_queue_t* q, void* item, TickType_t wait) {
+    return wait_for(q, q->consumer_waiters, mpmc_queue_try_receive, item, wait, &q->empty_waits);
+}
+
+// ===== Batch =====
+uint32_t mpmc_queue_send_batch(mpmc_queue_t* q, const void* items, uint32_t count, TickType_t first_wait) {
+    const uint8_t* p = items;
+    if (count == 0 || mpmc_queue_send(q, p, first_wait) != pdPASS) return 0;
+    uint32_t sent = 1;
+    while (sent < count && mpmc_queue_try_send(q, p + (size_t)sent * q->item_size)) sent++;
+    return sent;
+}
+
+uint32_t mpmc_queue_receive_batch(mpmc_queue_t* q, void* items, uint32_t max_count, TickType_t first_wait) {
+    uint8_t* p = items;
+    if (max_count == 0 || mpmc_queue_receive(q, p, first_wait) != pdPASS) return 0;
+    uint32_t got = 1;
+    while (got < max_count && mpmc_queue_try_receive(q, p + (size_t)got * q->item_size)) got++;
+    return got;
+}
+
+uint32_t mpmc_queue_count(const mpmc_queue_t* q) {
+    uint32_t deq = atomic_load_explicit(&q->dequeue_pos, memory_order_acquire);
+    uint32_t enq = atomic_load_explicit(&q->enqueue_pos, memory_order_acquire);
+    uint32_t n = enq - deq;
+    return n > q->capacity ? q->capacity : n;
+}
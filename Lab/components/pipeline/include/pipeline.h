@@ -0,0 +1,82 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// Pipeline หลายขั้น: แต่ละ stage มี worker task ของตัวเอง (parallelism ตัว, pin core ได้)
+// ต่อกันด้วยคิวจำกัดความยาว (channel_depth) -> stage ที่ช้าจะ backpressure stage ก่อนหน้าเอง
+//   item ทุกชิ้นขนาดเท่ากัน (item_size) แนบเวลาเข้าคิวไว้ข้างหน้า -> วัด queueing delay ต่อ stage ได้
+//   stage สุดท้ายคือ sink (ทำเสร็จแล้วทิ้ง)
+// worker แต่ละตัวนับสถิติของตัวเอง (ไม่แชร์ตัวนับ), log รวมต่อ stage แล้วชี้ bottleneck
+// = stage ที่ utilization (busy / (parallelism x เวลา)) สูงสุด
+// ตัวนับเวลาเป็น uint32 μs: ค่า delta ระหว่าง log ถูกต้องตราบใดที่ห่างกันไม่เกิน ~71 นาที
+
+#define PIPELINE_MAX_STAGES   6
+#define PIPELINE_MAX_WORKERS  4         // ต่อ stage
+#define PIPELINE_MAX_ITEM     128       // byte ต่อ item (envelope ของ submit อยู่บน stack)
+
+// ทำงานกับ item ในที่ (แก้ไขได้ ผลส่งต่อให้ stage ถัดไป)
+typedef void (*pipeline_stage_fn_t)(void* item, void* arg);
+
+typedef struct {
+    const char*         name;
+    pipeline_stage_fn_t fn;
+    void*               arg;
+    uint8_t             parallelism;    // จำนวน worker (1..PIPELINE_MAX_WORKERS)
+    BaseType_t          core;           // tskNO_AFFINITY = ไม่ pin
+    UBaseType_t         prio;
+    uint32_t            stack;
+} pipeline_stage_cfg_t;
+
+typedef struct pipeline pipeline_t;
+
+typedef struct {
+    pipeline_t*   p;
+    uint32_t      stage;
+    uint8_t*      buf;                  // envelope ของ worker นี้
+    TaskHandle_t  task;
+    // stats (เขียนโดย worker ตัวเดียว)
+    uint32_t      items;
+    uint32_t      busy_us;
+    uint32_t      qdelay_us;            // รวมเวลารอในคิวขาเข้า
+    uint32_t      qdelay_max_us;        // reset ตอน log
+    uint32_t      e2e_us;               // sink: รวมเวลา submit -> ทำเสร็จ
+} pipeline_worker_t;
+
+typedef struct {
+    pipeline_stage_cfg_t cfg;
+    QueueHandle_t        in;            // คิวขาเข้าของ stage นี้
+    pipeline_worker_t    workers[PIPELINE_MAX_WORKERS];
+    // ค่าตอน log ครั้งก่อน
+    uint32_t             last_items;
+    uint32_t             last_busy_us;
+    uint32_t             last_qdelay_us;
+} pipeline_stage_t;
+
+struct pipeline {
+    pipeline_stage_t stages[PIPELINE_MAX_STAGES];
+    uint32_t         count;
+    uint32_t         item_size;
+    uint32_t         env_size;          // header + item
+    _Atomic uint32_t submitted;
+    _Atomic uint32_t completed;
+    uint32_t         last_completed;
+    uint32_t         last_e2e_us;
+};
+
+// false = สร้างไม่ครบ: worker/คิว/buffer ที่สร้างไปแล้วถูกลบคืนหมด
+bool       pipeline_create(pipeline_t* p, const pipeline_stage_cfg_t* stages, uint32_t count,
+                           uint32_t item_size, uint32_t channel_depth);
+BaseType_t pipeline_submit(pipeline_t* p, const void* item, TickType_t wait);
+// รอจนทุกชิ้นที่ submit ผ่าน sink (poll ทุก tick); false = หมดเวลา
+bool       pipeline_drain(pipeline_t* p, TickType_t wait);
+// throughput, utilization, queueing delay ต่อ stage + bottleneck ของช่วงที่ผ่านมา
+void       pipeline_log(pipeline_t* p, const char* tag, float interval_s);
+
+#endif
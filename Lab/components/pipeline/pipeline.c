@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "pipeline.h"
+
+typedef struct {
+    int64_t t_submit_us;
+    int64_t t_enq_us;
+} pipeline_hdr_t;
+
+static void worker_task(void* pv) {
+    pipeline_worker_t* w = pv;
+    pipeline_t* p = w->p;
+    pipeline_stage_t* st = &p->stages[w->stage];
+    pipeline_hdr_t* hdr = (pipeline_hdr_t*)w->buf;
+    void* item = w->buf + sizeof(pipeline_hdr_t);
+    bool sink = w->stage + 1 == p->count;
+
+    while (1) {
+        xQueueReceive(st->in, w->buf, portMAX_DELAY);
+        int64_t t0 = esp_timer_get_time();
+        uint32_t qd = (uint32_t)(t0 - hdr->t_enq_us);
+        w->qdelay_us += qd;
+        if (qd > w->qdelay_max_us) w->qdelay_max_us = qd;
+
+        st->cfg.fn(item, st->cfg.arg);
+
+        int64_t t1 = esp_timer_get_time();
+        w->busy_us += (uint32_t)(t1 - t0);
+        w->items++;
+        if (sink) {
+            w->e2e_us += (uint32_t)(t1 - hdr->t_submit_us);
+            atomic_fetch_add_explicit(&p->completed, 1, memory_order_release);
+        } else {
+            hdr->t_enq_us = t1;
+            xQueueSend(p->stages[w->stage + 1].in, w->buf, portMAX_DELAY);   // เต็ม = backpressure
+        }
+    }
+}
+
+// ย้อนคืนทุกอย่างที่ pipeline_create สร้างไปแล้ว (ยังไม่มี item เข้า -> worker ทุกตัวบล็อกรอคิวอยู่)
+static void pipeline_unwind(pipeline_t* p) {
+    for (uint32_t s = 0; s < p->count; s++) {
+        pipeline_stage_t* st = &p->stages[s];
+        for (uint32_t i = 0; i < PIPELINE_MAX_WORKERS; i++) {
+            pipeline_worker_t* w = &st->workers[i];
+            if (w->task) vTaskDelete(w->task);      // ลบก่อนคิว: worker ยังอ้างคิวอยู่
+            free(w->buf);
+        }
+    }
+    for (uint32_t s = 0; s < p->count; s++) {
+        if (p->stages[s].in) vQueueDelete(p->stages[s].in);
+    }
+    memset(p, 0, sizeof(*p));
+}
+
+bool pipeline_create(pipeline_t* p, const pipeline_stage_cfg_t* stages, uint32_t count,
+                     uint32_t item_size, uint32_t channel_depth) {
+    memset(p, 0, sizeof(*p));
+    if (count == 0 || count > PIPELINE_MAX_STAGES) return false;
+    if (item_size == 0 || item_size > PIPELINE_MAX_ITEM) return false;
+    p->count = count;
+    p->item_size = item_size;
+    p->env_size = sizeof(pipeline_hdr_t) + item_size;
+
+    for (uint32_t s = 0; s < count; s++) {
+        pipeline_stage_t* st = &p->stages[s];
+        st->cfg = stages[s];
+        if (st->cfg.parallelism == 0) st->cfg.parallelism = 1;
+        if (st->cfg.parallelism > PIPELINE_MAX_WORKERS) st->cfg.parallelism = PIPELINE_MAX_WORKERS;
+        st->in = xQueueCreate(channel_depth, p->env_size);
+        if (!st->in) {
+            pipeline_unwind(p);
+            return false;
+        }
+    }
+    // สร้าง worker หลังคิวครบทุก stage (worker ต้องเห็นคิวขาออก)
+    for (uint32_t s = 0; s < count; s++) {
+        pipeline_stage_t* st = &p->stages[s];
+        for (uint32_t i = 0; i < st->cfg.parallelism; i++) {
+            pipeline_worker_t* w = &st->workers[i];
+            w->p = p;
+            w->stage = s;
+            w->buf = malloc(p->env_size);
+            char name[16];
+            snprintf(name, sizeof(name), "pl_%.8s%u", st->cfg.name, (unsigned)i);
+            if (!w->buf || xTaskCreatePinnedToCore(worker_task, name, st->cfg.stack, w, st->cfg.prio,
+                                                   &w->task, st->cfg.core) != pdPASS) {
+                w->task = NULL;
+                pipeline_unwind(p);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+BaseType_t pipeline_submit(pipeline_t* p, const void* item, TickType_t wait) {
+    uint8_t env[sizeof(pipeline_hdr_t) + PIPELINE_MAX_ITEM];
+    pipeline_hdr_t* hdr = (pipeline_hdr_t*)env;
+    hdr->t_submit_us = hdr->t_enq_us = esp_timer_get_time();
+    memcpy(env + sizeof(pipeline_hdr_t), item, p->item_size);
+    BaseType_t ok = xQueueSend(p->stages[0].in, env, wait);
+    if (ok == pdPASS) atomic_fetch_add_explicit(&p->submitted, 1, memory_order_relaxed);
+    return ok;
+}
+
+bool pipeline_drain(pipeline_t* p, TickType_t wait) {
+    TickType_t start = xTaskGetTickCount();
+    while (atomic_load_explicit(&p->completed, memory_order_acquire) !=
+           atomic_load_explicit(&p->submitted, memory_order_relaxed)) {
+        if (wait != portMAX_DELAY && xTaskGetTickCount() - start >= wait) return false;
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+void pipeline_log(pipeline_t* p, const char* tag, float interval_s) {
+    float span_us = interval_s * 1e6f;
+    uint32_t completed = atomic_load(&p->completed);
+    uint32_t e2e_us = 0;
+    int bottleneck = -1;
+    float worst = -1.0f;
+
+    ESP_LOGI(tag, "%-12s %3s %9s %7s %9s %9s", "stage", "par", "items/s", "util", "avg q ms", "max q ms");
+    for (uint32_t s = 0; s < p->count; s++) {
+        pipeline_stage_t* st = &p->stages[s];
+        uint32_t items = 0, busy = 0, qdelay = 0, qmax = 0;
+        for (uint32_t i = 0; i < st->cfg.parallelism; i++) {
+            pipeline_worker_t* w = &st->workers[i];
+            items += w->items;
+            busy += w->busy_us;
+            qdelay += w->qdelay_us;
+            if (w->qdelay_max_us > qmax) qmax = w->qdelay_max_us;
+            w->qdelay_max_us = 0;
+            if (s + 1 == p->count) e2e_us += w->e2e_us;
+        }
+        uint32_t d_items = items - st->last_items;
+        float util = span_us > 0 ? 100.0f * (float)(busy - st->last_busy_us) / (span_us * st->cfg.parallelism) : 0.0f;
+        ESP_LOGI(tag, "%-12s %3u %9.1f %6.1f%% %9.2f %9.2f", st->cfg.name, (unsigned)st->cfg.parallelism,
+                 interval_s > 0 ? d_items / interval_s : 0.0f, util,
+                 d_items ? (qdelay - st->last_qdelay_us) / 1000.0f / d_items : 0.0f, qmax / 1000.0f);
+        if (util > worst) {
+            worst = util;
+            bottleneck = (int)s;
+        }
+        st->last_items = items;
+        st->last_busy_us = busy;
+        st->last_qdelay_us = qdelay;
+    }
+
+    uint32_t d_done = completed - p->last_completed;
+    ESP_LOGI(tag, "Pipeline: %.1f items/s, end-to-end avg %.2f ms, in flight %lu",
+             interval_s > 0 ? d_done / interval_s : 0.0f,
+             d_done ? (e2e_us - p->last_e2e_us) / 1000.0f / d_done : 0.0f,
+             (unsigned long)(atomic_load(&p->submitted) - completed));
+    if (bottleneck >= 0) {
+        ESP_LOGI(tag, "Bottleneck: %s (util %.1f%%)", p->stages[bottleneck].cfg.name, worst);
+    }
+    p->last_completed = completed;
+    p->last_e2e_us = e2e_us;
+}
@@ -0,0 +1,58 @@
+#ifndef PRIO_QUEUE_H
+#define PRIO_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+// Bounded priority queue: รับชิ้น priority สูงสุดก่อน, priority เท่ากันเป็น FIFO
+//   เก็บเป็น binary heap ของ index (ตัวข้อมูลอยู่กับที่ใน slot ไม่ต้องย้ายตอน sift)
+//   send/receive มี timeout แบบ xQueueSend/xQueueReceive: ใช้ counting semaphore 2 ตัว
+//   (items = จำนวนชิ้น, spaces = ที่ว่าง) + mutex คุม heap ช่วงสั้น ๆ
+//
+// ใช้ใน queue set ได้: ใส่ prio_queue_set_member() ลง set แทนตัวคิว
+// เมื่อ select ได้ handle นี้ให้เรียก prio_queue_receive(..., 0) ซึ่ง take semaphore ตัวนั้นพอดี
+// ใช้จาก task เท่านั้น (ไม่มี FromISR)
+
+typedef struct {
+    uint32_t seq;           // ลำดับเข้า -> FIFO ภายใน priority เดียวกัน
+    uint16_t slot;
+    uint8_t  prio;
+} prio_entry_t;
+
+typedef struct {
+    SemaphoreHandle_t items;        // counting: ชิ้นที่รอ (สมาชิก queue set)
+    SemaphoreHandle_t spaces;       // counting: ที่ว่าง
+    SemaphoreHandle_t lock;
+    prio_entry_t*     heap;
+    uint16_t*         free_slots;
+    uint8_t*          storage;
+    uint32_t          capacity;
+    uint32_t          item_size;
+    uint32_t          count;
+    uint32_t          free_top;
+    uint32_t          next_seq;
+    // stats
+    uint32_t          evicted;
+} prio_queue_t;
+
+bool       prio_queue_create(prio_queue_t* pq, uint32_t item_size, uint32_t capacity);
+void       prio_queue_destroy(prio_queue_t* pq);
+
+BaseType_t prio_queue_send(prio_queue_t* pq, const void* item, uint8_t prio, TickType_t wait);
+BaseType_t prio_queue_receive(prio_queue_t* pq, void* item, TickType_t wait);          // priority สูงสุด
+uint32_t   prio_queue_receive_batch(prio_queue_t* pq, void* items, uint32_t max_count,
+                                    TickType_t first_wait);                             // timeout เฉพาะชิ้นแรก
+
+// ดึงชิ้น priority ต่ำสุด (ตัวที่เก่าสุดใน priority นั้น) ออกทันที สำหรับ shed เมื่อเต็ม
+BaseType_t prio_queue_evict_lowest(prio_queue_t* pq, void* item);
+
+UBaseType_t prio_queue_count(const prio_queue_t* pq);
+static inline QueueSetMemberHandle_t prio_queue_set_member(const prio_queue_t* pq) {
+    return (QueueSetMemberHandle_t)pq->items;
+}
+
+#endif
@@ -0,0 +1,134 @@
+#include <stdlib.h>
+#include <string.h>
+#include "prio_queue.h"
+
+bool prio_queue_create(prio_queue_t* pq, uint32_t item_size, uint32_t capacity) {
+    memset(pq, 0, sizeof(*pq));
+    if (item_size == 0 || capacity == 0 || capacity > UINT16_MAX) return false;
+    pq->capacity = capacity;
+    pq->item_size = item_size;
+    pq->heap = malloc(sizeof(prio_entry_t) * capacity);
+    pq->free_slots = malloc(sizeof(uint16_t) * capacity);
+    pq->storage = malloc((size_t)item_size * capacity);
+    pq->items = xSemaphoreCreateCounting(capacity, 0);
+    pq->spaces = xSemaphoreCreateCounting(capacity, capacity);
+    pq->lock = xSemaphoreCreateMutex();
+    if (!pq->heap || !pq->free_slots || !pq->storage || !pq->items || !pq->spaces || !pq->lock) {
+        prio_queue_destroy(pq);
+        return false;
+    }
+    for (uint32_t i = 0; i < capacity; i++) pq->free_slots[i] = (uint16_t)i;
+    pq->free_top = capacity;
+    return true;
+}
+
+void prio_queue_destroy(prio_queue_t* pq) {
+    if (pq->items)  vSemaphoreDelete(pq->items);
+    if (pq->spaces) vSemaphoreDelete(pq->spaces);
+    if (pq->lock)   vSemaphoreDelete(pq->lock);
+    free(pq->heap);
+    free(pq->free_slots);
+    free(pq->storage);
+    memset(pq, 0, sizeof(*pq));
+}
+
+// ===== Heap (เรียกขณะถือ lock) =====
+// a มาก่อน b: priority สูงกว่า หรือเท่ากันแต่เข้าก่อน
+static inline bool before(const prio_entry_t* a, const prio_entry_t* b) {
+    if (a->prio != b->prio) return a->prio > b->prio;
+    return (int32_t)(a->seq - b->seq) < 0;
+}
+
+static void sift_up(prio_entry_t* h, uint32_t i) {
+    prio_entry_t e = h[i];
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!before(&e, &h[parent])) break;
+        h[i] = h[parent];
+        i = parent;
+    }
+    h[i] = e;
+}
+
+static void sift_down(prio_entry_t* h, uint32_t n, uint32_t i) {
+    prio_entry_t e = h[i];
+    while (1) {
+        uint32_t c = 2 * i + 1;
+        if (c >= n) break;
+        if (c + 1 < n && before(&h[c + 1], &h[c])) c++;
+        if (!before(&h[c], &e)) break;
+        h[i] = h[c];
+        i = c;
+    }
+    h[i] = e;
+}
+
+// ถอด entry ที่ index i ออกแล้วคัดลอกข้อมูลให้ผู้เรียก
+static void remove_at(prio_queue_t* pq, uint32_t i, void* item) {
+    prio_entry_t e = pq->heap[i];
+    memcpy(item, pq->storage + (size_t)e.slot * pq->item_size, pq->item_size);
+    pq->free_slots[pq->free_top++] = e.slot;
+
+    pq->count--;
+    if (i == pq->count) return;
+    pq->heap[i] = pq->heap[pq->count];
+    if (i > 0 && before(&pq->heap[i], &pq->heap[(i - 1) / 2])) sift_up(pq->heap, i);
+    else                                                      sift_down(pq->heap, pq->count, i);
+}
+
+// ===== API =====
+BaseType_t prio_queue_send(prio_queue_t* pq, const void* item, uint8_t prio, TickType_t wait) {
+    if (xSemaphoreTake(pq->spaces, wait) != pdPASS) return pdFAIL;
+
+    xSemaphoreTake(pq->lock, portMAX_DELAY);
+    uint16_t slot = pq->free_slots[--pq->free_top];
+    memcpy(pq->storage + (size_t)slot * pq->item_size, item, pq->item_size);
+    pq->heap[pq->count] = (prio_entry_t){ .seq = pq->next_seq++, .slot = slot, .prio = prio };
+    sift_up(pq->heap, pq->count++);
+    xSemaphoreGive(pq->lock);
+
+    xSemaphoreGive(pq->items);          // แจ้ง consumer / queue set หลังข้อมูลพร้อมแล้ว
+    return pdPASS;
+}
+
+BaseType_t prio_queue_receive(prio_queue_t* pq, void* item, TickType_t wait) {
+    if (xSemaphoreTake(pq->items, wait) != pdPASS) return pdFAIL;
+
+    xSemaphoreTake(pq->lock, portMAX_DELAY);
+    remove_at(pq, 0, item);
+    xSemaphoreGive(pq->lock);
+
+    xSemaphoreGive(pq->spaces);
+    return pdPASS;
+}
+
+uint32_t prio_queue_receive_batch(prio_queue_t* pq, void* items, uint32_t max_count, TickType_t first_wait) {
+    uint8_t* p = items;
+    if (max_count == 0 || prio_queue_receive(pq, p, first_wait) != pdPASS) return 0;
+    uint32_t got = 1;
+    while (got < max_count && prio_queue_receive(pq, p + (size_t)got * pq->item_size, 0) == pdPASS) got++;
+    return got;
+}
+
+BaseType_t prio_queue_evict_lowest(prio_queue_t* pq, void* item) {
+    if (xSemaphoreTake(pq->items, 0) != pdPASS) return pdFAIL;
+
+    xSemaphoreTake(pq->lock, portMAX_DELAY);
+    // priority ต่ำสุด แล้วเลือกตัวที่เก่าสุด (แบบ drop-oldest) -> scan ทั้ง heap, n เล็ก
+    uint32_t worst = 0;
+    for (uint32_t i = 1; i < pq->count; i++) {
+        const prio_entry_t* a = &pq->heap[i];
+        const prio_entry_t* w = &pq->heap[worst];
+        if (a->prio < w->prio || (a->prio == w->prio && (int32_t)(a->seq - w->seq) < 0)) worst = i;
+    }
+    remove_at(pq, worst, item);
+    pq->evicted++;
+    xSemaphoreGive(pq->lock);
+
+    xSemaphoreGive(pq->spaces);
+    return pdPASS;
+}
+
+UBaseType_t prio_queue_count(const prio_queue_t* pq) {
+    return uxSemaphoreGetCount(pq->items);
+}
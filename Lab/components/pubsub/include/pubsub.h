@@ -0,0 +1,70 @@
+#ifndef PUBSUB_H
+#define PUBSUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// Pub/sub ในโปรเซส: topic -> subscriber queue หลายตัว
+//   ข้อความจองจากพูลของ broker (ขนาดเท่ากันทุกชิ้น) แล้ว publish ครั้งเดียว
+//   subscriber ทุกตัวได้ pointer ของข้อความเดียวกัน (ไม่ copy payload ต่อ subscriber)
+//   ข้อความมี ref count = จำนวน subscriber ที่ส่งถึง, คนสุดท้ายที่ release คืนพูล
+// กติกาความเป็นเจ้าของ:
+//   pubsub_alloc()    -> ผู้เรียกถือ 1 ref
+//   pubsub_publish()  -> กิน ref ของผู้เรียกเสมอ (สำเร็จหรือไม่ก็ตาม) ห้ามแตะข้อความอีก
+//   pubsub_receive()  -> subscriber ถือ 1 ref ต้อง pubsub_release() เอง และห้ามแก้ payload
+// subscriber queue เก็บ pointer (sizeof(void*)) ใส่ใน queue set ได้ตรง ๆ
+// สร้าง topic / subscribe ตอน setup ก่อนเริ่ม publish (ไม่มี lock ระหว่าง subscribe กับ publish)
+
+#define PUBSUB_MAX_TOPICS   8
+#define PUBSUB_MAX_SUBS     8
+
+typedef struct {
+    const char*      name;
+    QueueHandle_t    subs[PUBSUB_MAX_SUBS];
+    uint8_t          sub_count;
+    // stats (relaxed)
+    _Atomic uint32_t published;
+    _Atomic uint32_t delivered;
+    _Atomic uint32_t dropped;       // subscriber queue เต็มภายใน wait
+} pubsub_topic_t;
+
+typedef struct {
+    uint8_t*         mem;
+    size_t           msg_size;      // payload ต่อข้อความ
+    size_t           stride;        // header + payload (align 8)
+    uint16_t         msg_count;
+    QueueHandle_t    free_q;        // free list (เก็บ pointer)
+    pubsub_topic_t   topics[PUBSUB_MAX_TOPICS];
+    uint8_t          topic_count;
+    // stats (relaxed)
+    _Atomic uint32_t alloc_fail;
+    _Atomic uint32_t bad_release;
+} pubsub_broker_t;
+
+bool          pubsub_create(pubsub_broker_t* b, size_t msg_size, uint16_t msg_count);
+void          pubsub_destroy(pubsub_broker_t* b);
+
+// คืน id ของ topic (สร้างใหม่ถ้ายังไม่มี), -1 = เต็ม
+int           pubsub_topic(pubsub_broker_t* b, const char* name);
+// สร้างคิว depth ช่องแล้วผูกกับ topic, NULL = topic ไม่ถูกต้อง/subscriber เต็ม/หน่วยความจำไม่พอ
+QueueHandle_t pubsub_subscribe(pubsub_broker_t* b, int topic, UBaseType_t depth);
+
+void*         pubsub_alloc(pubsub_broker_t* b, TickType_t wait);
+// wait ใช้กับ subscriber แต่ละตัว คืนจำนวน subscriber ที่ได้รับ
+uint8_t       pubsub_publish(pubsub_broker_t* b, int topic, void* msg, TickType_t wait);
+void*         pubsub_receive(QueueHandle_t sub, TickType_t wait);
+void          pubsub_release(pubsub_broker_t* b, void* msg);
+
+int           pubsub_msg_topic(const void* msg);
+uint16_t      pubsub_in_use(const pubsub_broker_t* b);
+
+// bytes ที่ต้อง copy ต่อ publish: pointer เข้า/ออกคิวของ subscriber แต่ละตัว + เข้า/ออก free list
+// เทียบกับ 2 * subs * sizeof(payload) ถ้า copy ลงคิวของแต่ละ consumer
+static inline size_t pubsub_bytes_copied_per_publish(uint8_t subs) { return (2u * subs + 2u) * sizeof(void*); }
+
+#endif
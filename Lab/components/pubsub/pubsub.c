@@ -0,0 +1,157 @@
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "pubsub.h"
+
+static const char *TAG = "PUBSUB";
+
+// ===== Message header =====
+typedef struct {
+    _Atomic uint32_t refs;
+    uint16_t         magic;
+    uint8_t          topic;
+    uint8_t          reserved;
+} pubsub_hdr_t;
+
+#define PUBSUB_MAGIC  0x5B5Bu
+#define PUBSUB_ALIGN  8
+#define PUBSUB_NONE   0xFFu
+
+static inline pubsub_hdr_t* hdr_of(const void* msg) {
+    return (pubsub_hdr_t*)((uint8_t*)msg - sizeof(pubsub_hdr_t));
+}
+
+// ตรวจว่า pointer ชี้ payload ของข้อความในพูลนี้จริง
+static bool pool_owns(const pubsub_broker_t* b, const void* msg) {
+    const uint8_t* m = msg;
+    if (m < b->mem + sizeof(pubsub_hdr_t) || m >= b->mem + b->stride * b->msg_count) return false;
+    return ((size_t)(m - b->mem) - sizeof(pubsub_hdr_t)) % b->stride == 0;
+}
+
+// ===== Broker =====
+bool pubsub_create(pubsub_broker_t* b, size_t msg_size, uint16_t msg_count) {
+    memset(b, 0, sizeof(*b));
+    if (msg_size == 0 || msg_count == 0) return false;
+    b->msg_size = msg_size;
+    b->msg_count = msg_count;
+    b->stride = (sizeof(pubsub_hdr_t) + msg_size + PUBSUB_ALIGN - 1) & ~(size_t)(PUBSUB_ALIGN - 1);
+    b->mem = malloc(b->stride * msg_count);
+    b->free_q = xQueueCreate(msg_count, sizeof(void*));
+    if (!b->mem || !b->free_q) {
+        pubsub_destroy(b);
+        return false;
+    }
+    for (uint16_t i = 0; i < msg_count; i++) {
+        pubsub_hdr_t* h = (pubsub_hdr_t*)(b->mem + (size_t)i * b->stride);
+        atomic_init(&h->refs, 0);
+        h->magic = PUBSUB_MAGIC;
+        h->topic = PUBSUB_NONE;
+        void* msg = (uint8_t*)h + sizeof(pubsub_hdr_t);
+        xQueueSend(b->free_q, &msg, 0);
+    }
+    return true;
+}
+
+void pubsub_destroy(pubsub_broker_t* b) {
+    for (uint8_t t = 0; t < b->topic_count; t++) {
+        for (uint8_t s = 0; s < b->topics[t].sub_count; s++) vQueueDelete(b->topics[t].subs[s]);
+    }
+    if (b->free_q) vQueueDelete(b->free_q);
+    free(b->mem);
+    memset(b, 0, sizeof(*b));
+}
+
+int pubsub_topic(pubsub_broker_t* b, const char* name) {
+    for (uint8_t t = 0; t < b->topic_count; t++) {
+        if (strcmp(b->topics[t].name, name) == 0) return t;
+    }
+    if (b->topic_count >= PUBSUB_MAX_TOPICS) return -1;
+    b->topics[b->topic_count].name = name;
+    return b->topic_count++;
+}
+
+QueueHandle_t pubsub_subscribe(pubsub_broker_t* b, int topic, UBaseType_t depth) {
+    if (topic < 0 || topic >= b->topic_count) return NULL;
+    pubsub_topic_t* t = &b->topics[topic];
+    if (t->sub_count >= PUBSUB_MAX_SUBS) return NULL;
+    QueueHandle_t q = xQueueCreate(depth, sizeof(void*));
+    if (q) t->subs[t->sub_count++] = q;
+    return q;
+}
+
+// ===== Messages =====
+void* pubsub_alloc(pubsub_broker_t* b, TickType_t wait) {
+    void* msg = NULL;
+    if (xQueueReceive(b->free_q, &msg, wait) != pdPASS) {
+        atomic_fetch_add_explicit(&b->alloc_fail, 1, memory_order_relaxed);
+        return NULL;
+    }
+    pubsub_hdr_t* h = hdr_of(msg);
+    h->topic = PUBSUB_NONE;
+    atomic_store_explicit(&h->refs, 1, memory_order_relaxed);
+    return msg;
+}
+
+uint8_t pubsub_publish(pubsub_broker_t* b, int topic, void* msg, TickType_t wait) {
+    if (!msg) return 0;
+    if (topic < 0 || topic >= b->topic_count) {
+        ESP_LOGE(TAG, "publish to unknown topic %d", topic);
+        pubsub_release(b, msg);
+        return 0;
+    }
+    pubsub_topic_t* t = &b->topics[topic];
+    pubsub_hdr_t* h = hdr_of(msg);
+    h->topic = (uint8_t)topic;
+
+    // ตั้ง ref ให้ครบก่อนส่งชิ้นแรก: subscriber ที่ได้ก่อนอาจ release ระหว่างที่ยังส่งตัวถัดไป
+    // ผู้เรียกยังถือ 1 ref ไว้จนจบลูป จึงไม่มีทางคืนพูลกลางทาง
+    atomic_fetch_add_explicit(&h->refs, t->sub_count, memory_order_relaxed);
+
+    uint8_t delivered = 0;
+    for (uint8_t s = 0; s < t->sub_count; s++) {
+        if (xQueueSend(t->subs[s], &msg, wait) == pdPASS) {
+            delivered++;
+        } else {
+            atomic_fetch_add_explicit(&t->dropped, 1, memory_order_relaxed);
+            pubsub_release(b, msg);         // ref ของ subscriber ที่ส่งไม่ถึง
+        }
+    }
+    atomic_fetch_add_explicit(&t->published, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&t->delivered, delivered, memory_order_relaxed);
+    pubsub_release(b, msg);                 // ref ของผู้ publish
+    return delivered;
+}
+
+void* pubsub_receive(QueueHandle_t sub, TickType_t wait) {
+    void* msg = NULL;
+    if (xQueueReceive(sub, &msg, wait) != pdPASS) return NULL;
+    return msg;
+}
+
+void pubsub_release(pubsub_broker_t* b, void* msg) {
+    if (!msg) return;
+    if (!pool_owns(b, msg) || hdr_of(msg)->magic != PUBSUB_MAGIC) {
+        atomic_fetch_add_explicit(&b->bad_release, 1, memory_order_relaxed);
+        ESP_LOGE(TAG, "release of foreign pointer %p", msg);
+        return;
+    }
+    pubsub_hdr_t* h = hdr_of(msg);
+    // acq_rel: การอ่าน payload ของทุก subscriber ต้องจบก่อนข้อความกลับไปให้ผู้ alloc คนต่อไปเขียนทับ
+    uint32_t prev = atomic_fetch_sub_explicit(&h->refs, 1, memory_order_acq_rel);
+    if (prev == 0) {
+        atomic_fetch_add_explicit(&h->refs, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&b->bad_release, 1, memory_order_relaxed);
+        ESP_LOGE(TAG, "release of free message %p", msg);
+        return;
+    }
+    if (prev == 1) xQueueSend(b->free_q, &msg, 0);     // free_q จุได้ทุกข้อความ ไม่มีทางเต็ม
+}
+
+int pubsub_msg_topic(const void* msg) {
+    uint8_t t = hdr_of(msg)->topic;
+    return t == PUBSUB_NONE ? -1 : t;
+}
+
+uint16_t pubsub_in_use(const pubsub_broker_t* b) {
+    return (uint16_t)(b->msg_count - uxQueueMessagesWaiting(b->free_q));
+}
@@ -0,0 +1,26 @@
+#ifndef QUEUE_BATCH_H
+#define QUEUE_BATCH_H
+
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// Batch send/receive บน FreeRTOS queue
+//   timeout ใช้กับ "ชิ้นแรก" เท่านั้น ชิ้นที่เหลือใช้ timeout 0
+//   -> consumer ที่ตื่นขึ้นมาหนึ่งครั้งดึงของทั้ง burst ได้เลย ไม่ต้องวนกลับไป block ทีละชิ้น
+//   ชิ้นที่ไม่รอทำภายใต้ vTaskSuspendAll: task prio สูงกว่าที่ถูกปลุกจะได้ CPU หลังจบ batch
+//   (ห้ามเรียกจาก ISR หรือตอน scheduler ถูก suspend อยู่แล้ว)
+// items เป็น array ต่อกัน ขนาดชิ้นละ item_size (ต้องเท่ากับ item size ของคิว)
+//
+// ห้ามใช้ batch receive กับสมาชิกของ queue set: set ต้องการรับ 1 ชิ้นต่อ select 1 ครั้ง
+// ดึงเกินจะเหลือ handle ค้างใน set สะสมจนล้น (ดู event_dispatch ที่ select แบบไม่รอวนแทน)
+//
+// ตอนนี้ไม่มี lab ไหนเรียกใช้แล้ว (queue_sets/producer_consumer เลิกใช้ใน fix ของ user-033)
+// เหลือไว้ให้ queue_batch_bench วัด wakeups/goodput ตาม batch size
+
+UBaseType_t queue_send_batch(QueueHandle_t q, const void* items, size_t item_size,
+                             UBaseType_t count, TickType_t first_wait);
+UBaseType_t queue_receive_batch(QueueHandle_t q, void* items, size_t item_size,
+                                UBaseType_t max_count, TickType_t first_wait);
+
+#endif
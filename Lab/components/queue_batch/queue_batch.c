@@ -0,0 +1,56 @@
+#include <stdint.h>
+#include "freertos/task.h"
+#include "queue_batch.h"
+
+// ส่ง/รับแบบไม่รอภายใต้ vTaskSuspendAll: ถ้าปลุก task prio สูงกว่าที่รออยู่ มันจะยังไม่แย่ง CPU
+// จนกว่าจะ xTaskResumeAll -> ทั้ง batch ผ่านคิวในรอบเดียว (ถ้าวนธรรมดา โดน preempt ตั้งแต่ชิ้นแรก)
+// ห้าม block ระหว่าง suspend -> ชิ้นแรกที่ต้องรอทำนอก suspend แล้วค่อยกลับมาทำที่เหลือ
+static UBaseType_t send_nowait(QueueHandle_t q, const uint8_t* p, size_t item_size, UBaseType_t count)
+{
+    UBaseType_t sent = 0;
+    vTaskSuspendAll();
+    while (sent < count && xQueueSend(q, p, 0) == pdPASS) {
+        p += item_size;
+        sent++;
+    }
+    xTaskResumeAll();
+    return sent;
+}
+
+static UBaseType_t receive_nowait(QueueHandle_t q, uint8_t* p, size_t item_size, UBaseType_t max_count)
+{
+    UBaseType_t got = 0;
+    vTaskSuspendAll();
+    while (got < max_count && xQueueReceive(q, p, 0) == pdPASS) {
+        p += item_size;
+        got++;
+    }
+    xTaskResumeAll();
+    return got;
+}
+
+UBaseType_t queue_send_batch(QueueHandle_t q, const void* items, size_t item_size,
+                             UBaseType_t count, TickType_t first_wait)
+{
+    const uint8_t* p = items;
+    UBaseType_t sent = send_nowait(q, p, item_size, count);
+    if (sent == 0 && count > 0 && first_wait > 0) {
+        // คิวเต็ม: รอที่ว่างชิ้นแรก (ตอนนี้ไม่มี consumer รอของอยู่ จึงไม่มีใครแย่งกลางทาง)
+        if (xQueueSend(q, p, first_wait) != pdPASS) return 0;
+        sent = 1 + send_nowait(q, p + item_size, item_size, count - 1);
+    }
+    return sent;
+}
+
+UBaseType_t queue_receive_batch(QueueHandle_t q, void* items, size_t item_size,
+                                UBaseType_t max_count, TickType_t first_wait)
+{
+    uint8_t* p = items;
+    UBaseType_t got = receive_nowait(q, p, item_size, max_count);
+    if (got == 0 && max_count > 0 && first_wait > 0) {
+        // คิวว่าง: block รอชิ้นแรก แล้วกวาดส่วนที่ producer ใส่ตามมาในรอบเดียว
+        if (xQueueReceive(q, p, first_wait) != pdPASS) return 0;
+        got = 1 + receive_nowait(q, p + item_size, item_size, max_count - 1);
+    }
+    return got;
+}
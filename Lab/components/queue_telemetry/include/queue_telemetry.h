@@ -0,0 +1,64 @@
+#ifndef QUEUE_TELEMETRY_H
+#define QUEUE_TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// Telemetry ต่อคิว: นับทุก send/receive ณ จุดที่เกิดจริง แทนการ poll uxQueueMessagesWaiting เป็นระยะ
+//   high watermark (ทั้งช่วงล่าสุดและตลอดการทำงาน), อัตรา send/receive,
+//   full/empty event (เจอคิวเต็ม/ว่างตอนเริ่มเรียก), เวลารวมที่ task ติด block อยู่ในคิวนั้น
+// ใช้กับ xQueue ผ่าน queue_telemetry_send/receive ได้เลย
+// ช่องทางอื่น (spsc_ring, prio_queue, ...) ให้ wrapper ของ lab จับเวลาเองแล้วเรียก record_*
+// ตัวนับเป็น atomic relaxed: หลาย task ใช้คิวเดียวกันได้
+
+#define QUEUE_TELEMETRY_MAX  12
+
+typedef UBaseType_t (*queue_telemetry_count_fn_t)(void* q);
+
+typedef struct {
+    const char*                name;
+    void*                      q;
+    queue_telemetry_count_fn_t count;
+    uint32_t                   capacity;
+    _Atomic uint32_t           hwm;             // ช่วงล่าสุด (reset ตอน dump)
+    _Atomic uint32_t           peak;            // ตลอดการทำงาน
+    _Atomic uint32_t           sends;
+    _Atomic uint32_t           receives;
+    _Atomic uint32_t           full_events;
+    _Atomic uint32_t           empty_events;
+    // 64 bit: consumer ที่รอทั้งวันสะสม ~1 s ต่อวินาที, 32 bit us ล้นใน ~71 นาที
+    // (IDF ทำ atomic 64 bit บน Xtensa ด้วย critical section สั้น ๆ, เรียกเฉพาะตอนติด block อยู่แล้ว)
+    _Atomic uint64_t           send_blocked_us;
+    _Atomic uint64_t           recv_blocked_us;
+    // ค่าตอน dump ครั้งก่อน (ใช้โดย dump เท่านั้น)
+    uint32_t                   last_sends;
+    uint32_t                   last_receives;
+} queue_telemetry_t;
+
+bool        queue_telemetry_register(queue_telemetry_t* t, const char* name, void* q,
+                                     queue_telemetry_count_fn_t count, uint32_t capacity);
+UBaseType_t queue_telemetry_xqueue_count(void* q);     // count_fn สำหรับ QueueHandle_t
+
+// เรียกก่อนส่ง/รับ: จำเวลาและดูว่าคิวเต็ม/ว่างอยู่หรือไม่
+typedef struct {
+    int64_t t0_us;
+    bool    at_limit;
+} queue_telemetry_op_t;
+
+queue_telemetry_op_t queue_telemetry_begin_send(const queue_telemetry_t* t);
+queue_telemetry_op_t queue_telemetry_begin_receive(const queue_telemetry_t* t);
+void        queue_telemetry_end_send(queue_telemetry_t* t, queue_telemetry_op_t op, uint32_t sent);
+void        queue_telemetry_end_receive(queue_telemetry_t* t, queue_telemetry_op_t op, uint32_t received);
+
+// wrapper สำหรับ xQueue
+BaseType_t  queue_telemetry_send(queue_telemetry_t* t, const void* item, TickType_t wait);
+BaseType_t  queue_telemetry_receive(queue_telemetry_t* t, void* item, TickType_t wait);
+
+// พิมพ์ทุกคิวที่ลงทะเบียนเป็นตารางเดียว, อัตราคิดจาก interval_s ที่ผ่านมา แล้ว reset hwm ของช่วง
+void        queue_telemetry_dump(const char* tag, float interval_s);
+
+#endif
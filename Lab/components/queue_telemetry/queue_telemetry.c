@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "queue_telemetry.h"
+
+static queue_telemetry_t* registry[QUEUE_TELEMETRY_MAX];
+static _Atomic uint32_t   registered;
+
+bool queue_telemetry_register(queue_telemetry_t* t, const char* name, void* q,
+                              queue_telemetry_count_fn_t count, uint32_t capacity) {
+    memset(t, 0, sizeof(*t));
+    t->name = name;
+    t->q = q;
+    t->count = count;
+    t->capacity = capacity;
+    uint32_t i = atomic_fetch_add(&registered, 1);
+    if (i >= QUEUE_TELEMETRY_MAX) {
+        atomic_fetch_sub(&registered, 1);
+        return false;
+    }
+    registry[i] = t;
+    return true;
+}
+
+UBaseType_t queue_telemetry_xqueue_count(void* q) {
+    return uxQueueMessagesWaiting((QueueHandle_t)q);
+}
+
+static inline uint32_t depth(const queue_telemetry_t* t) {
+    return t->count ? (uint32_t)t->count(t->q) : 0;
+}
+
+static inline void update_max(_Atomic uint32_t* m, uint32_t v) {
+    uint32_t cur = atomic_load_explicit(m, memory_order_relaxed);
+    while (v > cur &&
+           !atomic_compare_exchange_weak_explicit(m, &cur, v, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+queue_telemetry_op_t queue_telemetry_begin_send(const queue_telemetry_t* t) {
+    return (queue_telemetry_op_t){ .t0_us = esp_timer_get_time(), .at_limit = depth(t) >= t->capacity };
+}
+
+queue_telemetry_op_t queue_telemetry_begin_receive(const queue_telemetry_t* t) {
+    return (queue_telemetry_op_t){ .t0_us = esp_timer_get_time(), .at_limit = depth(t) == 0 };
+}
+
+// เวลาที่เสียไปนับเป็น "blocked" เฉพาะตอนเริ่มเรียกแล้วคิวเต็ม/ว่าง (ต้องรอหรือกลับมามือเปล่า)
+void queue_telemetry_end_send(queue_telemetry_t* t, queue_telemetry_op_t op, uint32_t sent) {
+    if (op.at_limit) {
+        atomic_fetch_add_explicit(&t->full_events, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&t->send_blocked_us, (uint64_t)(esp_timer_get_time() - op.t0_us),
+                                  memory_order_relaxed);
+    }
+    if (sent) {
+        atomic_fetch_add_explicit(&t->sends, sent, memory_order_relaxed);
+        uint32_t d = depth(t);
+        update_max(&t->hwm, d);
+        update_max(&t->peak, d);
+    }
+}
+
+void queue_telemetry_end_receive(queue_telemetry_t* t, queue_telemetry_op_t op, uint32_t received) {
+    if (op.at_limit) {
+        atomic_fetch_add_explicit(&t->empty_events, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&t->recv_blocked_us, (uint64_t)(esp_timer_get_time() - op.t0_us),
+                                  memory_order_relaxed);
+    }
+    if (received) atomic_fetch_add_explicit(&t->receives, received, memory_order_relaxed);
+}
+
+BaseType_t queue_telemetry_send(queue_telemetry_t* t, const void* item, TickType_t wait) {
+    queue_telemetry_op_t op = queue_telemetry_begin_send(t);
+    BaseType_t ok = xQueueSend((QueueHandle_t)t->q, item, wait);
+    queue_telemetry_end_send(t, op, ok == pdPASS);
+    return ok;
+}
+
+BaseType_t queue_telemetry_receive(queue_telemetry_t* t, void* item, TickType_t wait) {
+    queue_telemetry_op_t op = queue_telemetry_begin_receive(t);
+    BaseType_t ok = xQueueReceive((QueueHandle_t)t->q, item, wait);
+    queue_telemetry_end_receive(t, op, ok == pdPASS);
+    return ok;
+}
+
+void queue_telemetry_dump(const char* tag, float interval_s) {
+    uint32_t n = atomic_load(&registered);
+    ESP_LOGI(tag, "%-10s %7s %7s %8s %8s %6s %6s %9s %9s",
+             "queue", "depth", "hwm/pk", "send/s", "recv/s", "full", "empty", "blk tx ms", "blk rx ms");
+    for (uint32_t i = 0; i < n; i++) {
+        queue_telemetry_t* t = registry[i];
+        uint32_t sends = atomic_load_explicit(&t->sends, memory_order_relaxed);
+        uint32_t recvs = atomic_load_explicit(&t->receives, memory_order_relaxed);
+        uint32_t hwm = atomic_exchange_explicit(&t->hwm, depth(t), memory_order_relaxed);
+        char d[24], h[24];
+        snprintf(d, sizeof(d), "%lu/%lu", (unsigned long)depth(t), (unsigned long)t->capacity);
+        snprintf(h, sizeof(h), "%lu/%lu", (unsigned long)hwm,
+                 (unsigned long)atomic_load_explicit(&t->peak, memory_order_relaxed));
+        ESP_LOGI(tag, "%-10s %7s %7s %8.2f %8.2f %6lu %6lu %9.1f %9.1f", t->name, d, h,
+                 interval_s > 0 ? (sends - t->last_sends) / interval_s : 0.0f,
+                 interval_s > 0 ? (recvs - t->last_receives) / interval_s : 0.0f,
+                 (unsigned long)atomic_load_explicit(&t->full_events, memory_order_relaxed),
+                 (unsigned long)atomic_load_explicit(&t->empty_events, memory_order_relaxed),
+                 (double)atomic_load_explicit(&t->send_blocked_us, memory_order_relaxed) / 1000.0,
+                 (double)atomic_load_explicit(&t->recv_blocked_us, memory_order_relaxed) / 1000.0);
+        t->last_sends = sends;
+        t->last_receives = recvs;
+    }
+}
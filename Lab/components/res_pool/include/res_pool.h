@@ -0,0 +1,74 @@
+#ifndef RES_POOL_H
+#define RES_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+// Resource pool: counting semaphore + bitmap ของ slot ว่าง (atomic)
+//   semaphore นับจำนวน slot ว่าง -> take สำเร็จ = มี bit ว่างรอเราอยู่แน่นอนอย่างน้อย 1 bit
+//   จากนั้นจอง bit ต่ำสุดด้วย ctz + compare-exchange (O(1), ไม่มี lock, ไม่ต้อง scan)
+//   ถ้าชนกับอีก task ที่จองพร้อมกันก็แค่ลองใหม่กับ mask ล่าสุด (นับไว้ใน cas_retries)
+//   release: set bit คืนก่อน แล้วค่อย give -> คนที่ take ได้ต่อไปเห็น bit เสมอ
+// slot index ที่ได้เป็นของผู้เรียกคนเดียวจน release -> ข้อมูลต่อ slot ไม่ต้อง lock
+//
+// RES_POOL_FIFO: ไม่ใช้ semaphore แต่ต่อคิวผู้รอเอง เรียงตาม priority แล้วตาม ticket (มาก่อนได้ก่อน)
+//   release ส่ง slot ให้ผู้รอหัวคิวโดยตรง (handoff) -> task ที่กำลังรันอยู่แซงคิวไม่ได้
+//   ปลุกผู้รอด้วย task notification (index 0): task ที่รอ slot ไม่ควรใช้ notification เองระหว่างรอ
+
+#define RES_POOL_MAX  32
+
+typedef enum {
+    RES_POOL_BARGE = 0,     // semaphore ปกติ: ใครตื่น/รันก่อนได้ก่อน
+    RES_POOL_FIFO,          // handoff ตามลำดับ priority แล้ว FIFO
+} res_pool_mode_t;
+
+typedef struct res_pool_waiter {
+    TaskHandle_t            task;
+    UBaseType_t             prio;
+    uint32_t                ticket;
+    int                     slot;       // -1 = ยังรอ
+    struct res_pool_waiter* next;
+} res_pool_waiter_t;
+
+typedef struct {
+    res_pool_mode_t   mode;
+    SemaphoreHandle_t sem;              // BARGE: จำนวน slot ว่าง (ใช้รอแบบ block/timeout)
+    _Atomic uint32_t  free_mask;        // bit i = slot i ว่าง
+    uint32_t          count;
+    // FIFO
+    portMUX_TYPE       lock;
+    res_pool_waiter_t* waiters;         // หัวคิว = คนถัดไปที่ได้ slot (อยู่บน stack ของผู้รอ)
+    uint32_t           next_ticket;
+    // stats (relaxed)
+    _Atomic uint32_t  acquired;
+    _Atomic uint32_t  timeouts;
+    _Atomic uint32_t  cas_retries;
+    _Atomic uint32_t  handoffs;         // FIFO: slot ที่ส่งตรงให้ผู้รอ
+    _Atomic uint32_t  bad_release;
+    _Atomic uint32_t  in_use;
+    _Atomic uint32_t  peak_in_use;
+} res_pool_t;
+
+bool     res_pool_create(res_pool_t* p, uint32_t count, res_pool_mode_t mode);    // 1..RES_POOL_MAX
+void     res_pool_destroy(res_pool_t* p);
+
+// คืน slot 0..count-1, -1 = หมดเวลา wait
+int      res_pool_acquire(res_pool_t* p, TickType_t wait);
+void     res_pool_release(res_pool_t* p, int slot);
+
+static inline uint32_t res_pool_available(const res_pool_t* p) {
+    if (p->mode == RES_POOL_FIFO) return (uint32_t)__builtin_popcount(atomic_load_explicit(&p->free_mask, memory_order_relaxed));
+    return (uint32_t)uxSemaphoreGetCount(p->sem);
+}
+static inline uint32_t res_pool_in_use(const res_pool_t* p) { return atomic_load_explicit(&p->in_use, memory_order_relaxed); }
+static inline bool     res_pool_slot_busy(const res_pool_t* p, int slot) {
+    return !(atomic_load_explicit(&p->free_mask, memory_order_relaxed) & (1u << slot));
+}
+static inline const char* res_pool_mode_name(res_pool_mode_t m) { return m == RES_POOL_FIFO ? "fifo" : "barge"; }
+
+#endif
@@ -0,0 +1,180 @@
+#include <string.h>
+#include "esp_log.h"
+#include "res_pool.h"
+
+static const char *TAG = "RES_POOL";
+
+bool res_pool_create(res_pool_t* p, uint32_t count, res_pool_mode_t mode) {
+    memset(p, 0, sizeof(*p));
+    if (count == 0 || count > RES_POOL_MAX) return false;
+    if (mode == RES_POOL_BARGE) {
+        p->sem = xSemaphoreCreateCounting(count, count);
+        if (!p->sem) return false;
+    }
+    p->mode = mode;
+    p->count = count;
+    p->lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    atomic_init(&p->free_mask, count == 32 ? UINT32_MAX : (1u << count) - 1);
+    return true;
+}
+
+void res_pool_destroy(res_pool_t* p) {
+    if (p->sem) vSemaphoreDelete(p->sem);
+    memset(p, 0, sizeof(*p));
+}
+
+// จอง bit ว่างต่ำสุด: เรียกหลัง take สำเร็จเท่านั้น (การันตีว่ามี bit ว่างให้เรา)
+static int claim_slot(res_pool_t* p) {
+    uint32_t mask = atomic_load_explicit(&p->free_mask, memory_order_relaxed);
+    for (;;) {
+        if (mask == 0) {
+            // ไม่ควรเกิด: semaphore กับ bitmap ไม่ตรงกัน (release ผิด slot จากภายนอก)
+            ESP_LOGE(TAG, "semaphore taken but bitmap empty");
+            return -1;
+        }
+        int slot = __builtin_ctz(mask);
+        // acquire: ข้อมูลที่เจ้าของเก่าเขียนไว้ใน slot ต้องเห็นครบก่อนเราใช้
+        if (atomic_compare_exchange_weak_explicit(&p->free_mask, &mask, mask & ~(1u << slot),
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            return slot;
+        }
+        atomic_fetch_add_explicit(&p->cas_retries, 1, memory_order_relaxed);
+    }
+}
+
+// ===== FIFO =====
+// เรียง priority สูงก่อน, priority เท่ากันต่อท้ายกลุ่ม -> ticket น้อยอยู่ก่อนเสมอ (เรียกใน critical)
+static void waiter_insert(res_pool_t* p, res_pool_waiter_t* w) {
+    res_pool_waiter_t** pp = &p->waiters;
+    while (*pp && (*pp)->prio >= w->prio) pp = &(*pp)->next;
+    w->next = *pp;
+    *pp = w;
+}
+
+static void waiter_remove(res_pool_t* p, res_pool_waiter_t* w) {
+    for (res_pool_waiter_t** pp = &p->waiters; *pp; pp = &(*pp)->next) {
+        if (*pp == w) {
+            *pp = w->next;
+            return;
+        }
+    }
+}
+
+static int acquire_fifo(res_pool_t* p, TickType_t wait) {
+    TickType_t t0 = xTaskGetTickCount();
+    res_pool_waiter_t w = {
+        .task = xTaskGetCurrentTaskHandle(),
+        .prio = uxTaskPriorityGet(NULL),
+        .slot = -1,
+    };
+
+    portENTER_CRITICAL(&p->lock);
+    uint32_t mask = atomic_load_explicit(&p->free_mask, memory_order_relaxed);
+    // มีคนรออยู่ = ต้องต่อคิว แม้จะมี bit ว่าง (กันแซงคิว)
+    if (p->waiters == NULL && mask) {
+        int slot = __builtin_ctz(mask);
+        atomic_fetch_and_explicit(&p->free_mask, ~(1u << slot), memory_order_acquire);
+        portEXIT_CRITICAL(&p->lock);
+        return slot;
+    }
+    if (wait == 0) {
+        portEXIT_CRITICAL(&p->lock);
+        return -1;
+    }
+    w.ticket = p->next_ticket++;
+    waiter_insert(p, &w);
+    portEXIT_CRITICAL(&p->lock);
+
+    for (;;) {
+        TickType_t elapsed = xTaskGetTickCount() - t0;
+        TickType_t left = wait == portMAX_DELAY ? portMAX_DELAY : (elapsed >= wait ? 0 : wait - elapsed);
+        if (left) ulTaskNotifyTake(pdTRUE, left);
+
+        portENTER_CRITICAL(&p->lock);
+        if (w.slot >= 0) {
+            portEXIT_CRITICAL(&p->lock);
+            return w.slot;
+        }
+        if (wait != portMAX_DELAY && xTaskGetTickCount() - t0 >= wait) {
+            waiter_remove(p, &w);
+            portEXIT_CRITICAL(&p->lock);
+            return -1;
+        }
+        portEXIT_CRITICAL(&p->lock);   // ตื่นเพราะ notification ค้างจากรอบก่อน -> รอต่อ
+    }
+}
+
+static void release_fifo(res_pool_t* p, int slot) {
+    TaskHandle_t wake = NULL;
+    portENTER_CRITICAL(&p->lock);
+    if (atomic_load_explicit(&p->free_mask, memory_order_relaxed) & (1u << slot)) {
+        portEXIT_CRITICAL(&p->lock);
+        atomic_fetch_add_explicit(&p->bad_release, 1, memory_order_relaxed);
+        ESP_LOGE(TAG, "double release of slot %d", slot);
+        return;
+    }
+    atomic_fetch_sub_explicit(&p->in_use, 1, memory_order_relaxed);
+    res_pool_waiter_t* w = p->waiters;
+    if (w) {
+        // handoff: slot ไม่กลับเข้า bitmap เลย ผู้รอหัวคิวได้ไปตรง ๆ
+        p->waiters = w->next;
+        w->slot = slot;
+        wake = w->task;         // copy ก่อนออก: หลังจากนี้ w อาจหายไปพร้อม stack ของผู้รอ
+        atomic_fetch_add_explicit(&p->handoffs, 1, memory_order_relaxed);
+    } else {
+        atomic_fetch_or_explicit(&p->free_mask, 1u << slot, memory_order_release);
+    }
+    portEXIT_CRITICAL(&p->lock);
+    if (wake) xTaskNotifyGive(wake);
+}
+
+// ===== API =====
+int res_pool_acquire(res_pool_t* p, TickType_t wait) {
+    int slot;
+    if (p->mode == RES_POOL_FIFO) {
+        slot = acquire_fifo(p, wait);
+        if (slot < 0) {
+            atomic_fetch_add_explicit(&p->timeouts, 1, memory_order_relaxed);
+            return -1;
+        }
+    } else {
+        if (xSemaphoreTake(p->sem, wait) != pdTRUE) {
+            atomic_fetch_add_explicit(&p->timeouts, 1, memory_order_relaxed);
+            return -1;
+        }
+        slot = claim_slot(p);
+        if (slot < 0) {
+            xSemaphoreGive(p->sem);
+            return -1;
+        }
+    }
+    atomic_fetch_add_explicit(&p->acquired, 1, memory_order_relaxed);
+    uint32_t used = atomic_fetch_add_explicit(&p->in_use, 1, memory_order_relaxed) + 1;
+    uint32_t peak = atomic_load_explicit(&p->peak_in_use, memory_order_relaxed);
+    while (used > peak &&
+           !atomic_compare_exchange_weak_explicit(&p->peak_in_use, &peak, used,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+    return slot;
+}
+
+void res_pool_release(res_pool_t* p, int slot) {
+    if (slot < 0 || (uint32_t)slot >= p->count) {
+        atomic_fetch_add_explicit(&p->bad_release, 1, memory_order_relaxed);
+        ESP_LOGE(TAG, "release of invalid slot %d", slot);
+        return;
+    }
+    if (p->mode == RES_POOL_FIFO) {
+        release_fifo(p, slot);
+        return;
+    }
+    // release: งานที่ทำกับ slot ต้องเสร็จก่อนคนถัดไปเห็น bit ว่าง
+    uint32_t prev = atomic_fetch_or_explicit(&p->free_mask, 1u << slot, memory_order_release);
+    if (prev & (1u << slot)) {
+        atomic_fetch_add_explicit(&p->bad_release, 1, memory_order_relaxed);
+        ESP_LOGE(TAG, "double release of slot %d", slot);
+        return;
+    }
+    atomic_fetch_sub_explicit(&p->in_use, 1, memory_order_relaxed);
+    xSemaphoreGive(p->sem);
+}
@@ -0,0 +1,43 @@
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Bump arena ต่อ task สำหรับตัวแปรชั่วคราวในแต่ละรอบของ loop
+// จองก้อนเดียวตอน task เริ่ม -> alloc = เลื่อน pointer, reset ต้นรอบคืนทั้งหมดทีเดียว
+// arena หนึ่งตัวใช้โดย task เดียว (ไม่มี lock); task อื่นอ่าน stats ได้อย่างเดียว
+
+#define SCRATCH_ALIGN  8
+
+typedef size_t scratch_mark_t;
+
+typedef struct {
+    uint8_t*    base;
+    size_t      size;
+    size_t      top;            // offset ถัดไปที่ว่าง
+    const char* name;
+    void*       owned_mem;      // region ที่ scratch_arena_create() จองให้
+    // stats
+    size_t      peak;           // top สูงสุดตั้งแต่สร้าง (ใช้ปรับขนาด arena)
+    size_t      cur_peak;       // top สูงสุดในรอบปัจจุบัน
+    size_t      cycle_peak;     // top สูงสุดของรอบก่อนหน้า
+    uint32_t    resets;
+    uint32_t    overflows;
+} scratch_arena_t;
+
+bool           scratch_arena_init(scratch_arena_t* a, void* mem, size_t bytes, const char* name);
+bool           scratch_arena_create(scratch_arena_t* a, size_t bytes, uint32_t caps, const char* name);
+void           scratch_arena_destroy(scratch_arena_t* a);
+
+void*          scratch_alloc(scratch_arena_t* a, size_t size);     // NULL ถ้าไม่พอ
+void*          scratch_calloc(scratch_arena_t* a, size_t n, size_t size);
+
+scratch_mark_t scratch_arena_mark(const scratch_arena_t* a);
+void           scratch_arena_release(scratch_arena_t* a, scratch_mark_t mark);
+void           scratch_arena_reset(scratch_arena_t* a);           // เรียกต้นทุกรอบ
+
+void           scratch_arena_log(const scratch_arena_t* a, const char* tag);
+
+#endif
@@ -0,0 +1,101 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#ifndef CONFIG_IDF_TARGET_LINUX
+#include "esp_heap_caps.h"
+#endif
+#include "scratch_arena.h"
+
+static const char *TAG = "SCRATCH";
+
+// คู่กับ heap_caps_malloc ใน scratch_arena_create
+static void owned_free(void* mem) {
+#ifdef CONFIG_IDF_TARGET_LINUX
+    free(mem);
+#else
+    heap_caps_free(mem);
+#endif
+}
+
+static inline size_t align_up(size_t x) {
+    return (x + SCRATCH_ALIGN - 1) & ~(size_t)(SCRATCH_ALIGN - 1);
+}
+
+bool scratch_arena_init(scratch_arena_t* a, void* mem, size_t bytes, const char* name) {
+    memset(a, 0, sizeof(*a));
+    if (!mem || bytes < SCRATCH_ALIGN) return false;
+    // ให้ base ชิด SCRATCH_ALIGN เพื่อให้ทุก offset ที่ align แล้วเป็น pointer ที่ align ด้วย
+    uintptr_t p = ((uintptr_t)mem + SCRATCH_ALIGN - 1) & ~(uintptr_t)(SCRATCH_ALIGN - 1);
+    size_t lost = (size_t)(p - (uintptr_t)mem);
+    if (lost >= bytes) return false;
+    a->base = (uint8_t*)p;
+    a->size = (bytes - lost) & ~(size_t)(SCRATCH_ALIGN - 1);
+    a->name = name ? name : "scratch";
+    return true;
+}
+
+bool scratch_arena_create(scratch_arena_t* a, size_t bytes, uint32_t caps, const char* name) {
+    bytes = align_up(bytes);
+#ifdef CONFIG_IDF_TARGET_LINUX
+    (void)caps;
+    void* mem = malloc(bytes);
+#else
+    void* mem = heap_caps_malloc(bytes, caps);
+#endif
+    if (!scratch_arena_init(a, mem, bytes, name)) {
+        owned_free(mem);
+        return false;
+    }
+    a->owned_mem = mem;
+    return true;
+}
+
+void scratch_arena_destroy(scratch_arena_t* a) {
+    owned_free(a->owned_mem);
+    memset(a, 0, sizeof(*a));
+}
+
+void* scratch_alloc(scratch_arena_t* a, size_t size) {
+    size_t need = align_up(size ? size : 1);
+    if (need > a->size - a->top) {
+        a->overflows++;
+        ESP_LOGW(TAG, "%s: overflow (%u + %u > %u bytes)",
+                 a->name, (unsigned)a->top, (unsigned)need, (unsigned)a->size);
+        return NULL;
+    }
+    void* p = a->base + a->top;
+    a->top += need;
+    if (a->top > a->cur_peak) a->cur_peak = a->top;
+    if (a->top > a->peak) a->peak = a->top;
+    return p;
+}
+
+void* scratch_calloc(scratch_arena_t* a, size_t n, size_t size) {
+    if (size && n > SIZE_MAX / size) return NULL;
+    void* p = scratch_alloc(a, n * size);
+    if (p) memset(p, 0, n * size);
+    return p;
+}
+
+scratch_mark_t scratch_arena_mark(const scratch_arena_t* a) {
+    return a->top;
+}
+
+void scratch_arena_release(scratch_arena_t* a, scratch_mark_t mark) {
+    if (mark <= a->top) a->top = mark;
+}
+
+void scratch_arena_reset(scratch_arena_t* a) {
+    a->cycle_peak = a->cur_peak;
+    a->cur_peak = 0;
+    a->top = 0;
+    a->resets++;
+}
+
+void scratch_arena_log(const scratch_arena_t* a, const char* tag) {
+    ESP_LOGI(tag, "%s arena: peak %u/%u bytes (%.0f%%), last cycle %u, resets %lu, overflows %lu",
+             a->name, (unsigned)a->peak, (unsigned)a->size,
+             a->size ? (float)a->peak * 100.0f / (float)a->size : 0.0f,
+             (unsigned)a->cycle_peak, (unsigned long)a->resets, (unsigned long)a->overflows);
+}
@@ -0,0 +1,97 @@
+#ifndef SENSOR_PACK_H
+#define SENSOR_PACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Record ค่า sensor แบบ fixed-point 8 byte (เทียบกับ 16 byte ของ int + float + float + tick)
+//   temperature / humidity เก็บเป็น x10 ใน 16 bit (ความละเอียด 0.1 เท่าที่ generator สร้างจริง)
+//   timestamp เก็บเป็น delta tick จาก record ก่อนหน้าใน stream เดียวกัน (16 bit)
+// delta อ่านกลับได้เฉพาะ stream ที่ไม่ทิ้งของและเรียงลำดับ (sensor_hist_t)
+// ช่องทางที่ทับค่า/ทิ้งของ (mailbox, drop-oldest) ใช้ได้แค่ค่า T/H/id ของ record
+// ค่าที่เกินช่วงถูก clamp, gap ที่เกิน 65535 tick ถูก clamp และติด SENSOR_REC_GAP (เวลาเป็นค่าต่ำสุด)
+
+#define SENSOR_PACK_SCALE   10
+
+#define SENSOR_REC_GAP      (1u << 0)   // dt_ticks ถูก clamp
+#define SENSOR_REC_CLAMPED  (1u << 1)   // T หรือ H เกินช่วงที่เก็บได้
+
+typedef struct {
+    int16_t  temp_c10;          // °C x10
+    uint16_t hum_p10;           // %RH x10
+    uint16_t dt_ticks;          // tick ห่างจาก record ก่อนหน้า (record แรกของ stream = 0)
+    uint8_t  sensor_id;
+    uint8_t  flags;             // SENSOR_REC_*
+} sensor_rec_t;
+
+_Static_assert(sizeof(sensor_rec_t) == 8, "sensor_rec_t must stay 8 bytes");
+
+// รูปแบบเต็ม (ที่ผู้ใช้เห็น) 16 byte
+typedef struct {
+    int      sensor_id;
+    float    temperature;
+    float    humidity;
+    uint32_t timestamp;         // tick
+} sensor_sample_t;
+
+// สรุปหน้าต่าง (min/max/mean/count) แบบ x10, 8 byte แทน 16
+typedef struct {
+    int16_t  min;
+    int16_t  max;
+    int16_t  mean;
+    uint16_t count;             // clamp ที่ 65535
+} sensor_pack_stat_t;
+
+// ===== Scalar =====
+static inline int16_t sensor_pack_q10(float v) {
+    float s = v * SENSOR_PACK_SCALE;
+    if (s >= 32767.0f) return INT16_MAX;
+    if (s <= -32768.0f) return INT16_MIN;
+    return (int16_t)(s < 0 ? s - 0.5f : s + 0.5f);
+}
+
+static inline uint16_t sensor_pack_uq10(float v) {
+    float s = v * SENSOR_PACK_SCALE;
+    if (s >= 65535.0f) return UINT16_MAX;
+    if (s <= 0.0f) return 0;
+    return (uint16_t)(s + 0.5f);
+}
+
+static inline float sensor_pack_f10(int32_t q) { return (float)q / SENSOR_PACK_SCALE; }
+
+static inline float sensor_rec_temp(const sensor_rec_t* r) { return sensor_pack_f10(r->temp_c10); }
+static inline float sensor_rec_hum(const sensor_rec_t* r)  { return sensor_pack_f10(r->hum_p10); }
+
+// เติม id/T/H (dt_ticks = 0) สำหรับส่งค่าเดี่ยว ๆ ที่ไม่ได้อยู่ใน stream
+void sensor_pack_values(const sensor_sample_t* s, sensor_rec_t* out);
+void sensor_pack_stat(float min, float max, float mean, uint32_t count, sensor_pack_stat_t* out);
+
+// ===== History =====
+// ring ของ sensor_rec_t บน buffer ของผู้เรียก, เต็มแล้วทับตัวเก่าสุด
+// เก็บ tick เต็มของ record เก่าสุด (base_tick) ไว้ตัวเดียว record ที่เหลือเป็น delta
+// ไม่ thread-safe: writer/reader ต่าง task ต้อง lock เอง
+typedef struct {
+    sensor_rec_t* buf;
+    uint16_t      cap;
+    uint16_t      head;         // ช่องเก่าสุด
+    uint16_t      count;
+    uint32_t      base_tick;    // tick ของ record ที่ head
+    uint32_t      last_tick;    // tick ของ record ล่าสุด (ฐานของ delta ถัดไป)
+    // stats
+    uint32_t      appended;
+    uint32_t      gaps;
+    uint32_t      clamped;
+} sensor_hist_t;
+
+void     sensor_hist_init(sensor_hist_t* h, sensor_rec_t* buf, uint16_t cap);
+// encode + ต่อท้าย, คืน record ที่เก็บ (ส่งต่อลงคิวได้เลย) ทาง out (NULL ได้)
+void     sensor_hist_append(sensor_hist_t* h, const sensor_sample_t* s, sensor_rec_t* out);
+// decode จากเก่าไปใหม่ ได้สูงสุด max ตัว คืนจำนวนที่เขียน
+uint16_t sensor_hist_decode(const sensor_hist_t* h, sensor_sample_t* out, uint16_t max);
+static inline uint32_t sensor_hist_span_ticks(const sensor_hist_t* h) { return h->count ? h->last_tick - h->base_tick : 0; }
+static inline uint32_t sensor_hist_bytes(const sensor_hist_t* h) { return (uint32_t)h->cap * sizeof(sensor_rec_t); }
+
+// จำนวน record ต่อ 1 KB
+static inline uint32_t sensor_pack_records_per_kb(uint32_t record_size) { return 1024u / record_size; }
+
+#endif
@@ -0,0 +1,83 @@
+#include <string.h>
+#include "sensor_pack.h"
+
+// ===== Record =====
+static uint8_t pack_values(const sensor_sample_t* s, sensor_rec_t* out) {
+    out->temp_c10 = sensor_pack_q10(s->temperature);
+    out->hum_p10 = sensor_pack_uq10(s->humidity);
+    out->sensor_id = (uint8_t)s->sensor_id;
+    bool clamped = out->temp_c10 == INT16_MAX || out->temp_c10 == INT16_MIN ||
+                   out->hum_p10 == UINT16_MAX || s->humidity < 0.0f ||
+                   s->sensor_id < 0 || s->sensor_id > UINT8_MAX;
+    return clamped ? SENSOR_REC_CLAMPED : 0;
+}
+
+void sensor_pack_values(const sensor_sample_t* s, sensor_rec_t* out) {
+    out->flags = pack_values(s, out);
+    out->dt_ticks = 0;
+}
+
+void sensor_pack_stat(float min, float max, float mean, uint32_t count, sensor_pack_stat_t* out) {
+    out->min = sensor_pack_q10(min);
+    out->max = sensor_pack_q10(max);
+    out->mean = sensor_pack_q10(mean);
+    out->count = count > UINT16_MAX ? UINT16_MAX : (uint16_t)count;
+}
+
+// ===== History =====
+void sensor_hist_init(sensor_hist_t* h, sensor_rec_t* buf, uint16_t cap) {
+    memset(h, 0, sizeof(*h));
+    h->buf = buf;
+    h->cap = cap;
+}
+
+void sensor_hist_append(sensor_hist_t* h, const sensor_sample_t* s, sensor_rec_t* out) {
+    sensor_rec_t r;
+    r.flags = pack_values(s, &r);
+
+    if (h->appended == 0) {
+        r.dt_ticks = 0;
+    } else {
+        uint32_t dt = s->timestamp - h->last_tick;
+        if (dt > UINT16_MAX) {
+            dt = UINT16_MAX;
+            r.flags |= SENSOR_REC_GAP;
+            h->gaps++;
+        }
+        r.dt_ticks = (uint16_t)dt;
+    }
+    // เก็บเวลาที่ decode ได้จริง (หลัง clamp) เป็นฐานของ delta ถัดไป -> ไม่สะสม error
+    h->last_tick = h->appended == 0 ? s->timestamp : h->last_tick + r.dt_ticks;
+    if (r.flags & SENSOR_REC_CLAMPED) h->clamped++;
+    h->appended++;
+    if (out) *out = r;
+
+    if (h->cap) {
+        if (h->count == h->cap) {
+            // ทับตัวเก่าสุด: ฐานเลื่อนไปที่ตัวถัดไป
+            h->head = (uint16_t)((h->head + 1) % h->cap);
+            h->count--;
+            if (h->count) h->base_tick += h->buf[h->head].dt_ticks;
+        }
+        if (h->count == 0) {
+            h->base_tick = h->last_tick;
+            r.dt_ticks = 0;     // ตัวแรกใน ring ไม่มีตัวก่อนหน้าให้อ้างอิง
+        }
+        h->buf[(h->head + h->count) % h->cap] = r;
+        h->count++;
+    }
+}
+
+uint16_t sensor_hist_decode(const sensor_hist_t* h, sensor_sample_t* out, uint16_t max) {
+    uint16_t n = h->count < max ? h->count : max;
+    uint32_t tick = h->base_tick;
+    for (uint16_t i = 0; i < n; i++) {
+        const sensor_rec_t* r = &h->buf[(h->head + i) % h->cap];
+        if (i) tick += r->dt_ticks;
+        out[i].sensor_id = r->sensor_id;
+        out[i].temperature = sensor_rec_temp(r);
+        out[i].humidity = sensor_rec_hum(r);
+        out[i].timestamp = tick;
+    }
+    return n;
+}
@@ -0,0 +1,45 @@
+#ifndef SHARD_STATS_H
+#define SHARD_STATS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+
+// ตัวนับสถิติแบบแยก shard ต่อ core
+//   แต่ละ core เขียนเฉพาะ shard ของตัวเอง (1 shard = 1 cache line) -> สอง core ไม่แย่ง line เดียวกัน
+//   เพิ่มค่าด้วย atomic relaxed: task บน core เดียวกัน preempt กันกลาง ++ ก็ไม่หาย
+//   และถ้า task ย้าย core ระหว่างอ่าน core id กับ add ก็แค่ไปลง shard อื่น ผลรวมยังถูก
+// อ่านด้วยการรวมทุก shard แบบไม่ lock (ค่าต่อ counter ถูกต้อง, ระหว่าง counter ไม่ใช่ snapshot เดียวกัน)
+// ตัวนับแบบขึ้นลง (เช่น in_use) ใช้ add/sub ได้: ผลรวม modulo 2^32 ยังถูก แม้ shard เดี่ยวจะ "ติดลบ"
+//
+// ใช้: ประกาศ enum ของตัวนับในแต่ละ lab แล้วใช้ค่า enum เป็น id (ไม่เกิน SHARD_STATS_MAX_COUNTERS)
+
+#define SHARD_STATS_CACHE_LINE    32
+#define SHARD_STATS_MAX_COUNTERS  (SHARD_STATS_CACHE_LINE / sizeof(uint32_t))
+
+typedef struct {
+    _Atomic uint32_t c[SHARD_STATS_MAX_COUNTERS];
+} __attribute__((aligned(SHARD_STATS_CACHE_LINE))) shard_stats_shard_t;
+
+typedef struct {
+    shard_stats_shard_t shard[portNUM_PROCESSORS];
+} shard_stats_t;
+
+void     shard_stats_init(shard_stats_t* s);
+uint32_t shard_stats_sum(const shard_stats_t* s, uint32_t id);
+void     shard_stats_read(const shard_stats_t* s, uint32_t* out, uint32_t count);   // id 0..count-1
+
+static inline void shard_stats_add(shard_stats_t* s, uint32_t id, uint32_t n) {
+    atomic_fetch_add_explicit(&s->shard[xPortGetCoreID()].c[id], n, memory_order_relaxed);
+}
+
+static inline void shard_stats_inc(shard_stats_t* s, uint32_t id) {
+    shard_stats_add(s, id, 1);
+}
+
+static inline void shard_stats_sub(shard_stats_t* s, uint32_t id, uint32_t n) {
+    atomic_fetch_sub_explicit(&s->shard[xPortGetCoreID()].c[id], n, memory_order_relaxed);
+}
+
+#endif
@@ -0,0 +1,23 @@
+#include "shard_stats.h"
+
+void shard_stats_init(shard_stats_t* s) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        for (uint32_t i = 0; i < SHARD_STATS_MAX_COUNTERS; i++) {
+            atomic_init(&s->shard[core].c[i], 0);
+        }
+    }
+}
+
+uint32_t shard_stats_sum(const shard_stats_t* s, uint32_t id) {
+    uint32_t sum = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        sum += atomic_load_explicit(&s->shard[core].c[id], memory_order_relaxed);
+    }
+    return sum;
+}
+
+void shard_stats_read(const shard_stats_t* s, uint32_t* out, uint32_t count) {
+    for (uint32_t i = 0; i < count && i < SHARD_STATS_MAX_COUNTERS; i++) {
+        out[i] = shard_stats_sum(s, i);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Ring buffer สำหรับ producer 1 ตัว + consumer 1 ตัวเท่านั้น (ไม่มี lock / critical section)
+//   head เขียนโดย producer, tail เขียนโดย consumer -> แยกคนละ cache line กัน false sharing
+//   ข้อมูลใน slot publish ด้วย release store ของ head/tail, อีกฝั่งอ่านด้วย acquire
+// เมื่อว่าง/เต็ม task ที่รอจะ block ด้วย task notification (index 0)
+// ดังนั้น producer/consumer ห้ามใช้ notification index 0 เพื่อจุดประสงค์อื่นระหว่างรอ
+
+#define SPSC_CACHE_LINE  32     // cache line ของ ESP32 (flash/PSRAM cache)
+
+typedef struct {
+    // --- producer line ---
+    _Atomic uint32_t head;                  // slot ถัดไปที่จะเขียน (free-running)
+    uint32_t         cached_tail;           // สำเนา tail ที่ producer เห็นล่าสุด
+    uint32_t         full_waits;
+    uint8_t          _pad0[SPSC_CACHE_LINE - 3 * sizeof(uint32_t)];
+    // --- consumer line ---
+    _Atomic uint32_t tail;                  // slot ถัดไปที่จะอ่าน (free-running)
+    uint32_t         cached_head;
+    uint32_t         empty_waits;
+    uint8_t          _pad1[SPSC_CACHE_LINE - 3 * sizeof(uint32_t)];
+    // --- อ่านอย่างเดียวหลัง create + slot ของ task ที่กำลังรอ ---
+    _Atomic(TaskHandle_t) consumer_wait;
+    _Atomic(TaskHandle_t) producer_wait;
+    uint8_t*         buf;
+    uint32_t         item_size;
+    uint32_t         capacity;              // 2^n
+    uint32_t         mask;
+} __attribute__((aligned(SPSC_CACHE_LINE))) spsc_ring_t;
+
+bool       spsc_ring_create(spsc_ring_t* r, uint32_t item_size, uint32_t capacity);   // capacity ปัดขึ้นเป็น 2^n
+void       spsc_ring_destroy(spsc_ring_t* r);
+
+bool       spsc_ring_try_send(spsc_ring_t* r, const void* item);
+bool       spsc_ring_try_receive(spsc_ring_t* r, void* item);
+BaseType_t spsc_ring_send(spsc_ring_t* r, const void* item, TickType_t wait);
+BaseType_t spsc_ring_receive(spsc_ring_t* r, void* item, TickType_t wait);
+
+uint32_t   spsc_ring_count(const spsc_ring_t* r);     // ค่าประมาณเมื่อเรียกจาก task ที่สาม
+
+#endif
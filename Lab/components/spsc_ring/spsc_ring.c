@@ -0,0 +1,112 @@
+#include <stdlib.h>
+#include <string.h>
+#include "spsc_ring.h"
+
+static inline uint32_t next_pow2(uint32_t x) {
+    uint32_t p = 1;
+    while (p < x) p <<= 1;
+    return p;
+}
+
+bool spsc_ring_create(spsc_ring_t* r, uint32_t item_size, uint32_t capacity) {
+    memset(r, 0, sizeof(*r));
+    if (item_size == 0 || capacity == 0) return false;
+    r->capacity = next_pow2(capacity);
+    r->mask = r->capacity - 1;
+    r->item_size = item_size;
+    r->buf = malloc((size_t)item_size * r->capacity);
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    atomic_init(&r->consumer_wait, NULL);
+    atomic_init(&r->producer_wait, NULL);
+    return r->buf != NULL;
+}
+
+void spsc_ring_destroy(spsc_ring_t* r) {
+    free(r->buf);
+    memset(r, 0, sizeof(*r));
+}
+
+// ปลุกอีกฝั่งถ้ามันประกาศว่ากำลังรอ (exchange กันปลุกซ้ำ)
+static inline void wake(_Atomic(TaskHandle_t)* slot) {
+    // fence คู่กับฝั่งที่รอ: store index -> load slot / store slot -> load index
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(slot, memory_order_relaxed) != NULL) {
+        TaskHandle_t t = atomic_exchange_explicit(slot, NULL, memory_order_acq_rel);
+        if (t) xTaskNotifyGive(t);
+    }
+}
+
+// ===== Producer side =====
+bool spsc_ring_try_send(spsc_ring_t* r, const void* item) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    if (head - r->cached_tail == r->capacity) {
+        r->cached_tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+        if (head - r->cached_tail == r->capacity) return false;
+    }
+    memcpy(r->buf + (size_t)(head & r->mask) * r->item_size, item, r->item_size);
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    wake(&r->consumer_wait);
+    return true;
+}
+
+// ===== Consumer side =====
+bool spsc_ring_try_receive(spsc_ring_t* r, void* item) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    if (tail == r->cached_head) {
+        r->cached_head = atomic_load_explicit(&r->head, memory_order_acquire);
+        if (tail == r->cached_head) return false;
+    }
+    memcpy(item, r->buf + (size_t)(tail & r->mask) * r->item_size, r->item_size);
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    wake(&r->producer_wait);
+    return true;
+}
+
+// ===== Blocking fallback =====
+// ประกาศตัวใน slot -> ลองอีกครั้ง (กันพลาด wake ที่เกิดระหว่างนั้น) -> รอ notification
+typedef bool (*try_fn_t)(spsc_ring_t*, void*);
+
+static BaseType_t wait_for(spsc_ring_t* r, _Atomic(TaskHandle_t)* slot, try_fn_t try_op,
+                           void* item, TickType_t wait, uint32_t* wait_count) {
+    if (try_op(r, item)) return pdPASS;
+    if (wait == 0) return pdFAIL;
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TickType_t start = xTaskGetTickCount();
+    while (1) {
+        atomic_store_explicit(slot, self, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (try_op(r, item)) {
+            atomic_store_explicit(slot, NULL, memory_order_relaxed);
+            return pdPASS;
+        }
+
+        TickType_t remaining = portMAX_DELAY;
+        if (wait != portMAX_DELAY) {
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= wait) break;
+            remaining = wait - elapsed;
+        }
+        (*wait_count)++;
+        ulTaskNotifyTake(pdTRUE, remaining);     // ตื่นเร็ว/ตื่นเกินไม่เป็นไร วนเช็คใหม่
+    }
+    atomic_store_explicit(slot, NULL, memory_order_relaxed);
+    return try_op(r, item) ? pdPASS : pdFAIL;
+}
+
+static bool try_send_cb(spsc_ring_t* r, void* item) { return spsc_ring_try_send(r, item); }
+
+BaseType_t spsc_ring_send(spsc_ring_t* r, const void* item, TickType_t wait) {
+    return wait_for(r, &r->producer_wait, try_send_cb, (void*)item, wait, &r->full_waits);
+}
+
+BaseType_t spsc_ring_receive(spsc_ring_t* r, void* item, TickType_t wait) {
+    return wait_for(r, &r->consumer_wait, spsc_ring_try_receive, item, wait, &r->empty_waits);
+}
+
+uint32_t spsc_ring_count(const spsc_ring_t* r) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    return head - tail;
+}
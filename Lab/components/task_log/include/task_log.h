@@ -0,0 +1,37 @@
+#ifndef TASK_LOG_H
+#define TASK_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+
+#include "freertos/FreeRTOS.h"
+
+// Log buffer ต่อ task แบบ lock-free แทน printf ที่ครอบ mutex
+//   task ที่เรียก task_log_printf ครั้งแรกจะได้ spsc_ring ของตัวเอง (ผู้เขียน 1 = task นั้น, ผู้อ่าน 1 = drain task)
+//   เขียนไม่ block เลย: ring เต็ม -> ทิ้งบรรทัดนั้นแล้วนับ dropped
+//   drain task ตัวเดียวเป็นคนเขียนลง console (stdout) วนทุก ring
+// บรรทัดยาวเกิน TASK_LOG_LINE_MAX จะถูกตัด; ลำดับข้าม task ไม่รับประกัน (ภายใน task เดียวกันเรียงเสมอ)
+// task ที่จะ vTaskDelete ตัวเองต้องเรียก task_log_unregister ก่อน: drain เขียนที่ค้างให้หมดแล้วคืน slot
+
+#define TASK_LOG_MAX_TASKS   16
+#define TASK_LOG_LINE_MAX    128
+#define TASK_LOG_IDLE_MS     20         // drain หลับนานสุดเมื่อไม่มีอะไรให้เขียน
+
+typedef struct {
+    uint32_t written;
+    uint32_t dropped;                   // ring เต็ม หรือ task เกิน TASK_LOG_MAX_TASKS
+    uint32_t truncated;
+    uint32_t tasks;                     // slot ที่ใช้อยู่ตอนนี้
+} task_log_stats_t;
+
+// lines_per_task ปัดขึ้นเป็น 2^n; สร้าง drain task ที่ priority ที่ให้
+bool task_log_init(uint32_t lines_per_task, UBaseType_t drain_prio);
+
+void task_log_printf(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+void task_log_unregister(void);        // ห้ามเขียน log จาก task นี้อีกหลังเรียก
+void task_log_vprintf(const char* fmt, va_list args);
+
+void task_log_get_stats(task_log_stats_t* out);
+
+#endif
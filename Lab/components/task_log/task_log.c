@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/task.h"
+#include "spsc_ring.h"
+#include "task_log.h"
+
+typedef struct {
+    _Atomic(TaskHandle_t) owner;
+    _Atomic bool          ready;        // ring สร้างเสร็จแล้ว drain อ่านได้
+    _Atomic bool          closing;      // เจ้าของเลิกเขียนแล้ว: drain ระบายที่เหลือแล้วคืน slot
+    spsc_ring_t           ring;
+} log_slot_t;
+
+static log_slot_t       slots[TASK_LOG_MAX_TASKS];
+static uint32_t         ring_lines;
+static TaskHandle_t     drain_task;
+static _Atomic uint32_t written;
+static _Atomic uint32_t dropped;
+static _Atomic uint32_t truncated;
+static _Atomic uint32_t tasks;
+
+// ===== Slot ของ task ปัจจุบัน =====
+static log_slot_t* slot_for_self(void) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < TASK_LOG_MAX_TASKS; i++) {
+        TaskHandle_t owner = atomic_load_explicit(&slots[i].owner, memory_order_acquire);
+        if (owner == self) {
+            // slot ที่กำลังคืน = ของ task เก่าที่ handle ซ้ำกับเรา -> หาช่องใหม่
+            if (atomic_load_explicit(&slots[i].closing, memory_order_acquire)) continue;
+            return atomic_load_explicit(&slots[i].ready, memory_order_acquire) ? &slots[i] : NULL;
+        }
+        if (owner == NULL) {
+            TaskHandle_t expected = NULL;
+            if (!atomic_compare_exchange_strong(&slots[i].owner, &expected, self)) continue;
+            if (!spsc_ring_create(&slots[i].ring, TASK_LOG_LINE_MAX, ring_lines)) {
+                // คืน slot ไม่งั้นค้างเป็นของเราแบบไม่ ready -> ทุกบรรทัดต่อจากนี้ถูกทิ้ง
+                atomic_store_explicit(&slots[i].owner, NULL, memory_order_release);
+                return NULL;
+            }
+            atomic_store_explicit(&slots[i].ready, true, memory_order_release);
+            atomic_fetch_add_explicit(&tasks, 1, memory_order_relaxed);
+            return &slots[i];
+        }
+    }
+    return NULL;                        // table เต็ม
+}
+
+void task_log_vprintf(const char* fmt, va_list args) {
+    char line[TASK_LOG_LINE_MAX];
+    log_slot_t* slot = slot_for_self();
+    if (!slot) {
+        atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    int n = vsnprintf(line, sizeof(line), fmt, args);
+    if (n >= (int)sizeof(line)) atomic_fetch_add_explicit(&truncated, 1, memory_order_relaxed);
+
+    if (!spsc_ring_try_send(&slot->ring, line)) {
+        atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+        return;
+    }
+    // เกินครึ่ง ring -> ปลุก drain ก่อนถึงรอบ idle
+    if (spsc_ring_count(&slot->ring) >= slot->ring.capacity / 2 && drain_task) xTaskNotifyGive(drain_task);
+}
+
+void task_log_unregister(void) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < TASK_LOG_MAX_TASKS; i++) {
+        if (atomic_load_explicit(&slots[i].owner, memory_order_acquire) != self) continue;
+        if (!atomic_load_explicit(&slots[i].ready, memory_order_acquire)) continue;
+        if (atomic_load_explicit(&slots[i].closing, memory_order_relaxed)) continue;
+        // release: บรรทัดสุดท้ายที่เขียนต้องเห็นก่อน drain เห็น closing
+        atomic_store_explicit(&slots[i].closing, true, memory_order_release);
+        if (drain_task) xTaskNotifyGive(drain_task);
+        return;
+    }
+}
+
+void task_log_printf(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    task_log_vprintf(fmt, args);
+    va_end(args);
+}
+
+// ===== Drain =====
+// drain เป็นผู้อ่านคนเดียวของทุก ring -> เป็นคนทำลาย ring ตอนคืน slot ด้วย (ไม่มีใครอ่านค้างอยู่)
+static void release_slot(log_slot_t* slot) {
+    atomic_store_explicit(&slot->ready, false, memory_order_relaxed);
+    spsc_ring_destroy(&slot->ring);
+    atomic_store_explicit(&slot->closing, false, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&tasks, 1, memory_order_relaxed);
+    atomic_store_explicit(&slot->owner, NULL, memory_order_release);   // ว่างให้ task ใหม่ได้
+}
+
+static void drain(void* pv) {
+    static char line[TASK_LOG_LINE_MAX];
+    while (1) {
+        uint32_t n = 0;
+        for (int i = 0; i < TASK_LOG_MAX_TASKS; i++) {
+            if (!atomic_load_explicit(&slots[i].ready, memory_order_acquire)) continue;
+            // อ่าน closing ก่อน drain: ถ้าเห็น true แปลว่าบรรทัดสุดท้ายอยู่ใน ring แล้ว
+            bool closing = atomic_load_explicit(&slots[i].closing, memory_order_acquire);
+            while (spsc_ring_try_receive(&slots[i].ring, line)) {
+                line[TASK_LOG_LINE_MAX - 1] = '\0';
+                fputs(line, stdout);
+                n++;
+            }
+            if (closing) release_slot(&slots[i]);
+        }
+        if (n) {
+            atomic_fetch_add_explicit(&written, n, memory_order_relaxed);
+            fflush(stdout);
+        } else {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TASK_LOG_IDLE_MS));
+        }
+    }
+}
+
+bool task_log_init(uint32_t lines_per_task, UBaseType_t drain_prio) {
+    if (drain_task) return true;
+    ring_lines = lines_per_task ? lines_per_task : 1;
+    return xTaskCreate(drain, "task_log", 3072, NULL, drain_prio, &drain_task) == pdPASS;
+}
+
+void task_log_get_stats(task_log_stats_t* out) {
+    out->written   = atomic_load_explicit(&written, memory_order_relaxed);
+    out->dropped   = atomic_load_explicit(&dropped, memory_order_relaxed);
+    out->truncated = atomic_load_explicit(&truncated, memory_order_relaxed);
+    out->tasks     = atomic_load_explicit(&tasks, memory_order_relaxed);
+}
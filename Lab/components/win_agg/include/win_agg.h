@@ -0,0 +1,60 @@
+#ifndef WIN_AGG_H
+#define WIN_AGG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// รวมค่าตัวอย่าง (เช่น อุณหภูมิ) เป็นหน้าต่างก่อนส่งต่อ -> ปลายทางเห็นแค่สรุปกับจุดข้ามเกณฑ์
+//   tumbling: หน้าต่างยาว window_ms ไม่ซ้อนกัน ปิดแล้วได้ min/max/mean/count
+//   sliding : panes หน้าต่าง tumbling ล่าสุดรวมกัน (ยาว panes*window_ms, เลื่อนทีละ window_ms)
+//             เก็บแค่ผลรวมต่อ pane ไม่เก็บตัวอย่างดิบ -> O(panes) ตอนอ่าน, O(1) ตอน add
+//   threshold: ข้ามขึ้นเมื่อ > hi, ข้ามลงเมื่อ < lo (hysteresis กันเด้งไปมารอบเกณฑ์)
+// หน้าต่างปิดตอน add ตัวอย่างแรกที่เลยเวลา (ไม่มี timer) -> สรุปช้าได้ไม่เกินช่วงห่างของตัวอย่าง
+// ไม่ thread-safe: ใช้จาก task เดียว (ฝั่งผู้ผลิต)
+
+#define WIN_AGG_MAX_PANES  8
+
+// เหตุการณ์ที่ win_agg_add คืน (OR กันได้)
+#define WIN_AGG_WINDOW     (1u << 0)    // หน้าต่าง tumbling เพิ่งปิด
+#define WIN_AGG_RISE       (1u << 1)    // ข้ามขึ้นเหนือ hi
+#define WIN_AGG_FALL       (1u << 2)    // กลับลงต่ำกว่า lo
+
+typedef struct {
+    float    min;
+    float    max;
+    float    sum;
+    uint32_t count;
+} win_acc_t;
+
+typedef struct {
+    float    min;
+    float    max;
+    float    mean;
+    uint32_t count;
+} win_stat_t;
+
+typedef struct {
+    int64_t   window_us;
+    uint32_t  panes;
+    int64_t   start_us;                 // เริ่มหน้าต่างปัจจุบัน (0 = ยังไม่มีตัวอย่าง)
+    win_acc_t cur;
+    win_acc_t last;                     // หน้าต่างที่ปิดล่าสุด (ring อาจมี pane ว่างต่อท้าย)
+    win_acc_t ring[WIN_AGG_MAX_PANES];  // หน้าต่างที่ปิดแล้ว + pane ว่างของช่วงที่ไม่มีตัวอย่าง
+    uint32_t  head;                     // ช่องที่จะเขียนถัดไป
+    uint32_t  filled;
+    float     hi;
+    float     lo;
+    bool      above;
+    // stats
+    uint32_t  samples;
+    uint32_t  windows;
+    uint32_t  crossings;
+} win_agg_t;
+
+void     win_agg_init(win_agg_t* w, uint32_t window_ms, uint32_t panes, float hi, float lo);
+uint32_t win_agg_add(win_agg_t* w, float value, int64_t now_us);    // คืน WIN_AGG_*
+void     win_agg_tumbling(const win_agg_t* w, win_stat_t* out);     // หน้าต่างที่ปิดล่าสุด
+void     win_agg_sliding(const win_agg_t* w, win_stat_t* out);      // panes หน้าต่างล่าสุด
+bool     win_agg_above(const win_agg_t* w);
+
+#endif
@@ -0,0 +1,90 @@
+#include <string.h>
+#include "win_agg.h"
+
+static inline void acc_reset(win_acc_t* a) {
+    memset(a, 0, sizeof(*a));
+}
+
+static inline void acc_add(win_acc_t* a, float v) {
+    if (a->count == 0 || v < a->min) a->min = v;
+    if (a->count == 0 || v > a->max) a->max = v;
+    a->sum += v;
+    a->count++;
+}
+
+static inline void acc_merge(win_acc_t* a, const win_acc_t* b) {
+    if (b->count == 0) return;
+    if (a->count == 0 || b->min < a->min) a->min = b->min;
+    if (a->count == 0 || b->max > a->max) a->max = b->max;
+    a->sum += b->sum;
+    a->count += b->count;
+}
+
+static void to_stat(const win_acc_t* a, win_stat_t* out) {
+    out->min = a->min;
+    out->max = a->max;
+    out->mean = a->count ? a->sum / (float)a->count : 0.0f;
+    out->count = a->count;
+}
+
+void win_agg_init(win_agg_t* w, uint32_t window_ms, uint32_t panes, float hi, float lo) {
+    memset(w, 0, sizeof(*w));
+    w->window_us = (int64_t)window_ms * 1000;
+    w->panes = panes == 0 ? 1 : (panes > WIN_AGG_MAX_PANES ? WIN_AGG_MAX_PANES : panes);
+    w->hi = hi;
+    w->lo = lo;
+}
+
+static void push_pane(win_agg_t* w, const win_acc_t* a) {
+    w->ring[w->head] = *a;
+    w->head = (w->head + 1) % w->panes;
+    if (w->filled < w->panes) w->filled++;
+}
+
+uint32_t win_agg_add(win_agg_t* w, float value, int64_t now_us) {
+    uint32_t ev = 0;
+
+    if (w->start_us == 0) {
+        w->start_us = now_us;
+    } else if (now_us - w->start_us >= w->window_us) {
+        w->last = w->cur;
+        push_pane(w, &w->cur);
+        acc_reset(&w->cur);
+        // ช่วงที่ไม่มีตัวอย่างเลยนับเป็น pane ว่าง (ไม่เกินจำนวน pane ที่เก็บ)
+        int64_t skipped = (now_us - w->start_us) / w->window_us - 1;
+        win_acc_t empty = {0};
+        for (int64_t i = 0; i < skipped && i < (int64_t)w->panes; i++) push_pane(w, &empty);
+        w->start_us += (skipped + 1) * w->window_us;
+        w->windows++;
+        ev |= WIN_AGG_WINDOW;
+    }
+    acc_add(&w->cur, value);
+    w->samples++;
+
+    if (!w->above && value > w->hi) {
+        w->above = true;
+        w->crossings++;
+        ev |= WIN_AGG_RISE;
+    } else if (w->above && value < w->lo) {
+        w->above = false;
+        w->crossings++;
+        ev |= WIN_AGG_FALL;
+    }
+    return ev;
+}
+
+// คืนหน้าต่างที่เพิ่งปิด ไม่ใช่ช่องล่าสุดใน ring: ถ้าตัวอย่างเว้นช่วงเกิน 1 หน้าต่าง
+// ช่องล่าสุดคือ pane ว่างที่เติมให้ sliding (count = 0)
+void win_agg_tumbling(const win_agg_t* w, win_stat_t* out) {
+    to_stat(&w->last, out);
+}
+
+void win_agg_sliding(const win_agg_t* w, win_stat_t* out) {
+    win_acc_t a = {0};
+    for (uint32_t i = 0; i < w->filled; i++) acc_merge(&a, &w->ring[i]);
+    to_stat(&a, out);
+}
+
+bool win_agg_above(const win_agg_t* w) {
+    return w->above;
+}
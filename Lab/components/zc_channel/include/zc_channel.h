@@ -0,0 +1,54 @@
+#ifndef ZC_CHANNEL_H
+#define ZC_CHANNEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// Zero-copy channel: คิวส่งแค่ pointer ไปยังบัฟเฟอร์จากพูล (ไม่ copy payload)
+// กติกาความเป็นเจ้าของ:
+//   zc_buf_alloc()       -> ผู้เรียกเป็นเจ้าของ
+//   zc_channel_send()    -> ส่งต่อความเป็นเจ้าของ (*pbuf ถูกตั้งเป็น NULL) ห้ามแตะบัฟเฟอร์อีก
+//   zc_channel_receive() -> ผู้รับเป็นเจ้าของ และต้อง zc_buf_free() เอง
+// แต่ละบัฟเฟอร์มี header เล็ก ๆ เก็บสถานะ เพื่อจับ double free / free ของที่ยังอยู่ในคิว
+
+typedef struct {
+    uint8_t*      mem;
+    size_t        buf_size;         // payload ต่อบัฟเฟอร์
+    size_t        stride;           // header + payload (align 8)
+    uint16_t      buf_count;
+    QueueHandle_t free_q;           // free list (เก็บ pointer)
+    // stats
+    uint32_t      alloc_fail;
+    uint32_t      bad_free;
+    uint16_t      peak_in_use;      // อัปเดตตอน alloc (ค่าประมาณเมื่อหลาย task จองพร้อมกัน)
+} zc_pool_t;
+
+typedef struct {
+    QueueHandle_t q;                // ใส่ใน queue set ได้ตรง ๆ
+    zc_pool_t*    pool;
+    // stats
+    uint32_t      sent;
+    uint32_t      received;
+    uint32_t      send_fail;
+} zc_channel_t;
+
+bool       zc_pool_create(zc_pool_t* p, size_t buf_size, uint16_t buf_count, uint32_t caps);
+void       zc_pool_destroy(zc_pool_t* p);
+void*      zc_buf_alloc(zc_pool_t* p, TickType_t wait);
+void       zc_buf_free(zc_pool_t* p, void* buf);
+uint16_t   zc_pool_in_use(const zc_pool_t* p);
+
+bool       zc_channel_create(zc_channel_t* ch, zc_pool_t* pool, UBaseType_t depth);
+void       zc_channel_destroy(zc_channel_t* ch);
+BaseType_t zc_channel_send(zc_channel_t* ch, void** pbuf, TickType_t wait);
+void*      zc_channel_receive(zc_channel_t* ch, TickType_t wait);
+
+// bytes ที่ต้อง copy ต่อข้อความ: pointer เข้า/ออก channel + เข้า/ออก free list
+// เทียบกับ 2 * sizeof(payload) ของคิวแบบ by-value
+static inline size_t zc_channel_bytes_copied_per_msg(void) { return 4 * sizeof(void*); }
+
+#endif
@@ -0,0 +1,152 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#ifndef CONFIG_IDF_TARGET_LINUX
+#include "esp_heap_caps.h"
+#endif
+#include "zc_channel.h"
+
+static const char *TAG = "ZC_CHANNEL";
+
+// ===== Buffer header =====
+typedef struct {
+    uint16_t magic;
+    uint8_t  state;
+    uint8_t  reserved;
+    uint32_t index;
+} zc_hdr_t;
+
+#define ZC_MAGIC      0x2C0Cu
+#define ZC_ALIGN      8
+
+enum { ZC_FREE = 0, ZC_OWNED = 1, ZC_IN_FLIGHT = 2 };
+
+static inline zc_hdr_t* hdr_of(void* buf) { return (zc_hdr_t*)((uint8_t*)buf - sizeof(zc_hdr_t)); }
+
+// ตรวจว่า pointer ชี้ payload ของบัฟเฟอร์ในพูลนี้จริง
+static bool pool_owns(const zc_pool_t* p, const void* buf) {
+    const uint8_t* b = buf;
+    if (b < p->mem + sizeof(zc_hdr_t) || b >= p->mem + p->stride * p->buf_count) return false;
+    return ((size_t)(b - p->mem) - sizeof(zc_hdr_t)) % p->stride == 0;
+}
+
+// ===== Pool =====
+bool zc_pool_create(zc_pool_t* p, size_t buf_size, uint16_t buf_count, uint32_t caps) {
+    memset(p, 0, sizeof(*p));
+    if (buf_size == 0 || buf_count == 0) return false;
+    p->buf_size = buf_size;
+    p->buf_count = buf_count;
+    p->stride = (sizeof(zc_hdr_t) + buf_size + ZC_ALIGN - 1) & ~(size_t)(ZC_ALIGN - 1);
+#ifdef CONFIG_IDF_TARGET_LINUX
+    (void)caps;
+    p->mem = malloc(p->stride * buf_count);
+#else
+    p->mem = heap_caps_malloc(p->stride * buf_count, caps);
+#endif
+    p->free_q = xQueueCreate(buf_count, sizeof(void*));
+    if (!p->mem || !p->free_q) {
+        zc_pool_destroy(p);
+        return false;
+    }
+    for (uint16_t i = 0; i < buf_count; i++) {
+        zc_hdr_t* h = (zc_hdr_t*)(p->mem + (size_t)i * p->stride);
+        h->magic = ZC_MAGIC;
+        h->state = ZC_FREE;
+        h->index = i;
+        void* buf = (uint8_t*)h + sizeof(zc_hdr_t);
+        xQueueSend(p->free_q, &buf, 0);
+    }
+    return true;
+}
+
+void zc_pool_destroy(zc_pool_t* p) {
+    if (p->free_q) vQueueDelete(p->free_q);
+#ifdef CONFIG_IDF_TARGET_LINUX
+    free(p->mem);
+#else
+    heap_caps_free(p->mem);
+#endif
+    memset(p, 0, sizeof(*p));
+}
+
+void* zc_buf_alloc(zc_pool_t* p, TickType_t wait) {
+    void* buf = NULL;
+    if (xQueueReceive(p->free_q, &buf, wait) != pdPASS) {
+        p->alloc_fail++;
+        return NULL;
+    }
+    hdr_of(buf)->state = ZC_OWNED;
+    uint16_t used = zc_pool_in_use(p);
+    if (used > p->peak_in_use) p->peak_in_use = used;
+    return buf;
+}
+
+void zc_buf_free(zc_pool_t* p, void* buf) {
+    if (!buf) return;
+    if (!pool_owns(p, buf)) {
+        p->bad_free++;
+        ESP_LOGE(TAG, "free of foreign pointer %p", buf);
+        return;
+    }
+    zc_hdr_t* h = hdr_of(buf);
+    if (h->magic != ZC_MAGIC || h->state != ZC_OWNED) {
+        p->bad_free++;
+        ESP_LOGE(TAG, "bad free of buffer %lu (state %u)", (unsigned long)h->index, h->state);
+        return;
+    }
+    h->state = ZC_FREE;
+    xQueueSend(p->free_q, &buf, 0);     // free_q จุได้ทุกบัฟเฟอร์ ไม่มีทางเต็ม
+}
+
+uint16_t zc_pool_in_use(const zc_pool_t* p) {
+    return (uint16_t)(p->buf_count - uxQueueMessagesWaiting(p->free_q));
+}
+
+// ===== Channel =====
+bool zc_channel_create(zc_channel_t* ch, zc_pool_t* pool, UBaseType_t depth) {
+    memset(ch, 0, sizeof(*ch));
+    ch->pool = pool;
+    ch->q = xQueueCreate(depth, sizeof(void*));
+    return ch->q != NULL;
+}
+
+void zc_channel_destroy(zc_channel_t* ch) {
+    if (ch->q) {
+        // คืนบัฟเฟอร์ที่ค้างในคิวกลับพูล
+        void* buf;
+        while (xQueueReceive(ch->q, &buf, 0) == pdPASS) {
+            hdr_of(buf)->state = ZC_OWNED;
+            zc_buf_free(ch->pool, buf);
+        }
+        vQueueDelete(ch->q);
+    }
+    memset(ch, 0, sizeof(*ch));
+}
+
+BaseType_t zc_channel_send(zc_channel_t* ch, void** pbuf, TickType_t wait) {
+    void* buf = *pbuf;
+    if (!buf) return pdFAIL;
+    zc_hdr_t* h = hdr_of(buf);
+    if (h->state != ZC_OWNED) {
+        ESP_LOGE(TAG, "send of buffer not owned by caller (state %u)", h->state);
+        return pdFAIL;
+    }
+    h->state = ZC_IN_FLIGHT;
+    if (xQueueSend(ch->q, &buf, wait) != pdPASS) {
+        h->state = ZC_OWNED;            // ส่งไม่สำเร็จ ผู้เรียกยังเป็นเจ้าของ
+        ch->send_fail++;
+        return pdFAIL;
+    }
+    *pbuf = NULL;
+    ch->sent++;
+    return pdPASS;
+}
+
+void* zc_channel_receive(zc_channel_t* ch, TickType_t wait) {
+    void* buf = NULL;
+    if (xQueueReceive(ch->q, &buf, wait) != pdPASS) return NULL;
+    hdr_of(buf)->state = ZC_OWNED;
+    ch->received++;
+    return buf;
+}
@@ -1,14 +1,17 @@
 // main.c — Lab 2: Time-Sharing (Single file)
 // เลือกส่วนที่จะรัน: 1 = Part 1, 2 = Part 2 (Variable time slices), 3 = Part 3 (Problem demo)
+//                  4 = Part 4 (Pipeline: 4 stage รันพร้อมกันเทียบกับรันทีละ stage บน task เดียว)
 #define RUN_PART 2
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "pipeline.h"
 
 #define LED1_PIN GPIO_NUM_2
 #define LED2_PIN GPIO_NUM_4
@@ -35,12 +38,13 @@ typedef enum {
 static uint32_t task_counter = 0;
 static uint64_t context_switch_time = 0;   // รวมเวลาที่ใช้ทำงานใน manual_scheduler()
 static uint32_t context_switches = 0;
+static bool     stage_log = true;          // Part 4 ปิด log ต่องาน (ไม่งั้น UART เป็นคอขวดแทนงานจริง)
 
 /* ---------------- Simulated workloads ---------------- */
 static void simulate_sensor_task(void)
 {
     static uint32_t sensor_count = 0;
-    ESP_LOGI(TAG, "Sensor Task %u", (unsigned)sensor_count++);
+    if (stage_log) ESP_LOGI(TAG, "Sensor Task %u", (unsigned)sensor_count++);
 
     gpio_set_level(LED1_PIN, 1);
     for (int i = 0; i < 10000; i++) { volatile int dummy = i; (void)dummy; }
@@ -50,7 +54,7 @@ static void simulate_sensor_task(void)
 static void simulate_processing_task(void)
 {
     static uint32_t process_count = 0;
-    ESP_LOGI(TAG, "Processing Task %u", (unsigned)process_count++);
+    if (stage_log) ESP_LOGI(TAG, "Processing Task %u", (unsigned)process_count++);
 
     gpio_set_level(LED2_PIN, 1);
     for (int i = 0; i < 100000; i++) { volatile int dummy = i * i; (void)dummy; }
@@ -60,7 +64,7 @@ static void simulate_processing_task(void)
 static void simulate_actuator_task(void)
 {
     static uint32_t actuator_count = 0;
-    ESP_LOGI(TAG, "Actuator Task %u", (unsigned)actuator_count++);
+    if (stage_log) ESP_LOGI(TAG, "Actuator Task %u", (unsigned)actuator_count++);
 
     gpio_set_level(LED3_PIN, 1);
     for (int i = 0; i < 50000; i++) { volatile int dummy = i + 100; (void)dummy; }
@@ -70,7 +74,7 @@ static void simulate_actuator_task(void)
 static void simulate_display_task(void)
 {
     static uint32_t display_count = 0;
-    ESP_LOGI(TAG, "Display Task %u", (unsigned)display_count++);
+    if (stage_log) ESP_LOGI(TAG, "Display Task %u", (unsigned)display_count++);
 
     gpio_set_level(LED4_PIN, 1);
     for (int i = 0; i < 20000; i++) { volatile int dummy = i / 2; (void)dummy; }
@@ -211,6 +215,72 @@ static void demonstrate_problems(void)
     ESP_LOGI(TAG, "=== End Problem Demonstrations ===\n");
 }
 
+/* ==============================
+ * Part 4: Pipeline vs Serial
+ * ============================== */
+// 1 item = ข้อมูล 1 ชุดที่ต้องผ่าน sensor -> processing -> actuator -> display
+// serial  : เรียก 4 stage ต่อกันทีละ item บน task เดียว (งานเดียวกับ Part 1/2 แต่ไม่มี overhead
+//           จำลองของ manual_scheduler 2x1000 รอบ -> เทียบเฉพาะงานจริงกับ pipeline ที่ไม่มี overhead นั้น)
+// pipeline: แต่ละ stage เป็น task ของตัวเอง ต่อกันด้วยคิวสั้น ๆ ทำงานซ้อนกันได้ทั้งสอง core
+//           processing หนักสุด (100000 รอบ) จึงให้ 2 worker
+#define PIPELINE_ITEMS  200
+#define PIPELINE_DEPTH  4
+#define PIPELINE_PRIO   5
+
+typedef struct {
+    uint32_t seq;
+} frame_t;
+
+static void stage_sensor(void *item, void *arg)     { simulate_sensor_task(); }
+static void stage_processing(void *item, void *arg) { simulate_processing_task(); }
+static void stage_actuator(void *item, void *arg)   { simulate_actuator_task(); }
+static void stage_display(void *item, void *arg)    { simulate_display_task(); }
+
+static const pipeline_stage_cfg_t PIPELINE_STAGES[TASK_COUNT] = {
+    { "sensor",     stage_sensor,     NULL, 1, 0,              PIPELINE_PRIO, 3072 },
+    { "processing", stage_processing, NULL, 2, tskNO_AFFINITY, PIPELINE_PRIO, 3072 },
+    { "actuator",   stage_actuator,   NULL, 1, 1,              PIPELINE_PRIO, 3072 },
+    { "display",    stage_display,    NULL, 1, 1,              PIPELINE_PRIO, 3072 },
+};
+
+static void run_part4_pipeline(void)
+{
+    static pipeline_t pl;
+    ESP_LOGI(TAG, "=== Pipeline vs Serial (%d items) ===", PIPELINE_ITEMS);
+    stage_log = false;
+
+    // serial: นับเฉพาะเวลาทำ 4 stage (เว้น 1 tick ต่อ item กัน watchdog ไม่นับรวม)
+    uint64_t serial_us = 0;
+    for (uint32_t i = 0; i < PIPELINE_ITEMS; i++) {
+        frame_t f = { .seq = i };
+        uint64_t t = esp_timer_get_time();
+        for (int s = 0; s < TASK_COUNT; s++) PIPELINE_STAGES[s].fn(&f, PIPELINE_STAGES[s].arg);
+        serial_us += esp_timer_get_time() - t;
+        vTaskDelay(1);
+    }
+    float serial_rate = serial_us ? PIPELINE_ITEMS * 1e6f / (float)serial_us : 0.0f;
+
+    if (!pipeline_create(&pl, PIPELINE_STAGES, TASK_COUNT, sizeof(frame_t), PIPELINE_DEPTH)) {
+        ESP_LOGE(TAG, "Pipeline create failed");
+        return;
+    }
+    uint64_t t0 = esp_timer_get_time();
+    for (uint32_t i = 0; i < PIPELINE_ITEMS; i++) {
+        frame_t f = { .seq = i };
+        pipeline_submit(&pl, &f, portMAX_DELAY);
+    }
+    pipeline_drain(&pl, portMAX_DELAY);
+    uint64_t pipe_us = esp_timer_get_time() - t0;
+    float pipe_rate = pipe_us ? PIPELINE_ITEMS * 1e6f / (float)pipe_us : 0.0f;
+
+    pipeline_log(&pl, TAG, pipe_us / 1e6f);
+    ESP_LOGI(TAG, "Serial (1 task):     %.1f items/s (%llu us)",
+             serial_rate, (unsigned long long)serial_us);
+    ESP_LOGI(TAG, "Pipeline (4 stages): %.1f items/s (%llu us) -> %.2fx",
+             pipe_rate, (unsigned long long)pipe_us, serial_rate > 0 ? pipe_rate / serial_rate : 0.0f);
+    stage_log = true;
+}
+
 /* ==============================
  * app_main: เลือก part ที่จะรัน
  * ============================== */
@@ -242,7 +312,11 @@ void app_main(void)
     demonstrate_problems();
     while (1) { vTaskDelay(pdMS_TO_TICKS(1000)); }
 
+#elif RUN_PART == 4
+    run_part4_pipeline();
+    while (1) { vTaskDelay(pdMS_TO_TICKS(1000)); }
+
 #else
-#   error "Please set RUN_PART to 1, 2, or 3"
+#   error "Please set RUN_PART to 1, 2, 3, or 4"
 #endif
 }
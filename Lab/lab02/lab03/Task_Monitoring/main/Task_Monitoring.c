@@ -11,6 +11,7 @@
 #include "esp_heap_caps.h"      // esp_get_free_heap_size()
 #include "esp_rom_sys.h"        // esp_rom_printf(), esp_rom_delay_us
 #include "freertos/portmacro.h" // portDISABLE_INTERRUPTS()
+#include "scratch_arena.h"      // bump arena ต่อ task
 
 #define LED_OK GPIO_NUM_2       // Stack OK indicator
 #define LED_WARNING GPIO_NUM_4  // Stack warning indicator
@@ -21,6 +22,23 @@ static const char *TAG = "STACK_MONITOR";
 #define STACK_WARNING_THRESHOLD 512  // bytes
 #define STACK_CRITICAL_THRESHOLD 256 // bytes
 
+// ตัวแปรชั่วคราวของ heavy task (ประมาณ 2.3 KB ต่อรอบ)
+#define HEAVY_BUF_LEN   1024
+#define HEAVY_NUM_COUNT 200
+#define HEAVY_MSG_LEN   512
+
+// Scratch arena (1 = ตัวแปรชั่วคราวอยู่ใน arena ของ task, 0 = array บน stack แบบเดิม)
+#define USE_SCRATCH_ARENA   1
+#define HEAVY_SCRATCH_BYTES 2560         // ปรับตาม peak ที่ StackMonitor รายงาน
+#if USE_SCRATCH_ARENA
+#define HEAVY_TASK_STACK    2560         // stack เหลือแค่ control flow + ESP_LOG
+#else
+#define HEAVY_TASK_STACK    4096
+#endif
+
+static scratch_arena_t heavy_scratch;
+static scratch_arena_t optimized_scratch;
+
 // Task handles for monitoring
 TaskHandle_t light_task_handle = NULL;
 TaskHandle_t medium_task_handle = NULL;
@@ -88,6 +106,10 @@ void stack_monitor_task(void *pvParameters)
         ESP_LOGI(TAG, "Free heap: %u bytes", (unsigned)esp_get_free_heap_size());
         ESP_LOGI(TAG, "Min  heap: %u bytes", (unsigned)esp_get_minimum_free_heap_size());
 
+        // peak ของ scratch arena ต่อ task ใช้ปรับ HEAVY_SCRATCH_BYTES
+        if (heavy_scratch.base) scratch_arena_log(&heavy_scratch, TAG);
+        if (optimized_scratch.base) scratch_arena_log(&optimized_scratch, TAG);
+
         vTaskDelay(pdMS_TO_TICKS(3000)); // Monitor every 3 seconds
     }
 }
@@ -140,28 +162,49 @@ void heavy_stack_task(void *pvParameters)
     ESP_LOGI(TAG, "Heavy Stack Task started (high usage - watch for overflow!)");
     int cycle = 0;
 
+#if USE_SCRATCH_ARENA
+    if (!scratch_arena_create(&heavy_scratch, HEAVY_SCRATCH_BYTES, MALLOC_CAP_8BIT, "HeavyTask")) {
+        esp_rom_printf("Failed to allocate scratch arena\n");
+        vTaskDelete(NULL);
+        return;
+    }
+#endif
+
     while (1) {
         cycle++;
 
+#if USE_SCRATCH_ARENA
+        // คืนของรอบก่อนทั้งหมดทีเดียว แล้วจองใหม่ = เลื่อน pointer
+        scratch_arena_reset(&heavy_scratch);
+        char *large_buffer   = scratch_alloc(&heavy_scratch, HEAVY_BUF_LEN);
+        int  *large_numbers  = scratch_alloc(&heavy_scratch, HEAVY_NUM_COUNT * sizeof(int));
+        char *another_buffer = scratch_alloc(&heavy_scratch, HEAVY_MSG_LEN);
+        if (!large_buffer || !large_numbers || !another_buffer) {
+            vTaskDelay(pdMS_TO_TICKS(4000));
+            continue;
+        }
+        ESP_LOGW(TAG, "Heavy task cycle %d: Using scratch arena", cycle);
+#else
         // ใหญ่พอจะกดดัน stack
-        char large_buffer[1024];
-        int  large_numbers[200];
-        char another_buffer[512];
+        char large_buffer[HEAVY_BUF_LEN];
+        int  large_numbers[HEAVY_NUM_COUNT];
+        char another_buffer[HEAVY_MSG_LEN];
 
         ESP_LOGW(TAG, "Heavy task cycle %d: Using large stack arrays", cycle);
+#endif
 
-        memset(large_buffer, 'X', sizeof(large_buffer) - 1);
-        large_buffer[sizeof(large_buffer) - 1] = '\0';
+        memset(large_buffer, 'X', HEAVY_BUF_LEN - 1);
+        large_buffer[HEAVY_BUF_LEN - 1] = '\0';
 
-        for (int i = 0; i < 200; i++) {
+        for (int i = 0; i < HEAVY_NUM_COUNT; i++) {
             large_numbers[i] = i * cycle;
         }
 
-        snprintf(another_buffer, sizeof(another_buffer), "Cycle %d with large data processing", cycle);
+        snprintf(another_buffer, HEAVY_MSG_LEN, "Cycle %d with large data processing", cycle);
 
         ESP_LOGI(TAG, "Heavy task: %s", another_buffer);
         ESP_LOGI(TAG, "Large buffer length: %d", (int)strlen(large_buffer));
-        ESP_LOGI(TAG, "Last number: %d", large_numbers[199]);
+        ESP_LOGI(TAG, "Last number: %d", large_numbers[HEAVY_NUM_COUNT - 1]);
 
         UBaseType_t stack_remaining = uxTaskGetStackHighWaterMark(NULL);
         uint32_t stack_bytes = stack_remaining * sizeof(StackType_t);
@@ -208,21 +251,15 @@ void recursion_demo_task(void *pvParameters)
     }
 }
 
-// ---------------- Optimized heavy task (use heap) ----------------
+// ---------------- Optimized heavy task (use scratch arena) ----------------
 void optimized_heavy_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "Optimized Heavy Task started");
 
-    char *large_buffer   = (char *)malloc(1024);
-    int  *large_numbers  = (int  *)malloc(200 * sizeof(int));
-    char *another_buffer = (char *)malloc(512);
-
-    if (!large_buffer || !large_numbers || !another_buffer) {
+    // จอง heap ก้อนเดียวตอนเริ่ม แทน malloc 3 ก้อนที่ค้างไว้ตลอด
+    if (!scratch_arena_create(&optimized_scratch, HEAVY_SCRATCH_BYTES, MALLOC_CAP_8BIT, "HeavyTaskOpt")) {
         // ใช้ ROM printf แทน LOG เพื่อความปลอดภัย
         esp_rom_printf("Failed to allocate heap memory\n");
-        free(large_buffer);
-        free(large_numbers);
-        free(another_buffer);
         vTaskDelete(NULL);
         return;
     }
@@ -230,14 +267,23 @@ void optimized_heavy_task(void *pvParameters)
     int cycle = 0;
     while (1) {
         cycle++;
-        ESP_LOGI(TAG, "Optimized task cycle %d: Using heap instead of stack", cycle);
+        scratch_arena_reset(&optimized_scratch);
+        ESP_LOGI(TAG, "Optimized task cycle %d: Using scratch arena instead of stack", cycle);
+
+        char *large_buffer   = scratch_alloc(&optimized_scratch, HEAVY_BUF_LEN);
+        int  *large_numbers  = scratch_alloc(&optimized_scratch, HEAVY_NUM_COUNT * sizeof(int));
+        char *another_buffer = scratch_alloc(&optimized_scratch, HEAVY_MSG_LEN);
+        if (!large_buffer || !large_numbers || !another_buffer) {
+            vTaskDelay(pdMS_TO_TICKS(4000));
+            continue;
+        }
 
-        memset(large_buffer, 'Y', 1023);
-        large_buffer[1023] = '\0';
-        for (int i = 0; i < 200; i++) {
+        memset(large_buffer, 'Y', HEAVY_BUF_LEN - 1);
+        large_buffer[HEAVY_BUF_LEN - 1] = '\0';
+        for (int i = 0; i < HEAVY_NUM_COUNT; i++) {
             large_numbers[i] = i * cycle;
         }
-        snprintf(another_buffer, 512, "Optimized cycle %d", cycle);
+        snprintf(another_buffer, HEAVY_MSG_LEN, "Optimized cycle %d", cycle);
 
         UBaseType_t stack_remaining = uxTaskGetStackHighWaterMark(NULL);
         ESP_LOGI(TAG, "Optimized task stack: %lu bytes remaining",
@@ -247,9 +293,7 @@ void optimized_heavy_task(void *pvParameters)
     }
 
     // (จะไม่ถึงจุดนี้)
-    free(large_buffer);
-    free(large_numbers);
-    free(another_buffer);
+    scratch_arena_destroy(&optimized_scratch);
 }
 
 // ---------------- Stack overflow hook (no RTOS API inside) ----------------
@@ -297,8 +341,9 @@ void app_main(void)
     result = xTaskCreate(medium_stack_task, "MediumTask", 2048, NULL, 2, &medium_task_handle);
     if (result != pdPASS) ESP_LOGE(TAG, "Failed to create MediumTask");
 
-    // Heavy task - 4KB (เพิ่มเพื่อเลี่ยง crash ทันที แต่ยังเห็น WARNING/CRITICAL)
-    result = xTaskCreate(heavy_stack_task, "HeavyTask", 4096, NULL, 2, &heavy_task_handle);
+    // Heavy task - 4KB แบบ stack array (เพิ่มเพื่อเลี่ยง crash ทันที แต่ยังเห็น WARNING/CRITICAL)
+    //              2.5KB เมื่อใช้ scratch arena
+    result = xTaskCreate(heavy_stack_task, "HeavyTask", HEAVY_TASK_STACK, NULL, 2, &heavy_task_handle);
     if (result != pdPASS) ESP_LOGE(TAG, "Failed to create HeavyTask");
 
     // ถ้าต้องการสาธิตแบบ “ปลอดภัยสุด” ใช้เวอร์ชัน heap แทน (สลับคอมเมนต์สองบรรทัดนี้)
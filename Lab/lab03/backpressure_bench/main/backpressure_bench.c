@@ -0,0 +1,193 @@
+// main/backpressure_bench.c — timed drop เดิม vs credit-based backpressure ภายใต้ overload
+//
+// producer สร้างข้อความทุก OFFER_PERIOD_MS แต่ consumer ทำได้ชิ้นละ ITEM_COST_MS (ช้ากว่า 2 เท่า)
+// โหมดที่เทียบ:
+//   block100  = xQueueSend รอ 100 ms แล้ว drop (producer_task ใน producer_consumer.c เดิม)
+//   drop      = xQueueSend ไม่รอ แล้ว drop (network_task ใน queue_sets.c เดิม)
+//   credit/*  = flow_ctl: consumer คืน credit, producer ชะลอตัวเอง + shed policy 3 แบบ
+// วัด goodput, drop rate, เวลาที่ producer ติดอยู่ในการส่ง และอายุข้อความตอนถูกประมวลผล (p50/p99)
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "flow_ctl.h"
+#include "lat_hist.h"
+
+static const char *TAG = "BP_BENCH";
+
+// ===== Config =====
+#define QUEUE_DEPTH       8         // เท่า network queue
+#define RUN_MS            5000
+#define OFFER_PERIOD_MS   10        // ~100 msg/s
+#define ITEM_COST_MS      20        // ~50 msg/s -> overload 2x
+#define BACKOFF_STEP_MS   10
+#define BACKOFF_MAX_MS    160
+#define PRODUCER_PRIO     3
+#define CONSUMER_PRIO     4         // แบบ processor_task
+
+typedef enum { MODE_BLOCK100 = 0, MODE_DROP, MODE_CREDIT } mode_kind_t;
+
+typedef struct {
+    const char* name;
+    mode_kind_t kind;
+    flow_shed_t policy;
+} bench_mode_t;
+
+static const bench_mode_t MODES[] = {
+    { "block100",      MODE_BLOCK100, FLOW_SHED_DROP_NEWEST },
+    { "drop",          MODE_DROP,     FLOW_SHED_DROP_NEWEST },
+    { "credit/newest", MODE_CREDIT,   FLOW_SHED_DROP_NEWEST },
+    { "credit/oldest", MODE_CREDIT,   FLOW_SHED_DROP_OLDEST },
+    { "credit/coal",   MODE_CREDIT,   FLOW_SHED_COALESCE },
+};
+#define MODE_COUNT (sizeof(MODES) / sizeof(MODES[0]))
+
+// ขนาดเดียวกับ network_message_t ใน queue_sets.c (124 B)
+typedef struct {
+    int64_t t_created_us;
+    char    payload[116];
+} bench_msg_t;
+
+typedef struct {
+    const bench_mode_t* mode;
+    QueueHandle_t q;
+    flow_ctl_t    fc;
+    lat_hist_t    age;
+    volatile bool gen_done;
+    TaskHandle_t  notify;
+    uint32_t      generated;
+    uint32_t      shed;
+    uint32_t      delivered;
+    int64_t       send_stall_us;    // เวลาที่ producer อยู่ในการส่ง (รวม block)
+    int64_t       t_start_us;
+    int64_t       t_end_us;
+} bench_ctx_t;
+
+typedef struct {
+    uint32_t generated, delivered, shed;
+    double   goodput;
+    double   drop_pct;
+    double   stall_ms;
+    lat_hist_snapshot_t age;
+} bench_result_t;
+
+static bench_ctx_t ctx;
+
+static bool q_try_send(void* q, void* item)  { return xQueueSend((QueueHandle_t)q, item, 0) == pdPASS; }
+static bool q_try_evict(void* q, void* item) { return xQueueReceive((QueueHandle_t)q, item, 0) == pdPASS; }
+
+// ===== Producer =====
+static void producer_task(void *pv) {
+    bench_msg_t m, pending;
+    flow_producer_t flow;
+    memset(&m, 0, sizeof(m));
+    flow_producer_init(&flow, &ctx.fc, &pending, sizeof(pending), BACKOFF_STEP_MS, BACKOFF_MAX_MS);
+
+    int64_t end = ctx.t_start_us + (int64_t)RUN_MS * 1000;
+    while (esp_timer_get_time() < end) {
+        m.t_created_us = esp_timer_get_time();
+        ctx.generated++;
+
+        uint32_t extra_ms = 0;
+        int64_t t0 = esp_timer_get_time();
+        switch (ctx.mode->kind) {
+            case MODE_BLOCK100:
+                if (xQueueSend(ctx.q, &m, pdMS_TO_TICKS(100)) != pdPASS) ctx.shed++;
+                break;
+            case MODE_DROP:
+                if (xQueueSend(ctx.q, &m, 0) != pdPASS) ctx.shed++;
+                break;
+            case MODE_CREDIT: {
+                uint32_t shed0 = flow.shed;
+                flow_send(&flow, &m);
+                ctx.shed += flow.shed - shed0;
+                extra_ms = flow_backoff_ms(&flow);
+                break;
+            }
+        }
+        ctx.send_stall_us += esp_timer_get_time() - t0;
+        vTaskDelay(pdMS_TO_TICKS(OFFER_PERIOD_MS + extra_ms));
+    }
+    if (flow.has_pending) ctx.shed++;   // ชิ้นที่พักไว้ตอนหมดเวลา ถือว่าหาย
+    ctx.gen_done = true;                // consumer เห็นภายใน timeout 100 ms แล้วออก
+    vTaskDelete(NULL);
+}
+
+// ===== Consumer =====
+static void consumer_task(void *pv) {
+    bench_msg_t m;
+    while (1) {
+        if (xQueueReceive(ctx.q, &m, pdMS_TO_TICKS(100)) != pdPASS) {
+            if (ctx.gen_done) break;
+            continue;
+        }
+        lat_hist_record_since(&ctx.age, m.t_created_us);
+        vTaskDelay(pdMS_TO_TICKS(ITEM_COST_MS));
+        ctx.delivered++;
+        if (ctx.mode->kind == MODE_CREDIT) flow_grant(&ctx.fc, 1);
+    }
+    ctx.t_end_us = esp_timer_get_time();
+    xTaskNotifyGive(ctx.notify);
+    vTaskDelete(NULL);
+}
+
+// ===== Runner =====
+static bool run_one(const bench_mode_t* mode, bench_result_t* r) {
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.mode = mode;
+    ctx.notify = xTaskGetCurrentTaskHandle();
+    ctx.q = xQueueCreate(QUEUE_DEPTH, sizeof(bench_msg_t));
+    if (!ctx.q) return false;
+    flow_ctl_init(&ctx.fc, ctx.q, q_try_send, q_try_evict, QUEUE_DEPTH, mode->policy);
+    lat_hist_init(&ctx.age);
+
+    ctx.t_start_us = esp_timer_get_time();
+    xTaskCreate(consumer_task, "bp_cons", 3072, NULL, CONSUMER_PRIO, NULL);
+    xTaskCreate(producer_task, "bp_prod", 3072, NULL, PRODUCER_PRIO, NULL);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    double secs = (double)(ctx.t_end_us - ctx.t_start_us) / 1e6;
+    r->generated = ctx.generated;
+    r->delivered = ctx.delivered;
+    r->shed = ctx.shed;
+    r->goodput = secs > 0 ? (double)ctx.delivered / secs : 0.0;
+    r->drop_pct = ctx.generated ? 100.0 * ctx.shed / ctx.generated : 0.0;
+    r->stall_ms = (double)ctx.send_stall_us / 1000.0;
+    lat_hist_snapshot(&ctx.age, &r->age, false);
+
+    vTaskDelay(pdMS_TO_TICKS(20));
+    vQueueDelete(ctx.q);
+    return true;
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "Backpressure under %dx overload: offer every %d ms, cost %d ms, depth %d, %d ms/mode",
+             ITEM_COST_MS / OFFER_PERIOD_MS, OFFER_PERIOD_MS, ITEM_COST_MS, QUEUE_DEPTH, RUN_MS);
+
+    bench_result_t res[MODE_COUNT];
+    memset(res, 0, sizeof(res));
+    for (size_t m = 0; m < MODE_COUNT; m++) {
+        if (!run_one(&MODES[m], &res[m])) ESP_LOGE(TAG, "%s: setup failed", MODES[m].name);
+    }
+
+    printf("\n%-13s %6s %6s %6s %8s %7s %9s %8s %8s\n",
+           "mode", "gen", "done", "shed", "goodput", "drop%", "stall ms", "age p50", "age p99");
+    for (size_t m = 0; m < MODE_COUNT; m++) {
+        const bench_result_t* r = &res[m];
+        printf("%-13s %6lu %6lu %6lu %8.1f %7.1f %9.1f %8.1f %8.1f\n", MODES[m].name,
+               (unsigned long)r->generated, (unsigned long)r->delivered, (unsigned long)r->shed,
+               r->goodput, r->drop_pct, r->stall_ms, r->age.p50_us / 1000.0, r->age.p99_us / 1000.0);
+    }
+    // summary,<mode>,<generated>,<delivered>,<shed>,<goodput>,<drop_pct>,<stall_ms>,<age_p50_ms>,<age_p99_ms>
+    for (size_t m = 0; m < MODE_COUNT; m++) {
+        const bench_result_t* r = &res[m];
+        printf("summary,%s,%lu,%lu,%lu,%.1f,%.1f,%.1f,%.1f,%.1f\n", MODES[m].name,
+               (unsigned long)r->generated, (unsigned long)r->delivered, (unsigned long)r->shed,
+               r->goodput, r->drop_pct, r->stall_ms, r->age.p50_us / 1000.0, r->age.p99_us / 1000.0);
+    }
+    ESP_LOGI(TAG, "Benchmark done");
+}
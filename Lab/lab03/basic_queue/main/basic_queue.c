@@ -6,6 +6,8 @@
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "driver/gpio.h"
+#include "spsc_ring.h"
+#include "queue_telemetry.h"
 
 static const char *TAG = "QUEUE_LAB";
 
@@ -13,8 +15,16 @@ static const char *TAG = "QUEUE_LAB";
 #define LED_SENDER   GPIO_NUM_2
 #define LED_RECEIVER GPIO_NUM_4
 
+/* ====== Channel select ======
+ * sender/receiver เป็นคู่ 1:1 จึงใช้ SPSC ring (lock-free) แทน xQueue ได้
+ * 1 = SPSC ring, 0 = FreeRTOS queue แบบเดิม */
+#define USE_SPSC_RING 1
+#define QUEUE_LENGTH  5     // ring ปัดขึ้นเป็น 2^n = 8
+
 /* ====== Queue handle ====== */
 static QueueHandle_t xQueue = NULL;
+static spsc_ring_t   xRing;
+static queue_telemetry_t xTel;      // watermark/rate/blocked time นับทุก send/receive
 
 /* ====== Message structure ====== */
 typedef struct {
@@ -23,6 +33,56 @@ typedef struct {
     uint32_t timestamp;  // tick count
 } queue_message_t;
 
+/* ====== Channel helpers ====== */
+static BaseType_t channel_send(const queue_message_t *msg, TickType_t wait)
+{
+#if USE_SPSC_RING
+    queue_telemetry_op_t op = queue_telemetry_begin_send(&xTel);
+    BaseType_t ok = spsc_ring_send(&xRing, msg, wait);
+    queue_telemetry_end_send(&xTel, op, ok == pdPASS);
+    return ok;
+#else
+    return queue_telemetry_send(&xTel, msg, wait);
+#endif
+}
+
+static BaseType_t channel_receive(queue_message_t *msg, TickType_t wait)
+{
+#if USE_SPSC_RING
+    queue_telemetry_op_t op = queue_telemetry_begin_receive(&xTel);
+    BaseType_t ok = spsc_ring_receive(&xRing, msg, wait);
+    queue_telemetry_end_receive(&xTel, op, ok == pdPASS);
+    return ok;
+#else
+    return queue_telemetry_receive(&xTel, msg, wait);
+#endif
+}
+
+static UBaseType_t channel_capacity(void)
+{
+#if USE_SPSC_RING
+    return xRing.capacity;
+#else
+    return QUEUE_LENGTH;
+#endif
+}
+
+static UBaseType_t channel_waiting(void)
+{
+#if USE_SPSC_RING
+    return spsc_ring_count(&xRing);
+#else
+    return uxQueueMessagesWaiting(xQueue);
+#endif
+}
+
+#if USE_SPSC_RING
+static UBaseType_t ring_count(void *q)
+{
+    return spsc_ring_count(q);
+}
+#endif
+
 /* ====== Sender Task ====== */
 static void sender_task(void *pvParameters)
 {
@@ -38,7 +98,7 @@ static void sender_task(void *pvParameters)
         msg.timestamp = (uint32_t)xTaskGetTickCount();
 
         // ส่งเข้า queue (รอสูงสุด 1000ms)
-        BaseType_t ok = xQueueSend(xQueue, &msg, pdMS_TO_TICKS(1000));
+        BaseType_t ok = channel_send(&msg, pdMS_TO_TICKS(1000));
         if (ok == pdPASS) {
             ESP_LOGI(TAG, "Sent: ID=%d, MSG=%s, Time=%lu",
                      msg.id, msg.message, (unsigned long)msg.timestamp);
@@ -65,7 +125,7 @@ static void receiver_task(void *pvParameters)
 
     for (;;) {
         // รอรับ (timeout 5s)
-        BaseType_t ok = xQueueReceive(xQueue, &rx, pdMS_TO_TICKS(5000));
+        BaseType_t ok = channel_receive(&rx, pdMS_TO_TICKS(5000));
         if (ok == pdPASS) {
             ESP_LOGI(TAG, "Received: ID=%d, MSG=%s, Time=%lu",
                      rx.id, rx.message, (unsigned long)rx.timestamp);
@@ -89,20 +149,24 @@ static void queue_monitor_task(void *pvParameters)
     ESP_LOGI(TAG, "Queue monitor task started");
 
     for (;;) {
-        UBaseType_t waiting = uxQueueMessagesWaiting(xQueue);
-        UBaseType_t spaces  = uxQueueSpacesAvailable(xQueue);
+        UBaseType_t capacity = channel_capacity();
+        UBaseType_t waiting  = channel_waiting();
+        UBaseType_t spaces   = capacity - waiting;
 
         ESP_LOGI(TAG, "Queue Status - Messages: %u, Free spaces: %u",
                  (unsigned)waiting, (unsigned)spaces);
 
-        // แสดง bar 5 ช่องให้ดูความแน่นแบบคร่าว ๆ
+        // แสดง bar ตามความจุให้ดูความแน่นแบบคร่าว ๆ
         printf("Queue: [");
-        for (int i = 0; i < 5; i++) {
+        for (int i = 0; i < (int)capacity; i++) {
             if (i < (int)waiting) printf("■");
             else                  printf("□");
         }
         printf("]\n");
 
+        // ค่าด้านบนเป็นแค่ภาพ ณ ตอน poll; ตารางนี้เห็น burst ระหว่าง poll ด้วย
+        queue_telemetry_dump(TAG, 3.0f);
+
         vTaskDelay(pdMS_TO_TICKS(3000));
     }
 }
@@ -129,14 +193,25 @@ void app_main(void)
 
     leds_init();
 
+#if USE_SPSC_RING
+    if (!spsc_ring_create(&xRing, sizeof(queue_message_t), QUEUE_LENGTH)) {
+        ESP_LOGE(TAG, "Failed to create ring!");
+        vTaskDelay(portMAX_DELAY);
+        return;
+    }
+    queue_telemetry_register(&xTel, "channel", &xRing, ring_count, xRing.capacity);
+    ESP_LOGI(TAG, "SPSC ring created successfully (size: %u messages)", (unsigned)xRing.capacity);
+#else
     // สร้าง queue ขนาดรับได้ 5 message
-    xQueue = xQueueCreate(5, sizeof(queue_message_t));
+    xQueue = xQueueCreate(QUEUE_LENGTH, sizeof(queue_message_t));
     if (xQueue == NULL) {
         ESP_LOGE(TAG, "Failed to create queue!");
         vTaskDelay(portMAX_DELAY);
         return;
     }
-    ESP_LOGI(TAG, "Queue created successfully (size: 5 messages)");
+    queue_telemetry_register(&xTel, "channel", xQueue, queue_telemetry_xqueue_count, QUEUE_LENGTH);
+    ESP_LOGI(TAG, "Queue created successfully (size: %d messages)", QUEUE_LENGTH);
+#endif
 
     // สร้าง tasks
     BaseType_t ok1 = xTaskCreate(sender_task,  "Sender",  3072, NULL, 2, NULL);
@@ -0,0 +1,197 @@
+// main/frame_ring_bench.c — fixed network_message_t queue vs variable-length frame_ring
+//
+// งบ RAM เท่ากัน: xQueue 8 x 124 B (network queue เดิม) ~ frame_ring 1024 B
+// 1) ความจุ: เติม ring ว่างจนเต็มด้วย payload ขนาดต่าง ๆ แล้วนับว่าได้กี่ข้อความ
+// 2) throughput: producer -> consumer (pinned core เดียวกัน, priority เท่ากัน) BENCH_MSGS ข้อความ
+//    queue = copy 124 B เข้า/ออกเสมอ, ring-copy = copy เฉพาะ byte ที่ใช้, ring-peek = อ่านในที่ไม่ copy ออก
+// "net-mix" = ข้อความจริงของ network_task (priority + source + message แบบไม่มี padding)
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "frame_ring.h"
+
+static const char *TAG = "FRAME_BENCH";
+
+// ===== Config =====
+#define BENCH_MSGS      20000
+#define QUEUE_DEPTH     8
+#define FIXED_MSG       124         // sizeof(network_message_t) เดิม
+#define RING_BYTES      1024
+#define BENCH_CORE      1
+#define BENCH_PRIO      5
+#define NET_MIX         0           // ขนาด 0 ในตาราง = ข้อความ network จริง
+
+static const uint32_t PAYLOAD_SIZES[] = { 16, 24, 48, 100, 124, NET_MIX };
+#define SIZE_COUNT (sizeof(PAYLOAD_SIZES) / sizeof(PAYLOAD_SIZES[0]))
+
+typedef enum { MODE_QUEUE = 0, MODE_RING_COPY, MODE_RING_PEEK, MODE_COUNT } bench_mode_t;
+static const char* const MODE_NAMES[MODE_COUNT] = { "queue", "ring-copy", "ring-peek" };
+
+// เหมือน network_task ใน queue_sets.c
+static const char* const SOURCES[]  = { "WiFi", "Bluetooth", "LoRa", "Ethernet" };
+static const char* const MESSAGES[] = {
+    "Status update received", "Configuration changed", "Alert notification",
+    "Data synchronization", "Heartbeat signal"
+};
+#define NET_COMBOS 20
+
+typedef struct {
+    bench_mode_t  mode;
+    uint32_t      size;
+    QueueHandle_t q;
+    frame_ring_t  ring;
+    TaskHandle_t  notify;
+    uint64_t      bytes;
+    uint32_t      errors;
+} bench_ctx_t;
+
+typedef struct {
+    double   msgs_per_s;
+    double   avg_bytes;
+    uint32_t errors;
+} bench_result_t;
+
+static bench_ctx_t ctx;
+static uint8_t net_msgs[NET_COMBOS][FIXED_MSG];
+static uint32_t net_lens[NET_COMBOS];
+
+// [seq:4][prio:1][src_len:1][source][message]
+static void build_net_msgs(void) {
+    for (int i = 0; i < NET_COMBOS; i++) {
+        const char* src = SOURCES[i % 4];
+        const char* msg = MESSAGES[i % 5];
+        uint8_t* p = net_msgs[i];
+        size_t sl = strlen(src), ml = strlen(msg);
+        p[4] = (uint8_t)(1 + i % 5);
+        p[5] = (uint8_t)sl;
+        memcpy(p + 6, src, sl);
+        memcpy(p + 6 + sl, msg, ml);
+        net_lens[i] = (uint32_t)(6 + sl + ml);
+    }
+}
+
+static inline uint32_t msg_len(uint32_t i) {
+    return ctx.size == NET_MIX ? net_lens[i % NET_COMBOS] : ctx.size;
+}
+
+// ===== Producer / Consumer =====
+static void producer_task(void *pv) {
+    static uint8_t buf[FIXED_MSG];
+    for (uint32_t i = 0; i < BENCH_MSGS; i++) {
+        uint32_t len = msg_len(i);
+        if (ctx.size == NET_MIX) memcpy(buf, net_msgs[i % NET_COMBOS], len);
+        memcpy(buf, &i, sizeof(i));
+        if (ctx.mode == MODE_QUEUE) xQueueSend(ctx.q, buf, portMAX_DELAY);
+        else                        frame_ring_send(&ctx.ring, buf, len, portMAX_DELAY);
+    }
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *pv) {
+    static uint8_t buf[FIXED_MSG];
+    for (uint32_t i = 0; i < BENCH_MSGS; i++) {
+        const uint8_t* p = buf;
+        uint32_t len = FIXED_MSG;
+        switch (ctx.mode) {
+            case MODE_QUEUE:     xQueueReceive(ctx.q, buf, portMAX_DELAY); break;
+            case MODE_RING_COPY: frame_ring_receive(&ctx.ring, buf, sizeof(buf), &len, portMAX_DELAY); break;
+            case MODE_RING_PEEK: p = frame_ring_peek_wait(&ctx.ring, &len, portMAX_DELAY); break;
+            default: break;
+        }
+        uint32_t seq;
+        memcpy(&seq, p, sizeof(seq));
+        if (seq != i || (ctx.mode != MODE_QUEUE && len != msg_len(i))) ctx.errors++;
+        ctx.bytes += ctx.mode == MODE_QUEUE ? FIXED_MSG : frame_ring_record_bytes(len);
+        if (ctx.mode == MODE_RING_PEEK) frame_ring_consume(&ctx.ring);
+    }
+    xTaskNotifyGive(ctx.notify);
+    vTaskDelete(NULL);
+}
+
+// ===== Capacity =====
+// ข้อความที่ใส่ ring ว่างได้จนเต็ม (เริ่มที่ offset 0)
+static uint32_t ring_capacity(uint32_t size) {
+    static uint8_t buf[FIXED_MSG];
+    frame_ring_t r;
+    if (!frame_ring_create(&r, RING_BYTES)) return 0;
+    uint32_t n = 0;
+    while (frame_ring_try_send(&r, buf, size == NET_MIX ? net_lens[n % NET_COMBOS] : size)) n++;
+    frame_ring_destroy(&r);
+    return n;
+}
+
+// ===== Runner =====
+static bool run_one(bench_mode_t mode, uint32_t size, bench_result_t* r) {
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.mode = mode;
+    ctx.size = size;
+    ctx.notify = xTaskGetCurrentTaskHandle();
+    if (mode == MODE_QUEUE) {
+        ctx.q = xQueueCreate(QUEUE_DEPTH, FIXED_MSG);
+        if (!ctx.q) return false;
+    } else if (!frame_ring_create(&ctx.ring, RING_BYTES)) {
+        return false;
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    xTaskCreatePinnedToCore(consumer_task, "fr_cons", 3072, NULL, BENCH_PRIO, NULL, BENCH_CORE);
+    xTaskCreatePinnedToCore(producer_task, "fr_prod", 3072, NULL, BENCH_PRIO, NULL, BENCH_CORE);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t dt = esp_timer_get_time() - t0;
+
+    r->msgs_per_s = dt > 0 ? (double)BENCH_MSGS * 1e6 / (double)dt : 0.0;
+    r->avg_bytes = (double)ctx.bytes / BENCH_MSGS;
+    r->errors = ctx.errors;
+
+    vTaskDelay(pdMS_TO_TICKS(10));
+    if (mode == MODE_QUEUE) vQueueDelete(ctx.q);
+    else                    frame_ring_destroy(&ctx.ring);
+    return true;
+}
+
+void app_main(void) {
+    build_net_msgs();
+    ESP_LOGI(TAG, "Framed ring vs fixed %u B queue: budget %u B queue / %u B ring, %u msgs",
+             FIXED_MSG, QUEUE_DEPTH * FIXED_MSG, RING_BYTES, BENCH_MSGS);
+
+    bench_result_t res[SIZE_COUNT][MODE_COUNT];
+    uint32_t cap[SIZE_COUNT];
+    memset(res, 0, sizeof(res));
+    for (size_t s = 0; s < SIZE_COUNT; s++) {
+        cap[s] = ring_capacity(PAYLOAD_SIZES[s]);
+        for (int m = 0; m < MODE_COUNT; m++) {
+            if (!run_one((bench_mode_t)m, PAYLOAD_SIZES[s], &res[s][m])) {
+                ESP_LOGE(TAG, "%s %u B: setup failed", MODE_NAMES[m], (unsigned)PAYLOAD_SIZES[s]);
+            }
+        }
+    }
+
+    printf("\n%-8s %6s %6s %7s %9s %12s %12s %12s\n", "payload", "rec B", "q cap", "ring cap",
+           "cap gain", "queue msg/s", "copy msg/s", "peek msg/s");
+    for (size_t s = 0; s < SIZE_COUNT; s++) {
+        char label[12];
+        if (PAYLOAD_SIZES[s] == NET_MIX) snprintf(label, sizeof(label), "net-mix");
+        else                             snprintf(label, sizeof(label), "%u", (unsigned)PAYLOAD_SIZES[s]);
+        printf("%-8s %6.1f %6u %7lu %8.1fx %12.0f %12.0f %12.0f\n", label,
+               res[s][MODE_RING_COPY].avg_bytes, QUEUE_DEPTH, (unsigned long)cap[s],
+               (double)cap[s] / QUEUE_DEPTH, res[s][MODE_QUEUE].msgs_per_s,
+               res[s][MODE_RING_COPY].msgs_per_s, res[s][MODE_RING_PEEK].msgs_per_s);
+        for (int m = 0; m < MODE_COUNT; m++) {
+            if (res[s][m].errors) ESP_LOGW(TAG, "%s %s: %lu errors", label, MODE_NAMES[m], (unsigned long)res[s][m].errors);
+        }
+    }
+    // summary,<payload>,<mode>,<capacity>,<avg_stored_bytes>,<msgs/s>,<errors>   (payload 0 = net-mix)
+    for (size_t s = 0; s < SIZE_COUNT; s++) {
+        for (int m = 0; m < MODE_COUNT; m++) {
+            printf("summary,%u,%s,%lu,%.1f,%.0f,%lu\n", (unsigned)PAYLOAD_SIZES[s], MODE_NAMES[m],
+                   (unsigned long)(m == MODE_QUEUE ? QUEUE_DEPTH : cap[s]), res[s][m].avg_bytes,
+                   res[s][m].msgs_per_s, (unsigned long)res[s][m].errors);
+        }
+    }
+    ESP_LOGI(TAG, "Benchmark done");
+}
@@ -0,0 +1,143 @@
+// main/log_bench.c — producer throughput: ไม่ log vs safe_printf (mutex) vs task_log
+//
+// producer 4 ตัว (prio 3 แบบ producer_consumer.c) สร้าง product แล้ว log 1 บรรทัดต่อชิ้น
+// ต้นทุนต่อชิ้น ITEM_WORK_US + พัก 1 tick ทุก ITEMS_PER_TICK ชิ้น (เหลือ CPU ให้ drain)
+// วัด items/s ที่ producer ทำได้ และจำนวนบรรทัดที่ออก console / ถูกทิ้ง
+// console (UART) รับได้จำกัด: mutex = producer ช้าลงตาม UART, task_log = producer ไม่ช้าลงแต่บรรทัดส่วนเกินถูกทิ้ง
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "task_log.h"
+
+static const char *TAG = "LOG_BENCH";
+
+// ===== Config =====
+#define PRODUCERS         4
+#define PRODUCER_PRIO     3
+#define DRAIN_PRIO        2
+#define RUN_MS            3000
+#define ITEM_WORK_US      100
+#define ITEMS_PER_TICK    8
+#define LOG_LINES         16
+
+typedef enum { LOG_NONE = 0, LOG_MUTEX, LOG_TASK, LOG_COUNT } log_mode_t;
+static const char* const MODE_NAMES[LOG_COUNT] = { "none", "mutex", "task_log" };
+
+typedef struct {
+    log_mode_t        mode;
+    SemaphoreHandle_t print_mutex;
+    TaskHandle_t      notify;
+    int64_t           t_end_us;
+    _Atomic uint32_t  items;
+    _Atomic uint32_t  mutex_timeouts;
+    _Atomic uint32_t  done;
+} bench_ctx_t;
+
+typedef struct {
+    double   items_per_s;
+    uint32_t written;
+    uint32_t dropped;
+} bench_result_t;
+
+static bench_ctx_t ctx;
+
+// เหมือน safe_printf เดิมใน producer_consumer.c
+static void mutex_printf(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    if (xSemaphoreTake(ctx.print_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        vprintf(fmt, args);
+        xSemaphoreGive(ctx.print_mutex);
+    } else {
+        atomic_fetch_add(&ctx.mutex_timeouts, 1);
+    }
+    va_end(args);
+}
+
+// ===== Producer =====
+static void producer_task(void *pv) {
+    int id = (int)(intptr_t)pv;
+    char name[30];
+    uint32_t n = 0;
+    while (esp_timer_get_time() < ctx.t_end_us) {
+        snprintf(name, sizeof(name), "Product-P%d-#%lu", id, (unsigned long)n);
+        esp_rom_delay_us(ITEM_WORK_US);
+        switch (ctx.mode) {
+            case LOG_MUTEX: mutex_printf("✓ Producer %d: Created %s (processing: %dms)\n", id, name, 500); break;
+            case LOG_TASK:  task_log_printf("✓ Producer %d: Created %s (processing: %dms)\n", id, name, 500); break;
+            default: break;
+        }
+        if (++n % ITEMS_PER_TICK == 0) vTaskDelay(1);
+    }
+    atomic_fetch_add(&ctx.items, n);
+    task_log_unregister();              // คืน slot ให้ producer ของ mode ถัดไป
+    if (atomic_fetch_add(&ctx.done, 1) + 1 == PRODUCERS) xTaskNotifyGive(ctx.notify);
+    vTaskDelete(NULL);
+}
+
+// ===== Runner =====
+static void run_one(log_mode_t mode, bench_result_t* r) {
+    task_log_stats_t before, after;
+    task_log_get_stats(&before);
+
+    ctx.mode = mode;
+    ctx.notify = xTaskGetCurrentTaskHandle();
+    atomic_store(&ctx.items, 0);
+    atomic_store(&ctx.done, 0);
+    int64_t t0 = esp_timer_get_time();
+    ctx.t_end_us = t0 + (int64_t)RUN_MS * 1000;
+    for (int p = 0; p < PRODUCERS; p++) {
+        xTaskCreate(producer_task, "lb_prod", 3072, (void*)(intptr_t)(p + 1), PRODUCER_PRIO, NULL);
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t dt = esp_timer_get_time() - t0;
+
+    vTaskDelay(pdMS_TO_TICKS(500));     // ให้ drain เขียนที่ค้างให้หมด
+    task_log_get_stats(&after);
+
+    r->items_per_s = dt > 0 ? (double)atomic_load(&ctx.items) * 1e6 / (double)dt : 0.0;
+    if (mode == LOG_TASK) {
+        r->written = after.written - before.written;
+        r->dropped = after.dropped - before.dropped;
+    } else if (mode == LOG_MUTEX) {
+        r->dropped = atomic_load(&ctx.mutex_timeouts);
+        r->written = atomic_load(&ctx.items) - r->dropped;
+    }
+}
+
+void app_main(void) {
+    ctx.print_mutex = xSemaphoreCreateMutex();
+    if (!ctx.print_mutex || !task_log_init(LOG_LINES, DRAIN_PRIO)) {
+        ESP_LOGE(TAG, "setup failed");
+        return;
+    }
+    ESP_LOGI(TAG, "Logging cost: %d producers, %d ms per mode, %d us work/item", PRODUCERS, RUN_MS, ITEM_WORK_US);
+
+    bench_result_t res[LOG_COUNT];
+    memset(res, 0, sizeof(res));
+    for (int m = 0; m < LOG_COUNT; m++) run_one((log_mode_t)m, &res[m]);
+
+    double base = res[LOG_NONE].items_per_s, slow = res[LOG_MUTEX].items_per_s;
+    printf("\n%-9s %10s %9s %9s %9s\n", "mode", "items/s", "vs none", "written", "dropped");
+    for (int m = 0; m < LOG_COUNT; m++) {
+        printf("%-9s %10.0f %8.0f%% %9lu %9lu\n", MODE_NAMES[m], res[m].items_per_s,
+               base > 0 ? 100.0 * res[m].items_per_s / base : 0.0,
+               (unsigned long)res[m].written, (unsigned long)res[m].dropped);
+    }
+    printf("throughput recovered by task_log: %.0f%% of the mutex loss\n",
+           base > slow ? 100.0 * (res[LOG_TASK].items_per_s - slow) / (base - slow) : 0.0);
+    // summary,<mode>,<items_per_s>,<written>,<dropped>
+    for (int m = 0; m < LOG_COUNT; m++) {
+        printf("summary,%s,%.0f,%lu,%lu\n", MODE_NAMES[m], res[m].items_per_s,
+               (unsigned long)res[m].written, (unsigned long)res[m].dropped);
+    }
+    ESP_LOGI(TAG, "Benchmark done");
+}
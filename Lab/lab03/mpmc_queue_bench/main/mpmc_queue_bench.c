@@ -0,0 +1,177 @@
+// main/mpmc_queue_bench.c — scaling: FreeRTOS queue vs Vyukov MPMC queue
+//
+// ส่ง product_t (แบบเดียวกับ producer_consumer.c) รวม BENCH_MSGS ชิ้น
+// จาก producer 1..8 ตัวไปยัง consumer 1..4 ตัว ผ่านคิว depth 16 ทั้งสองแบบ (ความจุเท่ากัน)
+// + xQueue depth 10 แบบที่ producer_consumer.c ใช้จริง: ใน lab mpmc ปัด 10 เป็น 16
+//   -> เทียบใน lab ไม่ใช่ความจุเท่ากัน คอลัมน์ q10 บอกว่าส่วนต่างมาจากความจุเท่าไร
+// วัด msgs/s และจำนวนครั้งที่ต้อง block / CAS ชนกัน
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "mpmc_queue.h"
+
+static const char *TAG = "MPMC_BENCH";
+
+// ===== Config =====
+#define BENCH_MSGS      20000
+#define QUEUE_DEPTH     16              // 2^n: mpmc ไม่ต้องปัด -> ความจุเท่ากับ xQueue
+#define LAB_QUEUE_DEPTH 10              // PRODUCT_QUEUE_DEPTH ใน producer_consumer.c
+#define BENCH_PRIO      5
+
+static const int PRODUCER_COUNTS[] = { 1, 2, 4, 8 };
+static const int CONSUMER_COUNTS[] = { 1, 2, 4 };
+#define P_STEPS (sizeof(PRODUCER_COUNTS) / sizeof(PRODUCER_COUNTS[0]))
+#define C_STEPS (sizeof(CONSUMER_COUNTS) / sizeof(CONSUMER_COUNTS[0]))
+
+_Static_assert((QUEUE_DEPTH & (QUEUE_DEPTH - 1)) == 0, "QUEUE_DEPTH must be a power of two");
+
+// ขนาดเดียวกับ product_t ใน producer_consumer.c
+typedef struct {
+    int      producer_id;
+    int      product_id;
+    char     product_name[30];
+    int64_t  production_us;
+    int      processing_time_ms;
+} product_t;
+
+typedef enum { Q_FREERTOS = 0, Q_MPMC, Q_FREERTOS_LAB, Q_COUNT } queue_kind_t;
+static const char* const Q_NAMES[Q_COUNT] = { "queue", "mpmc", "queue10" };
+static const UBaseType_t Q_DEPTHS[Q_COUNT] = { QUEUE_DEPTH, QUEUE_DEPTH, LAB_QUEUE_DEPTH };
+
+typedef struct {
+    queue_kind_t     kind;
+    QueueHandle_t    q;
+    mpmc_queue_t     mq;
+    int              producers;
+    int              consumers;
+    TaskHandle_t     notify;
+    _Atomic uint32_t claimed;       // consumer จองสิทธิ์รับก่อน -> รู้ว่าเมื่อไรหยุด
+    _Atomic uint32_t done;
+    _Atomic uint32_t seq_errors;
+} bench_ctx_t;
+
+typedef struct {
+    double   msgs_per_s;
+    uint32_t full_waits;
+    uint32_t empty_waits;
+    uint32_t cas_retries;
+    uint32_t errors;
+} bench_result_t;
+
+static bench_ctx_t ctx;
+static int last_seq[8];             // product_id ล่าสุดต่อ producer (ต้องเพิ่มขึ้นเสมอในมุมของ consumer เดียว)
+
+// ===== Producer / Consumer =====
+static void producer_task(void *pv) {
+    int id = (int)(intptr_t)pv;
+    uint32_t quota = BENCH_MSGS / ctx.producers + (id < (int)(BENCH_MSGS % ctx.producers) ? 1 : 0);
+    product_t p = { .producer_id = id };
+
+    for (uint32_t i = 0; i < quota; i++) {
+        p.product_id = (int)i;
+        p.production_us = esp_timer_get_time();
+        if (ctx.kind != Q_MPMC) xQueueSend(ctx.q, &p, portMAX_DELAY);
+        else                        mpmc_queue_send(&ctx.mq, &p, portMAX_DELAY);
+    }
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *pv) {
+    product_t p;
+    while (atomic_fetch_add(&ctx.claimed, 1) < BENCH_MSGS) {
+        if (ctx.kind != Q_MPMC) xQueueReceive(ctx.q, &p, portMAX_DELAY);
+        else                        mpmc_queue_receive(&ctx.mq, &p, portMAX_DELAY);
+        if (p.producer_id < 0 || p.producer_id >= 8 || p.product_id < 0) {
+            atomic_fetch_add(&ctx.seq_errors, 1);
+        } else if (ctx.consumers == 1) {
+            // consumer เดียว: ของจาก producer เดียวกันต้องมาตามลำดับ
+            if (p.product_id != last_seq[p.producer_id] + 1) atomic_fetch_add(&ctx.seq_errors, 1);
+            last_seq[p.producer_id] = p.product_id;
+        }
+    }
+    if (atomic_fetch_add(&ctx.done, 1) + 1 == (uint32_t)ctx.consumers) {
+        xTaskNotifyGive(ctx.notify);
+    }
+    vTaskDelete(NULL);
+}
+
+// ===== Runner =====
+static bool run_one(queue_kind_t kind, int producers, int consumers, bench_result_t* r) {
+    memset(&ctx, 0, sizeof(ctx));
+    for (int i = 0; i < 8; i++) last_seq[i] = -1;
+    ctx.kind = kind;
+    ctx.producers = producers;
+    ctx.consumers = consumers;
+    ctx.notify = xTaskGetCurrentTaskHandle();
+
+    if (kind != Q_MPMC) {
+        ctx.q = xQueueCreate(Q_DEPTHS[kind], sizeof(product_t));
+        if (!ctx.q) return false;
+    } else if (!mpmc_queue_create(&ctx.mq, sizeof(product_t), QUEUE_DEPTH)) {
+        return false;
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    for (int c = 0; c < consumers; c++) {
+        xTaskCreate(consumer_task, "mq_cons", 3072, NULL, BENCH_PRIO, NULL);
+    }
+    for (int p = 0; p < producers; p++) {
+        xTaskCreate(producer_task, "mq_prod", 3072, (void*)(intptr_t)p, BENCH_PRIO, NULL);
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t dt = esp_timer_get_time() - t0;
+
+    r->msgs_per_s  = dt > 0 ? (double)BENCH_MSGS * 1e6 / (double)dt : 0.0;
+    r->full_waits  = atomic_load(&ctx.mq.full_waits);
+    r->empty_waits = atomic_load(&ctx.mq.empty_waits);
+    r->cas_retries = atomic_load(&ctx.mq.cas_retries);
+    r->errors      = atomic_load(&ctx.seq_errors);
+
+    vTaskDelay(pdMS_TO_TICKS(20));      // ให้ task ลบตัวเองเสร็จ
+    if (kind != Q_MPMC) vQueueDelete(ctx.q);
+    else                  mpmc_queue_destroy(&ctx.mq);
+    return true;
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "MPMC scaling benchmark: %u msgs of %u B, depth %u (q10: xQueue depth %u)",
+             BENCH_MSGS, (unsigned)sizeof(product_t), QUEUE_DEPTH, LAB_QUEUE_DEPTH);
+
+    printf("\n%3s %3s %12s %12s %8s %12s %10s %10s %8s\n",
+           "P", "C", "queue msg/s", "mpmc msg/s", "speedup", "q10 msg/s",
+           "full wait", "empty wait", "cas");
+    for (size_t pi = 0; pi < P_STEPS; pi++) {
+        for (size_t ci = 0; ci < C_STEPS; ci++) {
+            bench_result_t res[Q_COUNT];
+            memset(res, 0, sizeof(res));
+            for (int k = 0; k < Q_COUNT; k++) {
+                if (!run_one((queue_kind_t)k, PRODUCER_COUNTS[pi], CONSUMER_COUNTS[ci], &res[k])) {
+                    ESP_LOGE(TAG, "%s P=%d C=%d: setup failed", Q_NAMES[k],
+                             PRODUCER_COUNTS[pi], CONSUMER_COUNTS[ci]);
+                }
+            }
+            const bench_result_t* q = &res[Q_FREERTOS];
+            const bench_result_t* m = &res[Q_MPMC];
+            printf("%3d %3d %12.0f %12.0f %7.2fx %12.0f %10lu %10lu %8lu\n",
+                   PRODUCER_COUNTS[pi], CONSUMER_COUNTS[ci], q->msgs_per_s, m->msgs_per_s,
+                   q->msgs_per_s > 0 ? m->msgs_per_s / q->msgs_per_s : 0.0,
+                   res[Q_FREERTOS_LAB].msgs_per_s,
+                   (unsigned long)m->full_waits, (unsigned long)m->empty_waits,
+                   (unsigned long)m->cas_retries);
+            // summary,<queue>,<P>,<C>,<msgs/s>,<full_waits>,<empty_waits>,<cas_retries>,<errors>
+            for (int k = 0; k < Q_COUNT; k++) {
+                printf("summary,%s,%d,%d,%.0f,%lu,%lu,%lu,%lu\n", Q_NAMES[k],
+                       PRODUCER_COUNTS[pi], CONSUMER_COUNTS[ci], res[k].msgs_per_s,
+                       (unsigned long)res[k].full_waits, (unsigned long)res[k].empty_waits,
+                       (unsigned long)res[k].cas_retries, (unsigned long)res[k].errors);
+            }
+        }
+    }
+    ESP_LOGI(TAG, "Benchmark done");
+}
@@ -0,0 +1,167 @@
+// main/prio_queue_bench.c — latency ต่อ priority: FIFO xQueue vs prio_queue
+//
+// producer ยิง network_message_t เป็น burst ละ BURST_ITEMS ชิ้นทุก BURST_PERIOD_MS
+// priority สุ่มแบบ traffic จริง: heartbeat/status (P1-P2) เยอะ, alert (P5) น้อย
+// คิว depth 8 เล็กกว่า burst -> producer (prio สูงกว่า) เติมคิวเต็มแล้ว block รอ consumer
+// วัดเวลาตั้งแต่สร้างข้อความจนถึง consumer หยิบ แยกตาม priority (p50/p99/max)
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "esp_rom_sys.h"
+#include "prio_queue.h"
+#include "lat_hist.h"
+
+static const char *TAG = "PRIO_BENCH";
+
+// ===== Config =====
+#define QUEUE_DEPTH       8         // เท่า network queue
+#define BURSTS            200
+#define BURST_ITEMS       12
+#define BURST_PERIOD_MS   100
+#define ITEM_COST_US      3000
+#define PRODUCER_PRIO     5
+#define CONSUMER_PRIO     4
+#define PRIO_LEVELS       5
+
+// สัดส่วน P1..P5 (%)
+static const uint32_t PRIO_MIX[PRIO_LEVELS] = { 50, 20, 15, 10, 5 };
+
+typedef enum { Q_FIFO = 0, Q_PRIO, Q_COUNT } queue_kind_t;
+static const char* const Q_NAMES[Q_COUNT] = { "fifo", "prio" };
+
+// เหมือน network_message_t ใน queue_sets.c
+typedef struct {
+    char    source[20];
+    char    message[100];
+    int     priority;
+    int64_t t_sent_us;
+} bench_msg_t;
+
+typedef struct {
+    queue_kind_t  kind;
+    QueueHandle_t q;
+    prio_queue_t  pq;
+    lat_hist_t    lat[PRIO_LEVELS];
+    volatile bool gen_done;
+    TaskHandle_t  notify;
+    uint32_t      processed;
+    int64_t       t_start_us;
+    int64_t       t_end_us;
+} bench_ctx_t;
+
+typedef struct {
+    lat_hist_snapshot_t lat[PRIO_LEVELS];
+    double msgs_per_s;
+} bench_result_t;
+
+static bench_ctx_t ctx;
+
+static int random_priority(void) {
+    uint32_t r = esp_random() % 100, acc = 0;
+    for (int p = 0; p < PRIO_LEVELS; p++) {
+        acc += PRIO_MIX[p];
+        if (r < acc) return p + 1;
+    }
+    return 1;
+}
+
+// ===== Producer / Consumer =====
+static void producer_task(void *pv) {
+    bench_msg_t m;
+    memset(&m, 0, sizeof(m));
+    TickType_t last = xTaskGetTickCount();
+    for (int b = 0; b < BURSTS; b++) {
+        for (int i = 0; i < BURST_ITEMS; i++) {
+            m.priority = random_priority();
+            m.t_sent_us = esp_timer_get_time();
+            if (ctx.kind == Q_FIFO) xQueueSend(ctx.q, &m, portMAX_DELAY);
+            else                    prio_queue_send(&ctx.pq, &m, (uint8_t)m.priority, portMAX_DELAY);
+        }
+        vTaskDelayUntil(&last, pdMS_TO_TICKS(BURST_PERIOD_MS));
+    }
+    ctx.gen_done = true;
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *pv) {
+    bench_msg_t m;
+    while (1) {
+        BaseType_t ok = ctx.kind == Q_FIFO ? xQueueReceive(ctx.q, &m, pdMS_TO_TICKS(100))
+                                           : prio_queue_receive(&ctx.pq, &m, pdMS_TO_TICKS(100));
+        if (ok != pdPASS) {
+            if (ctx.gen_done) break;
+            continue;
+        }
+        lat_hist_record_since(&ctx.lat[m.priority - 1], m.t_sent_us);
+        esp_rom_delay_us(ITEM_COST_US);
+        ctx.processed++;
+    }
+    ctx.t_end_us = esp_timer_get_time();
+    xTaskNotifyGive(ctx.notify);
+    vTaskDelete(NULL);
+}
+
+// ===== Runner =====
+static bool run_one(queue_kind_t kind, bench_result_t* r) {
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.kind = kind;
+    ctx.notify = xTaskGetCurrentTaskHandle();
+    if (kind == Q_FIFO) {
+        ctx.q = xQueueCreate(QUEUE_DEPTH, sizeof(bench_msg_t));
+        if (!ctx.q) return false;
+    } else if (!prio_queue_create(&ctx.pq, sizeof(bench_msg_t), QUEUE_DEPTH)) {
+        return false;
+    }
+    for (int p = 0; p < PRIO_LEVELS; p++) lat_hist_init(&ctx.lat[p]);
+
+    ctx.t_start_us = esp_timer_get_time();
+    xTaskCreate(consumer_task, "pq_cons", 3072, NULL, CONSUMER_PRIO, NULL);
+    xTaskCreate(producer_task, "pq_prod", 3072, NULL, PRODUCER_PRIO, NULL);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    double secs = (double)(ctx.t_end_us - ctx.t_start_us) / 1e6;
+    r->msgs_per_s = secs > 0 ? (double)ctx.processed / secs : 0.0;
+    for (int p = 0; p < PRIO_LEVELS; p++) lat_hist_snapshot(&ctx.lat[p], &r->lat[p], false);
+
+    vTaskDelay(pdMS_TO_TICKS(20));
+    if (kind == Q_FIFO) vQueueDelete(ctx.q);
+    else                prio_queue_destroy(&ctx.pq);
+    return true;
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "Priority latency: %d bursts x %d msgs every %d ms, depth %d, cost %d us",
+             BURSTS, BURST_ITEMS, BURST_PERIOD_MS, QUEUE_DEPTH, ITEM_COST_US);
+
+    bench_result_t res[Q_COUNT];
+    memset(res, 0, sizeof(res));
+    for (int k = 0; k < Q_COUNT; k++) {
+        if (!run_one((queue_kind_t)k, &res[k])) ESP_LOGE(TAG, "%s: setup failed", Q_NAMES[k]);
+    }
+
+    printf("\n%4s %6s %10s %10s %10s %10s %10s %10s\n",
+           "prio", "n", "fifo p50", "fifo p99", "fifo max", "prio p50", "prio p99", "prio max");
+    for (int p = PRIO_LEVELS - 1; p >= 0; p--) {
+        const lat_hist_snapshot_t* f = &res[Q_FIFO].lat[p];
+        const lat_hist_snapshot_t* q = &res[Q_PRIO].lat[p];
+        printf("  P%d %6lu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", p + 1, (unsigned long)q->count,
+               f->p50_us / 1000.0, f->p99_us / 1000.0, f->max_us / 1000.0,
+               q->p50_us / 1000.0, q->p99_us / 1000.0, q->max_us / 1000.0);
+    }
+    printf("throughput: fifo %.0f msg/s, prio %.0f msg/s\n", res[Q_FIFO].msgs_per_s, res[Q_PRIO].msgs_per_s);
+    // summary,<queue>,<priority>,<n>,<p50_ms>,<p99_ms>,<max_ms>,<msgs/s>
+    for (int k = 0; k < Q_COUNT; k++) {
+        for (int p = PRIO_LEVELS - 1; p >= 0; p--) {
+            const lat_hist_snapshot_t* s = &res[k].lat[p];
+            printf("summary,%s,%d,%lu,%.1f,%.1f,%.1f,%.0f\n", Q_NAMES[k], p + 1, (unsigned long)s->count,
+                   s->p50_us / 1000.0, s->p99_us / 1000.0, s->max_us / 1000.0, res[k].msgs_per_s);
+        }
+    }
+    ESP_LOGI(TAG, "Benchmark done");
+}
@@ -11,6 +11,12 @@
 #include "esp_log.h"
 #include "driver/gpio.h"
 #include "esp_random.h"
+#include "esp_timer.h"
+#include "mpmc_queue.h"
+#include "lat_hist.h"
+#include "flow_ctl.h"
+#include "task_log.h"
+#include "shard_stats.h"
 
 static const char *TAG = "PROD_CONS";
 
@@ -22,35 +28,171 @@ static const char *TAG = "PROD_CONS";
 #define LED_CONSUMER_2 GPIO_NUM_19
 
 // ====== Queue & Sync ======
+// 1 = MPMC queue แบบ lock-free (producer ไม่ต้องต่อคิวรอ lock ของ xQueue), 0 = xQueue เดิม
+#define USE_MPMC_QUEUE       1
+#define PRODUCT_QUEUE_DEPTH  10     // mpmc ปัดขึ้นเป็น 16
+// consumer รับทีละชิ้น: งานละ 0.5–2.5 s ถ้าดึงเป็น batch ชิ้นที่ถืออยู่จะหายจาก backlog
+// (load balancer มองไม่เห็น) และ consumer ตัวอื่นที่ว่างก็หยิบไปทำไม่ได้
+
+// 1 = credit-based backpressure: consumer คืน credit เมื่อทำเสร็จ, producer ชะลอตัวเองเมื่อ credit หมด
+//     แล้วจัดการชิ้นที่ส่งไม่ได้ตาม FLOW_SHED_POLICY; 0 = รอคิว 100 ms แล้ว drop แบบเดิม
+#define USE_FLOW_CONTROL     1
+#define FLOW_SHED_POLICY     FLOW_SHED_DROP_OLDEST
+#define FLOW_BACKOFF_STEP_MS 250
+#define FLOW_BACKOFF_MAX_MS  4000
+
 static QueueHandle_t xProductQueue = NULL;
+static mpmc_queue_t  xProductMpmc;
 static SemaphoreHandle_t xPrintMutex = NULL;
+static flow_ctl_t    product_flow;
+
+// ====== Elastic consumer pool ======
+// สร้าง consumer ไว้ครบ MAX_CONSUMERS ตั้งแต่ต้น ตัวที่เกิน MIN_CONSUMERS จอด (park) รอ semaphore
+// load_balancer_task ปลุก/จอดตาม backlog และ queue time ที่ผ่าน EWMA แล้ว
+#define MIN_CONSUMERS        1
+#define MAX_CONSUMERS        4
+#define SCALE_SAMPLE_MS      500
+#define SCALE_EWMA_ALPHA     0.3f
+#define SCALE_UP_DEPTH       6.0f       // backlog เฉลี่ย (ชิ้น)
+#define SCALE_UP_QTIME_MS    3000.0f    // queue time เฉลี่ย
+#define SCALE_DOWN_DEPTH     1.0f
+#define SCALE_DOWN_QTIME_MS  1000.0f
+#define SCALE_UP_COOLDOWN    4          // sample ที่ต้องรอหลังเพิ่ม worker ก่อนเพิ่มอีก
+#define SCALE_DOWN_HOLD      10         // sample ต่ำกว่าเกณฑ์ติดกันก่อน park (hysteresis)
+#define SERIES_EVERY         2          // พิมพ์ series ทุก N sample
+
+typedef struct {
+    int               id;
+    volatile bool     active;
+    SemaphoreHandle_t wake;             // binary: ปลุกตัวที่จอดอยู่
+} worker_t;
+
+static worker_t workers[MAX_CONSUMERS];
+static volatile int   active_workers = 0;
+static float          qtime_ewma_ms  = 0.0f;   // consumer หลายตัวอัปเดต, load balancer decay/อ่าน
+static portMUX_TYPE   qtime_lock     = portMUX_INITIALIZER_UNLOCKED;   // read-modify-write ต้องไม่ชนกัน
+
+// consumer ส่ง queue time เข้ามา, balancer ส่ง 0 เพื่อ decay ตอนคิวว่าง
+static void qtime_ewma_update(float sample_ms, float alpha) {
+    portENTER_CRITICAL(&qtime_lock);
+    qtime_ewma_ms += alpha * (sample_ms - qtime_ewma_ms);
+    portEXIT_CRITICAL(&qtime_lock);
+}
+
+static float qtime_ewma_read(void) {
+    portENTER_CRITICAL(&qtime_lock);
+    float v = qtime_ewma_ms;
+    portEXIT_CRITICAL(&qtime_lock);
+    return v;
+}
+
+// ====== Bursty load ======
+// ท้ายทุก BURST_PERIOD_S วินาที producer เร่งเป็น 0.2–0.6s ต่อชิ้นนาน BURST_LENGTH_S วินาที
+#define BURSTY_LOAD          1
+#define BURST_PERIOD_S       40
+#define BURST_LENGTH_S       12
 
 // ====== Stats ======
 typedef struct {
+    uint32_t offered;       // ชิ้นที่ producer สร้าง (ส่งได้หรือไม่ก็ตาม)
     uint32_t produced;
     uint32_t consumed;
     uint32_t dropped;
 } stats_t;
 
-static stats_t global_stats = {0, 0, 0};
+// ตัวนับจริงอยู่ใน shard ต่อ core (producer/consumer หลายตัวบนสอง core), stats_t เป็นแค่ค่าที่อ่านรวมแล้ว
+enum { STAT_OFFERED, STAT_PRODUCED, STAT_CONSUMED, STAT_DROPPED, STAT_COUNT };
+
+static shard_stats_t global_stats;
+
+static stats_t stats_read(void) {
+    uint32_t v[STAT_COUNT];
+    shard_stats_read(&global_stats, v, STAT_COUNT);
+    return (stats_t){ v[STAT_OFFERED], v[STAT_PRODUCED], v[STAT_CONSUMED], v[STAT_DROPPED] };
+}
+
+// ====== Latency ======
+// queue time (ผลิต -> consumer หยิบ) แยกตาม producer และรวมทั้งคิว
+// statistics_task อ่าน snapshot แล้ว reset ทุกรอบ -> ได้ p50/p99/max ของแต่ละ interval
+#define LAT_PRODUCERS        4
+
+static lat_hist_t lat_queue;
+static lat_hist_t lat_producer[LAT_PRODUCERS];
 
 // ====== Product ======
 typedef struct {
     int      producer_id;
     int      product_id;
     char     product_name[30];
-    uint32_t production_tick;
+    int64_t  production_us;             // esp_timer_get_time() ตอนผลิต
     int      processing_time_ms;
 } product_t;
 
+// ====== Product channel ======
+static BaseType_t product_send(const product_t* p, TickType_t wait) {
+#if USE_MPMC_QUEUE
+    return mpmc_queue_send(&xProductMpmc, p, wait);
+#else
+    return xQueueSend(xProductQueue, p, wait);
+#endif
+}
+
+static BaseType_t product_receive(product_t* out, TickType_t wait) {
+#if USE_MPMC_QUEUE
+    return mpmc_queue_receive(&xProductMpmc, out, wait);
+#else
+    return xQueueReceive(xProductQueue, out, wait);
+#endif
+}
+
+static UBaseType_t product_backlog(void) {
+#if USE_MPMC_QUEUE
+    return mpmc_queue_count(&xProductMpmc);
+#else
+    return uxQueueMessagesWaiting(xProductQueue);
+#endif
+}
+
+static UBaseType_t product_capacity(void) {
+#if USE_MPMC_QUEUE
+    return xProductMpmc.capacity;
+#else
+    return PRODUCT_QUEUE_DEPTH;
+#endif
+}
+
+// สำหรับ flow_ctl (ไม่รอ)
+static bool product_try_send(void* q, void* item) {
+    return product_send((const product_t*)item, 0) == pdPASS;
+}
+
+static bool product_try_evict(void* q, void* item) {
+    return product_receive((product_t*)item, 0) == pdPASS;
+}
+
+static bool burst_active(void) {
+    uint32_t sec = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS / 1000);
+    return (sec % BURST_PERIOD_S) >= (BURST_PERIOD_S - BURST_LENGTH_S);
+}
+
 // ====== Safe printf ======
+// 1 = เขียนลง log buffer ของ task เอง (ไม่ block, buffer เต็มทิ้งแล้วนับ) แล้ว drain task เขียนออก console
+// 0 = vprintf ใต้ xPrintMutex แบบเดิม (ทุก task ต่อคิวกัน, รอเกิน 1s แล้วหายเงียบ)
+#define USE_TASK_LOG         1
+#define LOG_LINES_PER_TASK   16
+#define LOG_DRAIN_PRIO       2      // สูงกว่า statistics (1) ให้ระบาย burst ของมันทัน, ต่ำกว่า producer
+
 static void safe_printf(const char* fmt, ...) {
     va_list args;
     va_start(args, fmt);
+#if USE_TASK_LOG
+    task_log_vprintf(fmt, args);
+#else
     if (xPrintMutex && xSemaphoreTake(xPrintMutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
         vprintf(fmt, args);
         xSemaphoreGive(xPrintMutex);
     }
+#endif
     va_end(args);
 }
 
@@ -60,6 +202,12 @@ static void producer_task(void *pvParameters) {
     product_t product;
     int product_counter = 0;
     gpio_num_t led_pin;
+#if USE_FLOW_CONTROL
+    product_t pending;
+    flow_producer_t flow;
+    flow_producer_init(&flow, &product_flow, &pending, sizeof(product_t),
+                       FLOW_BACKOFF_STEP_MS, FLOW_BACKOFF_MAX_MS);
+#endif
 
     switch (producer_id) {
         case 1: led_pin = LED_PRODUCER_1; break;
@@ -75,32 +223,47 @@ static void producer_task(void *pvParameters) {
         product.product_id = product_counter++;
         snprintf(product.product_name, sizeof(product.product_name),
                  "Product-P%d-#%d", producer_id, product.product_id);
-        product.production_tick = xTaskGetTickCount();
+        product.production_us = esp_timer_get_time();
         product.processing_time_ms = 500 + (esp_random() % 2000); // 0.5–2.5s
 
-        BaseType_t ok = xQueueSend(xProductQueue, &product, pdMS_TO_TICKS(100));
+#if USE_FLOW_CONTROL
+        uint32_t sent0 = flow.sent, shed0 = flow.shed;
+        BaseType_t ok = flow_send(&flow, &product) ? pdPASS : pdFAIL;
+        shard_stats_add(&global_stats, STAT_PRODUCED, flow.sent - sent0);
+        shard_stats_add(&global_stats, STAT_DROPPED, flow.shed - shed0);
+#else
+        BaseType_t ok = product_send(&product, pdMS_TO_TICKS(100));
+        shard_stats_inc(&global_stats, ok == pdPASS ? STAT_PRODUCED : STAT_DROPPED);
+#endif
+        shard_stats_inc(&global_stats, STAT_OFFERED);
         if (ok == pdPASS) {
-            global_stats.produced++;
             safe_printf("✓ Producer %d: Created %s (processing: %dms)\n",
                         producer_id, product.product_name, product.processing_time_ms);
             gpio_set_level(led_pin, 1);
             vTaskDelay(pdMS_TO_TICKS(50));
             gpio_set_level(led_pin, 0);
         } else {
-            global_stats.dropped++;
-            safe_printf("✗ Producer %d: Queue full! Dropped %s\n",
-                        producer_id, product.product_name);
+            safe_printf("✗ Producer %d: Queue full! %s %s\n", producer_id,
+                        USE_FLOW_CONTROL && FLOW_SHED_POLICY == FLOW_SHED_COALESCE ? "Holding" : "Dropped",
+                        product.product_name);
         }
 
         int delay_ms = 1000 + (esp_random() % 2000);
+#if BURSTY_LOAD
+        if (burst_active()) delay_ms = 200 + (esp_random() % 400);
+#endif
+#if USE_FLOW_CONTROL
+        delay_ms += flow_backoff_ms(&flow);
+#endif
         vTaskDelay(pdMS_TO_TICKS(delay_ms));
     }
 }
 
 // ====== Consumer Task ======
 static void consumer_task(void *pvParameters) {
-    int consumer_id = *((int*)pvParameters);
-    product_t product;
+    worker_t *w = (worker_t*)pvParameters;
+    int consumer_id = w->id;
+    product_t item;
     gpio_num_t led_pin;
 
     switch (consumer_id) {
@@ -112,63 +275,174 @@ static void consumer_task(void *pvParameters) {
     safe_printf("Consumer %d started\n", consumer_id);
 
     while (1) {
-        BaseType_t ok = xQueueReceive(xProductQueue, &product, pdMS_TO_TICKS(5000));
-        if (ok == pdPASS) {
-            global_stats.consumed++;
-            TickType_t now = xTaskGetTickCount();
-            uint32_t queue_time_ms = (uint32_t)((now - product.production_tick) * portTICK_PERIOD_MS);
-
-            safe_printf("→ Consumer %d: Processing %s (queue time: %lums)\n",
-                        consumer_id, product.product_name, (unsigned long)queue_time_ms);
-
-            gpio_set_level(led_pin, 1);
-            vTaskDelay(pdMS_TO_TICKS(product.processing_time_ms));
-            gpio_set_level(led_pin, 0);
+        if (!w->active) {
+            safe_printf("💤 Consumer %d: Parked\n", consumer_id);
+            while (!w->active) xSemaphoreTake(w->wake, portMAX_DELAY);
+            safe_printf("⚡ Consumer %d: Unparked\n", consumer_id);
+        }
 
-            safe_printf("✓ Consumer %d: Finished %s\n", consumer_id, product.product_name);
-        } else {
+        if (product_receive(&item, pdMS_TO_TICKS(5000)) != pdPASS) {
             safe_printf("⏰ Consumer %d: No products to process (timeout)\n", consumer_id);
+            continue;
         }
+
+        product_t *product = &item;
+        shard_stats_inc(&global_stats, STAT_CONSUMED);
+        int64_t queue_time_us = esp_timer_get_time() - product->production_us;
+        uint32_t queue_time_ms = (uint32_t)(queue_time_us / 1000);
+        lat_hist_record_since(&lat_queue, product->production_us);
+        if (product->producer_id >= 1 && product->producer_id <= LAT_PRODUCERS) {
+            lat_hist_record_since(&lat_producer[product->producer_id - 1], product->production_us);
+        }
+        qtime_ewma_update((float)queue_time_ms, SCALE_EWMA_ALPHA);
+
+        safe_printf("→ Consumer %d: Processing %s (queue time: %lums)\n",
+                    consumer_id, product->product_name, (unsigned long)queue_time_ms);
+
+        gpio_set_level(led_pin, 1);
+        vTaskDelay(pdMS_TO_TICKS(product->processing_time_ms));
+        gpio_set_level(led_pin, 0);
+
+        safe_printf("✓ Consumer %d: Finished %s\n", consumer_id, product->product_name);
+#if USE_FLOW_CONTROL
+        flow_grant(&product_flow, 1);
+#endif
     }
 }
 
 // ====== Statistics Task ======
 static void statistics_task(void *pvParameters) {
+    stats_t last = {0, 0, 0, 0};
     safe_printf("Statistics task started\n");
     while (1) {
-        UBaseType_t q_items = uxQueueMessagesWaiting(xProductQueue);
+        UBaseType_t q_items = product_backlog();
+        stats_t now = stats_read();
 
         safe_printf("\n═══ SYSTEM STATISTICS ═══\n");
-        safe_printf("Products Produced: %lu\n", (unsigned long)global_stats.produced);
-        safe_printf("Products Consumed: %lu\n", (unsigned long)global_stats.consumed);
-        safe_printf("Products Dropped:  %lu\n", (unsigned long)global_stats.dropped);
+        safe_printf("Products Produced: %lu\n", (unsigned long)now.produced);
+        safe_printf("Products Consumed: %lu\n", (unsigned long)now.consumed);
+        safe_printf("Products Dropped:  %lu\n", (unsigned long)now.dropped);
         safe_printf("Queue Backlog:     %u\n", (unsigned)q_items);
+        safe_printf("Active Consumers:  %d/%d\n", active_workers, MAX_CONSUMERS);
 
         float eff = 0.0f;
-        if (global_stats.produced > 0) {
-            eff = ((float)global_stats.consumed / (float)global_stats.produced) * 100.0f;
+        if (now.produced > 0) {
+            eff = ((float)now.consumed / (float)now.produced) * 100.0f;
         }
         safe_printf("System Efficiency: %.1f%%\n", eff);
 
-        printf("Queue: [");
-        for (int i = 0; i < 10; i++) printf(i < (int)q_items ? "■" : "□");
-        printf("]\n");
+        // goodput / drop rate ของ interval นี้
+        uint32_t d_offered = now.offered - last.offered;
+        safe_printf("Goodput:           %.2f products/s\n", (now.consumed - last.consumed) / 5.0f);
+        safe_printf("Drop Rate:         %.1f%% (%s)\n",
+                    d_offered ? 100.0f * (now.dropped - last.dropped) / d_offered : 0.0f,
+                    USE_FLOW_CONTROL ? flow_shed_name(FLOW_SHED_POLICY) : "timed drop");
+#if USE_FLOW_CONTROL
+        safe_printf("Credits:           %ld\n", (long)flow_credits(&product_flow));
+#endif
+        last = now;
+
+        // queue time ของ interval นี้ (reset หลังอ่าน)
+        lat_hist_snapshot_t snap;
+        safe_printf("Queue Time (ms)     n     p50     p99     max\n");
+        lat_hist_snapshot(&lat_queue, &snap, true);
+        safe_printf("  all          %5lu %7.1f %7.1f %7.1f\n", (unsigned long)snap.count,
+                    snap.p50_us / 1000.0, snap.p99_us / 1000.0, snap.max_us / 1000.0);
+        for (int i = 0; i < LAT_PRODUCERS; i++) {
+            lat_hist_snapshot(&lat_producer[i], &snap, true);
+            safe_printf("  producer %d   %5lu %7.1f %7.1f %7.1f\n", i + 1, (unsigned long)snap.count,
+                        snap.p50_us / 1000.0, snap.p99_us / 1000.0, snap.max_us / 1000.0);
+        }
+
+#if USE_TASK_LOG
+        task_log_stats_t ls;
+        task_log_get_stats(&ls);
+        safe_printf("Log Lines:         %lu written, %lu dropped\n",
+                    (unsigned long)ls.written, (unsigned long)ls.dropped);
+#endif
+
+        // ■ / □ ตัวละ 3 byte (UTF-8)
+        char bar[16 * 3 + 1];
+        int pos = 0;
+        for (int i = 0; i < (int)product_capacity() && pos + 3 < (int)sizeof(bar); i++) {
+            memcpy(bar + pos, i < (int)q_items ? "■" : "□", 3);
+            pos += 3;
+        }
+        bar[pos] = '\0';
+        safe_printf("Queue: [%s]\n", bar);
         safe_printf("═══════════════════════════\n\n");
 
         vTaskDelay(pdMS_TO_TICKS(5000));
     }
 }
 
-// ====== Load Balancer ======
+// ====== Load Balancer (elastic pool controller) ======
+static void unpark_one(void) {
+    for (int i = 0; i < MAX_CONSUMERS; i++) {
+        if (!workers[i].active) {
+            workers[i].active = true;
+            xSemaphoreGive(workers[i].wake);
+            active_workers++;
+            return;
+        }
+    }
+}
+
+// จอดตัวที่ index สูงสุด; มันจะจอดจริงหลังทำ product ที่ถืออยู่เสร็จ (หรือ receive timeout)
+// เพราะเช็ค active ก่อนรับชิ้นถัดไปเท่านั้น
+static void park_one(void) {
+    for (int i = MAX_CONSUMERS - 1; i >= MIN_CONSUMERS; i--) {
+        if (workers[i].active) {
+            workers[i].active = false;
+            active_workers--;
+            return;
+        }
+    }
+}
+
 static void load_balancer_task(void *pvParameters) {
     const int HIGH_LOAD_THRESHOLD = 8;
-    safe_printf("Load balancer started\n");
+    float depth_ewma = 0.0f;
+    int cooldown = 0, calm = 0;
+    uint32_t sample = 0;
+    TickType_t t0 = xTaskGetTickCount();
+
+    safe_printf("Load balancer started (elastic pool %d..%d consumers)\n", MIN_CONSUMERS, MAX_CONSUMERS);
+    safe_printf("series,<t_ms>,<workers>,<backlog>,<depth_ewma>,<qtime_ewma_ms>,<dropped>\n");
 
     while (1) {
-        UBaseType_t q_items = uxQueueMessagesWaiting(xProductQueue);
-        if (q_items > HIGH_LOAD_THRESHOLD) {
-            safe_printf("⚠️  HIGH LOAD DETECTED! Queue size: %u\n", (unsigned)q_items);
-            safe_printf("💡 Suggestion: Add more consumers or optimize processing\n");
+        UBaseType_t q_items = product_backlog();
+        depth_ewma += SCALE_EWMA_ALPHA * ((float)q_items - depth_ewma);
+        // ไม่มีของให้วัด queue time -> ให้ค่าเฉลี่ยค่อย ๆ ลดลงเอง
+        if (q_items == 0) qtime_ewma_update(0.0f, SCALE_EWMA_ALPHA);    // ไม่มีใครรอ -> ลดเข้าหา 0
+        float qtime = qtime_ewma_read();
+
+        bool high = depth_ewma > SCALE_UP_DEPTH || qtime > SCALE_UP_QTIME_MS;
+        bool low  = depth_ewma < SCALE_DOWN_DEPTH && qtime < SCALE_DOWN_QTIME_MS;
+        if (cooldown > 0) cooldown--;
+
+        if (high) {
+            calm = 0;
+            if (cooldown == 0 && active_workers < MAX_CONSUMERS) {
+                unpark_one();
+                cooldown = SCALE_UP_COOLDOWN;
+                safe_printf("📈 Scale up → %d consumers (depth %.1f, qtime %.0fms)\n",
+                            active_workers, depth_ewma, qtime);
+            }
+        } else if (low) {
+            if (++calm >= SCALE_DOWN_HOLD && active_workers > MIN_CONSUMERS) {
+                park_one();
+                calm = 0;
+                safe_printf("📉 Scale down → %d consumers (depth %.1f, qtime %.0fms)\n",
+                            active_workers, depth_ewma, qtime);
+            }
+        } else {
+            calm = 0;
+        }
+
+        if (q_items > HIGH_LOAD_THRESHOLD && active_workers == MAX_CONSUMERS) {
+            safe_printf("⚠️  HIGH LOAD DETECTED! Queue size: %u (all %d consumers active)\n",
+                        (unsigned)q_items, MAX_CONSUMERS);
 
             gpio_set_level(LED_PRODUCER_1, 1);
             gpio_set_level(LED_PRODUCER_2, 1);
@@ -176,7 +450,7 @@ static void load_balancer_task(void *pvParameters) {
             gpio_set_level(LED_CONSUMER_1, 1);
             gpio_set_level(LED_CONSUMER_2, 1);
 
-            vTaskDelay(pdMS_TO_TICKS(200));  // ✅ แก้บรรทัดแตกบรรทัดผิด
+            vTaskDelay(pdMS_TO_TICKS(200));
 
             gpio_set_level(LED_PRODUCER_1, 0);
             gpio_set_level(LED_PRODUCER_2, 0);
@@ -184,7 +458,14 @@ static void load_balancer_task(void *pvParameters) {
             gpio_set_level(LED_CONSUMER_1, 0);
             gpio_set_level(LED_CONSUMER_2, 0);
         }
-        vTaskDelay(pdMS_TO_TICKS(1000));
+
+        if (++sample % SERIES_EVERY == 0) {
+            safe_printf("series,%lu,%d,%u,%.2f,%.0f,%lu\n",
+                        (unsigned long)((xTaskGetTickCount() - t0) * portTICK_PERIOD_MS),
+                        active_workers, (unsigned)q_items, depth_ewma, qtime,
+                        (unsigned long)shard_stats_sum(&global_stats, STAT_DROPPED));
+        }
+        vTaskDelay(pdMS_TO_TICKS(SCALE_SAMPLE_MS));
     }
 }
 
@@ -216,22 +497,34 @@ void app_main(void) {
 
     init_led_pins();
 
-    xProductQueue = xQueueCreate(10, sizeof(product_t));
+#if USE_MPMC_QUEUE
+    bool queue_ok = mpmc_queue_create(&xProductMpmc, sizeof(product_t), PRODUCT_QUEUE_DEPTH);
+#else
+    xProductQueue = xQueueCreate(PRODUCT_QUEUE_DEPTH, sizeof(product_t));
+    bool queue_ok = xProductQueue != NULL;
+#endif
     xPrintMutex   = xSemaphoreCreateMutex();
+#if USE_TASK_LOG
+    queue_ok = queue_ok && task_log_init(LOG_LINES_PER_TASK, LOG_DRAIN_PRIO);
+#endif
 
-    if (!xProductQueue || !xPrintMutex) {
+    if (!queue_ok || !xPrintMutex) {
         ESP_LOGE(TAG, "Failed to create queue or mutex!");
         return;
     }
     ESP_LOGI(TAG, "Queue and mutex created successfully");
 
+#if USE_FLOW_CONTROL
+    flow_ctl_init(&product_flow, NULL, product_try_send, product_try_evict,
+                  (int32_t)product_capacity(), FLOW_SHED_POLICY);
+#endif
+    shard_stats_init(&global_stats);
+    lat_hist_init(&lat_queue);
+    for (int i = 0; i < LAT_PRODUCERS; i++) lat_hist_init(&lat_producer[i]);
+
     // ==== IDs ต้องเป็น static ====
     static int producer1_id = 1, producer2_id = 2, producer3_id = 3;
     static int producer4_id = 4;   // ✅ เพิ่ม Producer #4
-    static int consumer1_id = 1, consumer2_id = 2;
-
-    // ใช้ consumer2_id แบบ no-op เพื่อปิด warning เมื่อยังไม่สร้าง Consumer2
-    (void)consumer2_id;            // ✅ ปิด warning unused-variable
 
     // ==== Producers (prio 3) ====
     xTaskCreate(producer_task, "Producer1", 3072, &producer1_id, 3, NULL);
@@ -239,13 +532,24 @@ void app_main(void) {
     xTaskCreate(producer_task, "Producer3", 3072, &producer3_id, 3, NULL);
     xTaskCreate(producer_task, "Producer4", 3072, &producer4_id, 3, NULL); // ✅ เพิ่ม Producer #4
 
-    // ==== Consumers (prio 2) ====
-    xTaskCreate(consumer_task, "Consumer1", 3072, &consumer1_id, 2, NULL);
-    // xTaskCreate(consumer_task, "Consumer2", 3072, &consumer2_id, 2, NULL); // ✅ ปิด Consumer #2 ตามใบงาน
+    // ==== Consumers (prio 2): สร้างครบ pool, เริ่มทำงานแค่ MIN_CONSUMERS ตัว ====
+    for (int i = 0; i < MAX_CONSUMERS; i++) {
+        char name[16];
+        workers[i].id = i + 1;
+        workers[i].active = (i < MIN_CONSUMERS);
+        workers[i].wake = xSemaphoreCreateBinary();
+        if (!workers[i].wake) {
+            ESP_LOGE(TAG, "Failed to create consumer pool semaphore");
+            return;
+        }
+        snprintf(name, sizeof(name), "Consumer%d", i + 1);
+        xTaskCreate(consumer_task, name, 3072, &workers[i], 2, NULL);
+    }
+    active_workers = MIN_CONSUMERS;
 
     // ==== Monitoring (prio 1) ====
     xTaskCreate(statistics_task, "Statistics", 3072, NULL, 1, NULL);
-    xTaskCreate(load_balancer_task, "LoadBalancer", 2048, NULL, 1, NULL);
+    xTaskCreate(load_balancer_task, "LoadBalancer", 3072, NULL, 1, NULL);   // printf float + line buffer ของ task_log
 
-    ESP_LOGI(TAG, "All tasks created. System operational. (P=4, C=1)");
+    ESP_LOGI(TAG, "All tasks created. System operational. (P=4, C=%d..%d)", MIN_CONSUMERS, MAX_CONSUMERS);
 }
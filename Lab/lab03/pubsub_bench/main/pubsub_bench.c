@@ -0,0 +1,197 @@
+// main/pubsub_bench.c — fan-out cost: copy ต่อ subscriber vs pub/sub แบบ ref count
+//
+// publisher 1 ตัวส่ง BENCH_MSGS ข้อความไปหา subscriber 1..8 ตัว (pinned core เดียวกัน, priority เท่ากัน)
+//   copy   = xQueueSend struct ทั้งก้อนลงคิวของ subscriber ทีละตัว (วิธีเดียวที่มีถ้าไม่มี broker)
+//   pubsub = pubsub_alloc + pubsub_publish ครั้งเดียว ทุกตัวได้ pointer เดียวกัน, ตัวสุดท้าย release คืนพูล
+// ทุก task อยู่ core เดียว -> เวลารวม / ข้อความ = ต้นทุน CPU ต่อ publish รวมฝั่งรับครบทุก subscriber
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "pubsub.h"
+
+static const char *TAG = "PUBSUB_BENCH";
+
+// ===== Config =====
+#define BENCH_MSGS      5000
+#define QUEUE_DEPTH     8
+#define MAX_SUBS        8
+// ข้อความที่ยังไม่ถูก release ครบ: backlog ของ subscriber ที่ช้าสุด + ที่ถืออยู่ + ที่ publisher จอง
+#define POOL_MSGS       (QUEUE_DEPTH + 2)
+#define BENCH_CORE      1
+#define BENCH_PRIO      5
+#define MAX_PAYLOAD     124
+
+// 12 = user_input_t, 60 = queue_message_t, 124 = network_message_t
+static const size_t PAYLOAD_SIZES[] = { 12, 60, 124 };
+#define SIZE_COUNT (sizeof(PAYLOAD_SIZES) / sizeof(PAYLOAD_SIZES[0]))
+
+typedef enum { MODE_COPY = 0, MODE_PUBSUB, MODE_COUNT } bench_mode_t;
+static const char* const MODE_NAMES[MODE_COUNT] = { "copy", "pubsub" };
+
+typedef struct {
+    bench_mode_t     mode;
+    size_t           size;
+    int              subs;
+    QueueHandle_t    q[MAX_SUBS];           // copy: คิวของแต่ละ subscriber / pubsub: คิวที่ subscribe ได้
+    pubsub_broker_t  broker;
+    int              topic;
+    TaskHandle_t     notify;
+    _Atomic uint32_t done;
+    _Atomic uint32_t errors;
+} bench_ctx_t;
+
+typedef struct {
+    double   msgs_per_s;
+    double   us_per_msg;
+    uint64_t bytes_copied;
+    uint32_t errors;
+} bench_result_t;
+
+static bench_ctx_t ctx;
+static uint8_t tx_buf[MAX_PAYLOAD];
+static uint8_t rx_buf[MAX_SUBS][MAX_PAYLOAD];
+
+// ===== Publisher / Subscribers =====
+static void publisher_task(void *pv) {
+    for (uint32_t i = 0; i < BENCH_MSGS; i++) {
+        if (ctx.mode == MODE_COPY) {
+            memset(tx_buf, (int)(i & 0xFF), ctx.size);
+            for (int s = 0; s < ctx.subs; s++) xQueueSend(ctx.q[s], tx_buf, portMAX_DELAY);
+        } else {
+            void* msg = pubsub_alloc(&ctx.broker, portMAX_DELAY);
+            memset(msg, (int)(i & 0xFF), ctx.size);
+            pubsub_publish(&ctx.broker, ctx.topic, msg, portMAX_DELAY);
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+static void subscriber_task(void *pv) {
+    int id = (int)(intptr_t)pv;
+    for (uint32_t i = 0; i < BENCH_MSGS; i++) {
+        const uint8_t* p;
+        void* msg = NULL;
+        if (ctx.mode == MODE_COPY) {
+            xQueueReceive(ctx.q[id], rx_buf[id], portMAX_DELAY);
+            p = rx_buf[id];
+        } else {
+            msg = pubsub_receive(ctx.q[id], portMAX_DELAY);
+            p = msg;
+        }
+        // แตะหัว/ท้าย payload ให้เหมือนการใช้งานจริง
+        if (p[0] != (uint8_t)i || p[ctx.size - 1] != (uint8_t)i) atomic_fetch_add(&ctx.errors, 1);
+        if (msg) pubsub_release(&ctx.broker, msg);
+    }
+    if (atomic_fetch_add(&ctx.done, 1) + 1 == (uint32_t)ctx.subs) xTaskNotifyGive(ctx.notify);
+    vTaskDelete(NULL);
+}
+
+// ===== Runner =====
+static void teardown(void) {
+    if (ctx.mode == MODE_COPY) {
+        for (int s = 0; s < ctx.subs; s++) if (ctx.q[s]) vQueueDelete(ctx.q[s]);
+    } else {
+        pubsub_destroy(&ctx.broker);        // ลบคิวของ subscriber ให้ด้วย
+    }
+}
+
+static bool run_one(bench_mode_t mode, size_t size, int subs, bench_result_t* r) {
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.mode = mode;
+    ctx.size = size;
+    ctx.subs = subs;
+    ctx.notify = xTaskGetCurrentTaskHandle();
+
+    bool ok = true;
+    if (mode == MODE_COPY) {
+        for (int s = 0; s < subs; s++) ok &= (ctx.q[s] = xQueueCreate(QUEUE_DEPTH, size)) != NULL;
+    } else {
+        ok = pubsub_create(&ctx.broker, size, POOL_MSGS);
+        ctx.topic = ok ? pubsub_topic(&ctx.broker, "bench") : -1;
+        for (int s = 0; ok && s < subs; s++) {
+            ok &= (ctx.q[s] = pubsub_subscribe(&ctx.broker, ctx.topic, QUEUE_DEPTH)) != NULL;
+        }
+    }
+    if (!ok) {
+        teardown();
+        return false;
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    for (int s = 0; s < subs; s++) {
+        xTaskCreatePinnedToCore(subscriber_task, "ps_sub", 3072, (void*)(intptr_t)s, BENCH_PRIO, NULL, BENCH_CORE);
+    }
+    xTaskCreatePinnedToCore(publisher_task, "ps_pub", 3072, NULL, BENCH_PRIO, NULL, BENCH_CORE);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t dt = esp_timer_get_time() - t0;
+
+    r->msgs_per_s = dt > 0 ? (double)BENCH_MSGS * 1e6 / (double)dt : 0.0;
+    r->us_per_msg = (double)dt / BENCH_MSGS;
+    r->bytes_copied = (uint64_t)BENCH_MSGS *
+        (mode == MODE_COPY ? 2 * size * (size_t)subs : pubsub_bytes_copied_per_publish((uint8_t)subs));
+    r->errors = atomic_load(&ctx.errors);
+    if (mode == MODE_PUBSUB) {
+        r->errors += atomic_load(&ctx.broker.bad_release);
+        vTaskDelay(pdMS_TO_TICKS(10));
+        if (pubsub_in_use(&ctx.broker) != 0) r->errors++;       // ข้อความรั่ว (ref ไม่ครบ)
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(10));      // ให้ publisher/subscriber ลบตัวเองเสร็จ
+    teardown();
+    return true;
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "Fan-out benchmark: copy per subscriber vs pub/sub (ref counted)");
+    ESP_LOGI(TAG, "%u msgs per run, depth %u, pool %u, core %u, prio %u",
+             BENCH_MSGS, QUEUE_DEPTH, POOL_MSGS, BENCH_CORE, BENCH_PRIO);
+
+    static bench_result_t res[SIZE_COUNT][MAX_SUBS][MODE_COUNT];
+    memset(res, 0, sizeof(res));
+
+    for (size_t s = 0; s < SIZE_COUNT; s++) {
+        for (int n = 1; n <= MAX_SUBS; n++) {
+            for (int m = 0; m < MODE_COUNT; m++) {
+                if (!run_one((bench_mode_t)m, PAYLOAD_SIZES[s], n, &res[s][n - 1][m])) {
+                    ESP_LOGE(TAG, "%s %u B x%d: setup failed", MODE_NAMES[m], (unsigned)PAYLOAD_SIZES[s], n);
+                }
+            }
+        }
+    }
+
+    for (size_t s = 0; s < SIZE_COUNT; s++) {
+        printf("\n=== fan-out %u B payload (%u msgs) ===\n", (unsigned)PAYLOAD_SIZES[s], BENCH_MSGS);
+        printf("%4s %12s %12s %10s %10s %14s %14s %8s\n",
+               "subs", "copy msg/s", "ps msg/s", "copy us", "ps us", "copy copied", "ps copied", "speedup");
+        for (int n = 1; n <= MAX_SUBS; n++) {
+            const bench_result_t* cp = &res[s][n - 1][MODE_COPY];
+            const bench_result_t* ps = &res[s][n - 1][MODE_PUBSUB];
+            printf("%4d %12.0f %12.0f %10.2f %10.2f %14llu %14llu %7.2fx\n",
+                   n, cp->msgs_per_s, ps->msgs_per_s, cp->us_per_msg, ps->us_per_msg,
+                   (unsigned long long)cp->bytes_copied, (unsigned long long)ps->bytes_copied,
+                   cp->msgs_per_s > 0 ? ps->msgs_per_s / cp->msgs_per_s : 0.0);
+            if (cp->errors || ps->errors) {
+                ESP_LOGW(TAG, "%u B x%d: errors copy=%lu pubsub=%lu", (unsigned)PAYLOAD_SIZES[s], n,
+                         (unsigned long)cp->errors, (unsigned long)ps->errors);
+            }
+        }
+    }
+    // summary,<mode>,<payload>,<subs>,<msgs/s>,<us_per_msg>,<bytes_copied>,<errors>
+    for (size_t s = 0; s < SIZE_COUNT; s++) {
+        for (int n = 1; n <= MAX_SUBS; n++) {
+            for (int m = 0; m < MODE_COUNT; m++) {
+                const bench_result_t* r = &res[s][n - 1][m];
+                printf("summary,%s,%u,%d,%.0f,%.2f,%llu,%lu\n", MODE_NAMES[m], (unsigned)PAYLOAD_SIZES[s], n,
+                       r->msgs_per_s, r->us_per_msg, (unsigned long long)r->bytes_copied,
+                       (unsigned long)r->errors);
+            }
+        }
+    }
+    ESP_LOGI(TAG, "Benchmark done");
+}
@@ -0,0 +1,176 @@
+// main/queue_batch_bench.c — รับทีละชิ้น vs batch receive ภายใต้ burst
+//
+// generator ยิงข้อความเป็นชุดแบบ load_generator_task (counting_semaphores.c):
+//   ทุก BURST_PERIOD_MS -> BURST_ROUNDS รอบ, รอบละ BURST_ITEMS ชิ้นติดกัน, เว้น ROUND_GAP_MS
+//   ส่งแบบไม่รอ (timeout 0) เหมือน network_task -> คิวเต็มคือ drop
+// consumer priority สูงกว่า generator (แบบ processor_task ใน queue_sets.c)
+// และมีต้นทุนต่อการตื่น 1 ครั้ง (LED/log/delay) + ต้นทุนต่อชิ้น
+// เทียบ batch size 1 / 4 / 8: จำนวนครั้งที่ consumer ตื่น, context switch โดยประมาณ, goodput, drop
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "queue_batch.h"
+
+static const char *TAG = "BATCH_BENCH";
+
+// ===== Config =====
+#define QUEUE_DEPTH       8         // เท่า network queue
+#define BURSTS            20
+#define BURST_ROUNDS      3
+#define BURST_ITEMS       6         // MAX_RESOURCES + 3
+#define ROUND_GAP_MS      70
+#define BURST_PERIOD_MS   400
+#define WAKE_OVERHEAD_MS  20        // ต้นทุนต่อการตื่น (blink/log) -> block จริง
+#define ITEM_COST_US      300       // ต้นทุนต่อชิ้น (busy)
+#define GEN_PRIO          3
+#define CONSUMER_PRIO     4
+#define MAX_BATCH         8
+
+static const UBaseType_t BATCH_SIZES[] = { 1, 4, 8 };
+#define MODE_COUNT (sizeof(BATCH_SIZES) / sizeof(BATCH_SIZES[0]))
+
+// ขนาดเดียวกับ network_message_t ใน queue_sets.c (124 B)
+typedef struct {
+    int64_t t_sent_us;
+    char    payload[116];
+} bench_msg_t;
+
+typedef struct {
+    QueueHandle_t q;
+    UBaseType_t   batch;
+    volatile bool gen_done;
+    TaskHandle_t  notify;
+    uint32_t      sent;
+    uint32_t      dropped;
+    uint32_t      processed;
+    uint32_t      wakeups;          // รอบที่ consumer ได้ของ (1 รอบ = 1 batch)
+    uint32_t      blocking_waits;   // receive ที่ต้อง block เพราะคิวว่าง
+    uint64_t      latency_sum_us;
+    int64_t       latency_max_us;
+    int64_t       t_start_us;
+    int64_t       t_end_us;
+} bench_ctx_t;
+
+typedef struct {
+    uint32_t sent, dropped, processed, wakeups;
+    uint32_t ctx_switches_est;      // ค่าประมาณ ไม่ได้วัด: ทุกการ block (รอคิว/delay) = สลับออก + สลับกลับ
+    double   goodput;
+    double   avg_latency_ms;
+    double   max_latency_ms;
+} bench_result_t;
+
+static bench_ctx_t ctx;
+
+// ===== Generator (load_generator style bursts) =====
+static void generator_task(void *pv) {
+    bench_msg_t m;
+    memset(&m, 0, sizeof(m));
+    TickType_t last = xTaskGetTickCount();
+    for (int b = 0; b < BURSTS; b++) {
+        for (int r = 0; r < BURST_ROUNDS; r++) {
+            for (int i = 0; i < BURST_ITEMS; i++) {
+                m.t_sent_us = esp_timer_get_time();
+                if (xQueueSend(ctx.q, &m, 0) == pdPASS) ctx.sent++;
+                else                                    ctx.dropped++;
+            }
+            vTaskDelay(pdMS_TO_TICKS(ROUND_GAP_MS));
+        }
+        vTaskDelayUntil(&last, pdMS_TO_TICKS(BURST_PERIOD_MS));
+    }
+    ctx.gen_done = true;                // consumer เห็นภายใน timeout 100 ms แล้วออก
+    vTaskDelete(NULL);
+}
+
+// ===== Consumer =====
+static void consumer_task(void *pv) {
+    static bench_msg_t batch[MAX_BATCH];
+    while (1) {
+        if (uxQueueMessagesWaiting(ctx.q) == 0) {
+            if (ctx.gen_done) break;
+            ctx.blocking_waits++;
+        }
+        UBaseType_t got = queue_receive_batch(ctx.q, batch, sizeof(bench_msg_t), ctx.batch,
+                                              pdMS_TO_TICKS(100));
+        if (got == 0) continue;
+
+        ctx.wakeups++;
+        int64_t now = esp_timer_get_time();
+        for (UBaseType_t i = 0; i < got; i++) {
+            int64_t lat = now - batch[i].t_sent_us;
+            ctx.latency_sum_us += (uint64_t)lat;
+            if (lat > ctx.latency_max_us) ctx.latency_max_us = lat;
+            esp_rom_delay_us(ITEM_COST_US);
+        }
+        ctx.processed += got;
+        vTaskDelay(pdMS_TO_TICKS(WAKE_OVERHEAD_MS));
+    }
+    ctx.t_end_us = esp_timer_get_time();
+    xTaskNotifyGive(ctx.notify);
+    vTaskDelete(NULL);
+}
+
+// ===== Runner =====
+static bool run_one(UBaseType_t batch, bench_result_t* r) {
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.batch = batch;
+    ctx.notify = xTaskGetCurrentTaskHandle();
+    ctx.q = xQueueCreate(QUEUE_DEPTH, sizeof(bench_msg_t));
+    if (!ctx.q) return false;
+
+    ctx.t_start_us = esp_timer_get_time();
+    xTaskCreate(consumer_task, "bb_cons", 3072, NULL, CONSUMER_PRIO, NULL);
+    xTaskCreate(generator_task, "bb_gen", 3072, NULL, GEN_PRIO, NULL);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    double secs = (double)(ctx.t_end_us - ctx.t_start_us) / 1e6;
+    r->sent = ctx.sent;
+    r->dropped = ctx.dropped;
+    r->processed = ctx.processed;
+    r->wakeups = ctx.wakeups;
+    r->ctx_switches_est = 2 * (ctx.blocking_waits + ctx.wakeups);
+    r->goodput = secs > 0 ? (double)ctx.processed / secs : 0.0;
+    r->avg_latency_ms = ctx.processed ? (double)ctx.latency_sum_us / ctx.processed / 1000.0 : 0.0;
+    r->max_latency_ms = (double)ctx.latency_max_us / 1000.0;
+
+    vTaskDelay(pdMS_TO_TICKS(20));
+    vQueueDelete(ctx.q);
+    return true;
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "Batch receive under bursts: %d bursts x %d rounds x %d items, depth %d",
+             BURSTS, BURST_ROUNDS, BURST_ITEMS, QUEUE_DEPTH);
+
+    bench_result_t res[MODE_COUNT];
+    memset(res, 0, sizeof(res));
+    for (size_t m = 0; m < MODE_COUNT; m++) {
+        if (!run_one(BATCH_SIZES[m], &res[m])) ESP_LOGE(TAG, "batch %u: setup failed", (unsigned)BATCH_SIZES[m]);
+    }
+
+    // ctx est = 2 x (การ block รอคิว + การตื่น) ไม่ใช่จำนวน context switch ที่วัดจริง
+    printf("\n%5s %6s %6s %6s %8s %8s %9s %9s %8s %8s\n",
+           "batch", "sent", "drop", "done", "wakeups", "ctx est", "est/item", "goodput", "avg ms", "max ms");
+    for (size_t m = 0; m < MODE_COUNT; m++) {
+        const bench_result_t* r = &res[m];
+        printf("%5u %6lu %6lu %6lu %8lu %8lu %9.2f %9.1f %8.1f %8.1f\n",
+               (unsigned)BATCH_SIZES[m], (unsigned long)r->sent, (unsigned long)r->dropped,
+               (unsigned long)r->processed, (unsigned long)r->wakeups, (unsigned long)r->ctx_switches_est,
+               r->processed ? (double)r->ctx_switches_est / r->processed : 0.0,
+               r->goodput, r->avg_latency_ms, r->max_latency_ms);
+    }
+    // summary,<batch>,<sent>,<dropped>,<processed>,<wakeups>,<ctx_switches_est>,<goodput>,<avg_ms>,<max_ms>
+    for (size_t m = 0; m < MODE_COUNT; m++) {
+        const bench_result_t* r = &res[m];
+        printf("summary,%u,%lu,%lu,%lu,%lu,%lu,%.1f,%.1f,%.1f\n", (unsigned)BATCH_SIZES[m],
+               (unsigned long)r->sent, (unsigned long)r->dropped, (unsigned long)r->processed,
+               (unsigned long)r->wakeups, (unsigned long)r->ctx_switches_est,
+               r->goodput, r->avg_latency_ms, r->max_latency_ms);
+    }
+    ESP_LOGI(TAG, "Benchmark done");
+}
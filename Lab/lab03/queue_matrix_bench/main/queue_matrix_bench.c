@@ -0,0 +1,207 @@
+// main/queue_matrix_bench.c — FreeRTOS queue throughput/latency matrix (target = linux)
+//
+//   idf.py --preview set-target linux
+//   idf.py build
+//   ./build/queue_matrix_bench.elf > queue_matrix.csv
+//
+// stdout = CSV ล้วน (header + 1 แถวต่อชุด), ตารางอ่านง่ายกับ log ออก stderr
+// กวาดค่าที่ lab03 ใช้จริง:
+//   depth      1 / 5 / 8 / 32       (รับทีละชิ้น, basic_queue, network queue, คิวใหญ่)
+//   item       8 / 60 / 124 B       (timestamp, queue_message_t, network_message_t)
+//   P x C      1x1 / 1x4 / 4x1 / 4x4
+//   priority   producer สูงกว่า / เท่ากัน / ต่ำกว่า consumer
+// รายงาน msgs/s และ latency ส่ง -> รับ p50/p90/p99/max ต่อชุด
+// รันแบบ headless จบแล้ว exit(0)
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+
+static const char *TAG = "QMATRIX";
+
+// ===== Config =====
+#define BENCH_MSGS      5000
+#define BASE_PRIO       5
+#define MAX_ITEM        124
+
+static const UBaseType_t DEPTHS[]     = { 1, 5, 8, 32 };
+static const uint32_t    ITEM_SIZES[] = { 8, 60, 124 };
+
+typedef struct {
+    int producers;
+    int consumers;
+} shape_t;
+
+static const shape_t SHAPES[] = { { 1, 1 }, { 1, 4 }, { 4, 1 }, { 4, 4 } };
+
+typedef struct {
+    const char* name;
+    int         producer_delta;         // + = producer priority สูงกว่า consumer
+} prio_mode_t;
+
+static const prio_mode_t PRIO_MODES[] = {
+    { "prod>cons",  1 },
+    { "equal",      0 },
+    { "prod<cons", -1 },
+};
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+typedef struct {
+    QueueHandle_t    q;
+    int              producers;
+    int              consumers;
+    TaskHandle_t     notify;
+    _Atomic uint32_t claimed;           // consumer จองลำดับก่อนรับ -> รู้ว่าเมื่อไรหยุด + ช่องเก็บ latency
+    _Atomic uint32_t done;
+    uint32_t*        lat_ns;            // BENCH_MSGS ช่อง
+} bench_ctx_t;
+
+typedef struct {
+    double   msgs_per_s;
+    uint32_t p50_ns;
+    uint32_t p90_ns;
+    uint32_t p99_ns;
+    uint32_t max_ns;
+} bench_result_t;
+
+static bench_ctx_t ctx;
+
+// ใช้ clock ของ host ตรง ๆ (ns) เพราะ esp_timer ละเอียดแค่ μs
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// ===== Producer / Consumer =====
+// 8 byte แรกของ item คือเวลาส่ง (ns)
+static void producer_task(void *pv) {
+    int id = (int)(intptr_t)pv;
+    uint32_t quota = BENCH_MSGS / ctx.producers + (id < (int)(BENCH_MSGS % ctx.producers) ? 1 : 0);
+    uint8_t item[MAX_ITEM];
+    memset(item, id, sizeof(item));
+
+    for (uint32_t i = 0; i < quota; i++) {
+        uint64_t t = now_ns();
+        memcpy(item, &t, sizeof(t));
+        xQueueSend(ctx.q, item, portMAX_DELAY);
+    }
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *pv) {
+    uint8_t item[MAX_ITEM];
+    uint32_t slot;
+    while ((slot = atomic_fetch_add(&ctx.claimed, 1)) < BENCH_MSGS) {
+        xQueueReceive(ctx.q, item, portMAX_DELAY);
+        uint64_t t;
+        memcpy(&t, item, sizeof(t));
+        uint64_t lat = now_ns() - t;
+        ctx.lat_ns[slot] = lat > UINT32_MAX ? UINT32_MAX : (uint32_t)lat;
+    }
+    if (atomic_fetch_add(&ctx.done, 1) + 1 == (uint32_t)ctx.consumers) {
+        xTaskNotifyGive(ctx.notify);
+    }
+    vTaskDelete(NULL);
+}
+
+// ===== Runner =====
+static bool run_one(UBaseType_t depth, uint32_t item_size, const shape_t* sh, const prio_mode_t* pm,
+                    uint32_t* lat, bench_result_t* r) {
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.producers = sh->producers;
+    ctx.consumers = sh->consumers;
+    ctx.notify = xTaskGetCurrentTaskHandle();
+    ctx.lat_ns = lat;
+    ctx.q = xQueueCreate(depth, item_size);
+    if (!ctx.q) return false;
+
+    UBaseType_t cons_prio = BASE_PRIO;
+    UBaseType_t prod_prio = (UBaseType_t)(BASE_PRIO + pm->producer_delta);
+
+    uint64_t t0 = now_ns();
+    for (int c = 0; c < sh->consumers; c++) {
+        xTaskCreate(consumer_task, "qm_cons", 4096, NULL, cons_prio, NULL);
+    }
+    for (int p = 0; p < sh->producers; p++) {
+        xTaskCreate(producer_task, "qm_prod", 4096, (void*)(intptr_t)p, prod_prio, NULL);
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint64_t dt = now_ns() - t0;
+
+    qsort(lat, BENCH_MSGS, sizeof(uint32_t), cmp_u32);
+    r->msgs_per_s = dt > 0 ? (double)BENCH_MSGS * 1e9 / (double)dt : 0.0;
+    r->p50_ns = lat[BENCH_MSGS / 2];
+    r->p90_ns = lat[(uint32_t)(BENCH_MSGS * 0.90)];
+    r->p99_ns = lat[(uint32_t)(BENCH_MSGS * 0.99)];
+    r->max_ns = lat[BENCH_MSGS - 1];
+
+    vTaskDelay(pdMS_TO_TICKS(20));      // ให้ task ลบตัวเองเสร็จ
+    vQueueDelete(ctx.q);
+    return true;
+}
+
+// ESP_LOG ปกติออก stdout -> ย้ายไป stderr ไม่ให้ปนกับ CSV
+static int log_to_stderr(const char* fmt, va_list args) {
+    return vfprintf(stderr, fmt, args);
+}
+
+void app_main(void)
+{
+    esp_log_set_vprintf(log_to_stderr);
+    ESP_LOGI(TAG, "FreeRTOS queue matrix: %u msgs per point, %u points", BENCH_MSGS,
+             (unsigned)(COUNT_OF(DEPTHS) * COUNT_OF(ITEM_SIZES) * COUNT_OF(SHAPES) * COUNT_OF(PRIO_MODES)));
+
+    uint32_t* lat = malloc(BENCH_MSGS * sizeof(uint32_t));
+    if (!lat) {
+        ESP_LOGE(TAG, "out of memory");
+        exit(1);
+    }
+
+    fprintf(stderr, "\n%5s %5s %3s %3s %-10s %12s %9s %9s %9s %10s\n",
+            "depth", "item", "P", "C", "prio", "msgs/s", "p50 us", "p90 us", "p99 us", "max us");
+    printf("depth,item,producers,consumers,prio,msgs_per_s,p50_us,p90_us,p99_us,max_us\n");
+    for (size_t d = 0; d < COUNT_OF(DEPTHS); d++) {
+        for (size_t s = 0; s < COUNT_OF(ITEM_SIZES); s++) {
+            for (size_t sh = 0; sh < COUNT_OF(SHAPES); sh++) {
+                for (size_t pm = 0; pm < COUNT_OF(PRIO_MODES); pm++) {
+                    bench_result_t r;
+                    memset(&r, 0, sizeof(r));
+                    if (!run_one(DEPTHS[d], ITEM_SIZES[s], &SHAPES[sh], &PRIO_MODES[pm], lat, &r)) {
+                        ESP_LOGE(TAG, "depth %u item %u: queue create failed",
+                                 (unsigned)DEPTHS[d], (unsigned)ITEM_SIZES[s]);
+                        continue;
+                    }
+                    fprintf(stderr, "%5u %5u %3d %3d %-10s %12.0f %9.1f %9.1f %9.1f %10.1f\n",
+                            (unsigned)DEPTHS[d], (unsigned)ITEM_SIZES[s], SHAPES[sh].producers,
+                            SHAPES[sh].consumers, PRIO_MODES[pm].name, r.msgs_per_s,
+                            r.p50_ns / 1000.0, r.p90_ns / 1000.0, r.p99_ns / 1000.0, r.max_ns / 1000.0);
+                    printf("%u,%u,%d,%d,%s,%.0f,%.1f,%.1f,%.1f,%.1f\n",
+                           (unsigned)DEPTHS[d], (unsigned)ITEM_SIZES[s], SHAPES[sh].producers,
+                           SHAPES[sh].consumers, PRIO_MODES[pm].name, r.msgs_per_s,
+                           r.p50_ns / 1000.0, r.p90_ns / 1000.0, r.p99_ns / 1000.0, r.max_ns / 1000.0);
+                }
+            }
+        }
+    }
+
+    free(lat);
+    ESP_LOGI(TAG, "Benchmark done");
+    fflush(stdout);
+    exit(0);
+}
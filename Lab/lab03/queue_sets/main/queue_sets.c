@@ -12,7 +12,18 @@
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_random.h"      // จำเป็นสำหรับ esp_random() บน IDF v5.5+
+#include "esp_timer.h"
 #include "driver/gpio.h"
+#include "flow_ctl.h"
+#include "prio_queue.h"
+#include "lat_hist.h"
+#include "event_dispatch.h"
+#include "queue_telemetry.h"
+#include "shard_stats.h"
+#include "mailbox.h"
+#include "win_agg.h"
+#include "pubsub.h"
+#include "sensor_pack.h"
 
 static const char *TAG = "QUEUE_SETS_EXP3";
 
@@ -25,29 +36,48 @@ static const char *TAG = "QUEUE_SETS_EXP3";
 
 // ===== Handles =====
 static QueueHandle_t     xSensorQueue    = NULL;
+static mailbox_t         xSensorBox;
+static QueueSetMemberHandle_t xSensorMember  = NULL;   // handle ของ sensor ใน queue set
 static QueueHandle_t     xUserQueue      = NULL;
 static QueueHandle_t     xNetworkQueue   = NULL;
+static prio_queue_t      xNetworkPrio;
+static QueueSetMemberHandle_t xNetworkMember = NULL;   // handle ของ network ใน queue set
 static SemaphoreHandle_t xTimerSemaphore = NULL;
 static QueueSetHandle_t  xQueueSet       = NULL;
 
+// ===== Queue telemetry =====
+// นับทุก send/receive แทนการ poll ทุก 15s (burst ระหว่าง poll ไม่หาย)
+static queue_telemetry_t tel_sensor;
+static queue_telemetry_t tel_user;
+static queue_telemetry_t tel_network;
+
 // ===== Data structs =====
+// ค่า sensor แบบ fixed-point x10 (sensor_pack): 56 byte ต่อข้อความแทน 96
+// rec.dt_ticks อ้างอิง history ฝั่ง sensor (mailbox ทับค่าได้ -> processor ใช้แค่ id/T/H + t_sent_us)
 typedef struct {
-    int      sensor_id;
-    float    temperature;
-    float    humidity;
-    uint32_t timestamp;
+    sensor_rec_t       rec;
+    int64_t            t_sent_us;       // esp_timer ตอนส่ง (service latency)
+    // USE_SENSOR_WINDOW: ส่งเฉพาะตอนหน้าต่างปิด/ข้ามเกณฑ์, rec = ค่าล่าสุด
+    uint8_t            temp_events;     // WIN_AGG_*
+    uint8_t            hum_events;
+    sensor_pack_stat_t temp_tumbling;
+    sensor_pack_stat_t temp_sliding;
+    sensor_pack_stat_t hum_tumbling;
+    sensor_pack_stat_t hum_sliding;
 } sensor_data_t;
 
 typedef struct {
     int      button_id;
     bool     pressed;
     uint32_t duration_ms;
+    int64_t  t_sent_us;
 } user_input_t;
 
 typedef struct {
-    char source[20];
-    char message[100];
-    int  priority;
+    char    source[20];
+    char    message[100];
+    int     priority;
+    int64_t t_sent_us;          // esp_timer ตอนส่ง (วัด latency ต่อ priority)
 } network_message_t;
 
 typedef struct {
@@ -55,10 +85,237 @@ typedef struct {
     uint32_t user_count;
     uint32_t network_count;
     uint32_t timer_count;
+    uint32_t network_offered;   // ข้อความที่ network_task สร้าง
     uint32_t network_dropped;   // สำหรับคิวเต็ม
+    uint32_t processor_wakeups; // รอบที่ processor ได้ของจริง (1 รอบ = ระบายทุก source)
 } message_stats_t;
 
-static message_stats_t stats = {0};
+// ===== Dispatcher =====
+// processor ตื่นครั้งเดียวแล้ว select แบบไม่รอต่อจน set ว่าง: 1 handle = รับ 1 ชิ้นจาก member นั้น
+static event_dispatcher_t dispatcher;
+static volatile int64_t   timer_given_us = 0;   // timer ไม่มี payload -> จำเวลาที่ give ไว้ที่นี่
+
+// producer 4 ตัว + processor เพิ่มค่าจากสอง core -> นับลง shard ต่อ core แล้วรวมตอนอ่าน
+enum {
+    STAT_SENSOR, STAT_USER, STAT_NETWORK, STAT_TIMER,
+    STAT_NET_OFFERED, STAT_NET_DROPPED, STAT_WAKEUPS, STAT_COUNT
+};
+
+static shard_stats_t stats;
+
+static message_stats_t stats_read(void) {
+    uint32_t v[STAT_COUNT];
+    shard_stats_read(&stats, v, STAT_COUNT);
+    return (message_stats_t){
+        .sensor_count      = v[STAT_SENSOR],
+        .user_count        = v[STAT_USER],
+        .network_count     = v[STAT_NETWORK],
+        .timer_count       = v[STAT_TIMER],
+        .network_offered   = v[STAT_NET_OFFERED],
+        .network_dropped   = v[STAT_NET_DROPPED],
+        .processor_wakeups = v[STAT_WAKEUPS],
+    };
+}
+
+// ===== Network flow control =====
+// 1 = processor คืน credit หลังประมวลผล batch, network_task ชะลอตัวเองเมื่อ credit หมด
+//     และจัดการข้อความที่ส่งไม่ได้ตาม NET_SHED_POLICY; 0 = ส่งแบบไม่รอแล้ว drop เหมือนเดิม
+#define USE_FLOW_CONTROL      1
+#define NET_SHED_POLICY       FLOW_SHED_DROP_OLDEST
+#define NET_QUEUE_LEN         8
+#define NET_BACKOFF_STEP_MS   250
+#define NET_BACKOFF_MAX_MS    4000
+
+static flow_ctl_t net_flow;
+
+// ===== Network queue =====
+// 1 = priority queue (P5 ออกก่อน, drop-oldest ไล่ตัว priority ต่ำสุด), 0 = xQueue FIFO เดิม
+#define USE_PRIO_QUEUE        1
+#define NET_PRIO_LEVELS       5
+
+static lat_hist_t net_latency[NET_PRIO_LEVELS];   // ส่ง -> processor หยิบ, แยกตาม priority
+
+static BaseType_t net_send(const network_message_t* m, TickType_t wait) {
+    queue_telemetry_op_t op = queue_telemetry_begin_send(&tel_network);
+#if USE_PRIO_QUEUE
+    BaseType_t ok = prio_queue_send(&xNetworkPrio, m, (uint8_t)m->priority, wait);
+#else
+    BaseType_t ok = xQueueSend(xNetworkQueue, m, wait);
+#endif
+    queue_telemetry_end_send(&tel_network, op, ok == pdPASS);
+    return ok;
+}
+
+static BaseType_t net_receive(network_message_t* out, TickType_t wait) {
+    queue_telemetry_op_t op = queue_telemetry_begin_receive(&tel_network);
+#if USE_PRIO_QUEUE
+    BaseType_t ok = prio_queue_receive(&xNetworkPrio, out, wait);
+#else
+    BaseType_t ok = xQueueReceive(xNetworkQueue, out, wait);
+#endif
+    queue_telemetry_end_receive(&tel_network, op, ok == pdPASS ? 1 : 0);
+    return ok;
+}
+
+static UBaseType_t net_backlog(void) {
+#if USE_PRIO_QUEUE
+    return prio_queue_count(&xNetworkPrio);
+#else
+    return uxQueueMessagesWaiting(xNetworkQueue);
+#endif
+}
+
+static UBaseType_t net_count(void* q) { return net_backlog(); }
+
+static bool net_try_send(void* q, void* item) { return net_send(item, 0) == pdPASS; }
+
+// ===== Sensor windowing =====
+// 1 = sensor_task รวมตัวอย่างเป็นหน้าต่างก่อนส่ง: processor ตื่นเฉพาะตอนหน้าต่างปิดหรือข้ามเกณฑ์
+// 0 = ส่งทุกตัวอย่าง (processor ตื่น + log + เช็คเกณฑ์ทุกครั้ง)
+#define USE_SENSOR_WINDOW     1
+#define SENSOR_SAMPLE_MIN_MS  2000      // ช่วงสุ่มตัวอย่าง MIN..MIN+SPAN (ลดลงเพื่อเทียบ wakeups/s ตอนโหลดสูง)
+#define SENSOR_SAMPLE_SPAN_MS 3000
+#define SENSOR_WINDOW_MS      10000     // tumbling
+#define SENSOR_SLIDE_PANES    6         // sliding = 6 x 10 s ล่าสุด
+#define TEMP_HIGH_C           35.0f
+#define TEMP_CLEAR_C          34.0f     // hysteresis
+#define HUM_HIGH_PCT          60.0f
+#define HUM_CLEAR_PCT         58.0f
+
+static win_agg_t temp_win;
+static win_agg_t hum_win;
+
+// ===== Sensor history =====
+// ทุกตัวอย่าง (รวมที่ถูกพับเข้าหน้าต่าง) เก็บเป็น sensor_rec_t 8 byte, เวลาเป็น delta tick
+// 128 record = 1 KB (แบบ int + float + float + tick 16 byte จะได้แค่ 64 ใน 1 KB)
+#define SENSOR_HISTORY_LEN    128
+
+static sensor_rec_t  sensor_hist_buf[SENSOR_HISTORY_LEN];
+static sensor_hist_t sensor_hist;
+static portMUX_TYPE  sensor_hist_lock = portMUX_INITIALIZER_UNLOCKED;   // sensor เขียน, monitor อ่าน
+
+static void pack_window(const win_agg_t* w, bool sliding, sensor_pack_stat_t* out) {
+    win_stat_t st;
+    if (sliding) win_agg_sliding(w, &st);
+    else         win_agg_tumbling(w, &st);
+    sensor_pack_stat(st.min, st.max, st.mean, st.count, out);
+}
+
+// ===== Sensor channel =====
+// 1 = mailbox ค่าล่าสุด: processor ได้ T/H ใหม่สุดเสมอ ค่าเก่าถูกทับแทนการต่อคิว (O(1), ไม่มี backlog)
+// 0 = xQueue 5 ช่องแบบเดิม
+// mailbox ใช้ได้เฉพาะตอนส่งค่าดิบทุกตัวอย่าง (USE_SENSOR_WINDOW 0): windowing ส่งเป็นเหตุการณ์
+// (หน้าต่างปิด/RISE/FALL) ซึ่งเกิดครั้งเดียว ถ้าถูกทับก่อน processor หยิบจะหายไปเลย -> ต้องต่อคิว
+// ค่าเริ่มต้นเปิด windowing อยู่ จึงปิด mailbox; จะลอง mailbox ให้ตั้ง USE_SENSOR_WINDOW 0 ด้วย
+#define USE_SENSOR_MAILBOX    0
+#define SENSOR_QUEUE_LEN      5
+#define SENSOR_SET_SLOTS      (USE_SENSOR_MAILBOX ? 1 : SENSOR_QUEUE_LEN)
+
+#if USE_SENSOR_MAILBOX && USE_SENSOR_WINDOW
+#error "USE_SENSOR_MAILBOX needs USE_SENSOR_WINDOW 0: window events must be queued, not overwritten"
+#endif
+
+static BaseType_t sensor_send(const sensor_data_t* d, TickType_t wait) {
+#if USE_SENSOR_MAILBOX
+    // "full" ใน telemetry = ค่าก่อนหน้ายังไม่ถูกหยิบแล้วโดนทับ
+    queue_telemetry_op_t op = queue_telemetry_begin_send(&tel_sensor);
+    mailbox_write(&xSensorBox, d);
+    queue_telemetry_end_send(&tel_sensor, op, 1);
+    return pdPASS;
+#else
+    return queue_telemetry_send(&tel_sensor, d, wait);
+#endif
+}
+
+static BaseType_t sensor_receive(sensor_data_t* out) {
+    queue_telemetry_op_t op = queue_telemetry_begin_receive(&tel_sensor);
+#if USE_SENSOR_MAILBOX
+    BaseType_t ok = mailbox_receive(&xSensorBox, out, 0);
+#else
+    BaseType_t ok = xQueueReceive(xSensorQueue, out, 0);
+#endif
+    queue_telemetry_end_receive(&tel_sensor, op, ok == pdPASS ? 1 : 0);
+    return ok;
+}
+
+static UBaseType_t sensor_count(void* q) {
+#if USE_SENSOR_MAILBOX
+    return mailbox_pending(&xSensorBox) ? 1 : 0;
+#else
+    return uxQueueMessagesWaiting(xSensorQueue);
+#endif
+}
+
+// ===== User events: pub/sub =====
+// 1 = user_input_task publish ลง topic "user" ครั้งเดียว, processor กับ UsageLog ได้ pointer ของข้อความเดียวกัน
+//     (ref count คืนพูลเมื่อทั้งสองฝั่ง release, ไม่ copy ต่อ subscriber) เพิ่ม consumer = subscribe อีกคิว
+// 0 = xQueue ตรงถึง processor แบบเดิม
+#define USE_PUBSUB            1
+#define USER_QUEUE_LEN        3
+#define USER_SUBSCRIBERS      2
+// ref ที่ subscriber ถือค้างได้พร้อมกัน: handle_user / usage_log_task รับทีละชิ้นแล้ว release ก่อนรับชิ้นถัดไป
+// (ถ้าเปลี่ยนเป็นรับทีละหลายชิ้นต้องเพิ่มค่านี้ตามจำนวนที่ถือได้ ไม่งั้น publisher รอ pubsub_alloc ค้าง)
+#define USER_HELD_PER_SUB     1
+// ข้อความที่ยังมีชีวิตได้พร้อมกัน: ค้างในคิวแต่ละ subscriber + ที่ subscriber ถืออยู่ + ที่ publisher จองไว้
+#define USER_POOL_MSGS        (USER_SUBSCRIBERS * (USER_QUEUE_LEN + USER_HELD_PER_SUB) + 1)
+
+static pubsub_broker_t broker;
+static int             topic_user  = -1;
+static QueueHandle_t   xUsageQueue = NULL;      // subscriber ตัวที่สองของ "user"
+
+static BaseType_t user_send(const user_input_t* u, TickType_t wait) {
+#if USE_PUBSUB
+    queue_telemetry_op_t op = queue_telemetry_begin_send(&tel_user);
+    user_input_t* m = pubsub_alloc(&broker, wait);
+    uint8_t delivered = 0;
+    if (m) {
+        *m = *u;
+        delivered = pubsub_publish(&broker, topic_user, m, wait);
+    }
+    queue_telemetry_end_send(&tel_user, op, delivered ? 1 : 0);
+    return delivered ? pdPASS : pdFAIL;
+#else
+    return queue_telemetry_send(&tel_user, u, wait);
+#endif
+}
+
+// ได้ pointer กลับไปทั้งสองแบบ -> handle_user ใช้โค้ดเดียวกัน แล้ว user_release เมื่อเสร็จ
+static const user_input_t* user_receive(void) {
+    queue_telemetry_op_t op = queue_telemetry_begin_receive(&tel_user);
+#if USE_PUBSUB
+    const user_input_t* u = pubsub_receive(xUserQueue, 0);
+#else
+    static user_input_t copy;
+    const user_input_t* u = xQueueReceive(xUserQueue, &copy, 0) == pdPASS ? &copy : NULL;
+#endif
+    queue_telemetry_end_receive(&tel_user, op, u ? 1 : 0);
+    return u;
+}
+
+static inline void user_release(const user_input_t* u) {
+#if USE_PUBSUB
+    pubsub_release(&broker, (void*)u);
+#else
+    (void)u;
+#endif
+}
+
+// ===== Queue set sizing =====
+// select 1 ครั้ง = รับ 1 ชิ้น -> handle ใน set ไม่เกินของที่ค้างอยู่ในสมาชิกจริง (รวมความจุ)
+// ยกเว้น drop-oldest ที่ไล่ชิ้นออกจากคิว network นอก select: เผื่อที่ให้ handle ค้างแยกไว้ NET_QUEUE_LEN ช่อง
+#define QUEUE_SET_MEMBER_SLOTS  (SENSOR_SET_SLOTS + USER_QUEUE_LEN + NET_QUEUE_LEN + 1)
+#define QUEUE_SET_LEN           (QUEUE_SET_MEMBER_SLOTS + NET_QUEUE_LEN)
+
+// ชิ้นที่ถูกไล่ออกนอก select ทิ้ง handle ค้างไว้ใน set 1 อัน -> ไล่ได้เฉพาะตอนที่ set ยังมีที่ว่าง
+// เกินความจุรวมของสมาชิก (ที่เหลือไว้ให้ handle ค้างโดยเฉพาะ) ไม่งั้นตกไปเป็น drop newest
+static bool net_try_evict(void* q, void* item) {
+    if (uxQueueSpacesAvailable((QueueHandle_t)xQueueSet) <= QUEUE_SET_MEMBER_SLOTS) return false;
+#if USE_PRIO_QUEUE
+    return prio_queue_evict_lowest(&xNetworkPrio, item) == pdPASS;
+#else
+    return xQueueReceive(xNetworkQueue, item, 0) == pdPASS;
+#endif
+}
 
 static inline void blink_led(gpio_num_t pin, TickType_t ms)
 {
@@ -70,20 +327,40 @@ static inline void blink_led(gpio_num_t pin, TickType_t ms)
 // ======== Producers ========
 static void sensor_task(void *pvParameters)
 {
-    sensor_data_t d; int sensor_id = 1;
+    sensor_data_t d; sensor_sample_t s; int sensor_id = 1;
+    memset(&d, 0, sizeof(d));
     ESP_LOGI(TAG, "Sensor task started");
     while (1) {
-        d.sensor_id   = sensor_id;
-        d.temperature = 20.0f + (float)(esp_random() % 200) / 10.0f;  // 20.0–40.0
-        d.humidity    = 30.0f + (float)(esp_random() % 400) / 10.0f;  // 30.0–70.0
-        d.timestamp   = xTaskGetTickCount();
-
-        if (xQueueSend(xSensorQueue, &d, pdMS_TO_TICKS(50)) == pdPASS) {
+        s.sensor_id   = sensor_id;
+        s.temperature = 20.0f + (float)(esp_random() % 200) / 10.0f;  // 20.0–40.0
+        s.humidity    = 30.0f + (float)(esp_random() % 400) / 10.0f;  // 30.0–70.0
+        s.timestamp   = xTaskGetTickCount();
+        d.t_sent_us   = esp_timer_get_time();
+
+        // encode ครั้งเดียว: record เดียวกันลง history และลงข้อความ
+        portENTER_CRITICAL(&sensor_hist_lock);
+        sensor_hist_append(&sensor_hist, &s, &d.rec);
+        portEXIT_CRITICAL(&sensor_hist_lock);
+
+#if USE_SENSOR_WINDOW
+        d.temp_events = (uint8_t)win_agg_add(&temp_win, s.temperature, d.t_sent_us);
+        d.hum_events  = (uint8_t)win_agg_add(&hum_win, s.humidity, d.t_sent_us);
+        if (d.temp_events == 0 && d.hum_events == 0) {
+            // แค่พับเข้าหน้าต่าง ไม่ปลุก processor
+            vTaskDelay(pdMS_TO_TICKS(SENSOR_SAMPLE_MIN_MS + (esp_random() % SENSOR_SAMPLE_SPAN_MS)));
+            continue;
+        }
+        pack_window(&temp_win, false, &d.temp_tumbling);
+        pack_window(&temp_win, true,  &d.temp_sliding);
+        pack_window(&hum_win,  false, &d.hum_tumbling);
+        pack_window(&hum_win,  true,  &d.hum_sliding);
+#endif
+        if (sensor_send(&d, pdMS_TO_TICKS(50)) == pdPASS) {
             ESP_LOGI(TAG, "📊 Sensor: T=%.1f°C, H=%.1f%%, ID=%d",
-                     d.temperature, d.humidity, sensor_id);
+                     sensor_rec_temp(&d.rec), sensor_rec_hum(&d.rec), sensor_id);
             blink_led(LED_SENSOR, 40);
         }
-        vTaskDelay(pdMS_TO_TICKS(2000 + (esp_random() % 3000))); // 2–5s
+        vTaskDelay(pdMS_TO_TICKS(SENSOR_SAMPLE_MIN_MS + (esp_random() % SENSOR_SAMPLE_SPAN_MS))); // 2–5s
     }
 }
 
@@ -95,8 +372,9 @@ static void user_input_task(void *pvParameters)
         u.button_id   = 1 + (esp_random() % 3);
         u.pressed     = true;
         u.duration_ms = 100 + (esp_random() % 1000);
-        if (xQueueSend(xUserQueue, &u, pdMS_TO_TICKS(50)) == pdPASS) {
-            ESP_LOGI(TAG, "🔘 User: Button %d pressed for %dms", u.button_id, u.duration_ms);
+        u.t_sent_us   = esp_timer_get_time();
+        if (user_send(&u, pdMS_TO_TICKS(50)) == pdPASS) {
+            ESP_LOGI(TAG, "🔘 User: Button %d pressed for %lums", u.button_id, (unsigned long)u.duration_ms);
             blink_led(LED_USER, 80);
         }
         vTaskDelay(pdMS_TO_TICKS(3000 + (esp_random() % 5000))); // 3–8s
@@ -109,6 +387,12 @@ static void user_input_task(void *pvParameters)
 static void network_task(void *pvParameters)
 {
     network_message_t m;
+#if USE_FLOW_CONTROL
+    network_message_t pending;
+    flow_producer_t flow;
+    flow_producer_init(&flow, &net_flow, &pending, sizeof(pending),
+                       NET_BACKOFF_STEP_MS, NET_BACKOFF_MAX_MS);
+#endif
     const char* sources[]  = {"WiFi", "Bluetooth", "LoRa", "Ethernet"};
     const char* messages[] = {
         "Status update received","Configuration changed","Alert notification",
@@ -122,16 +406,29 @@ static void network_task(void *pvParameters)
         strncpy(m.message, messages[esp_random() % 5], sizeof(m.message) - 1);
         m.message[sizeof(m.message) - 1] = '\0';
         m.priority = 1 + (esp_random() % 5);
-
-        if (xQueueSend(xNetworkQueue, &m, 0) == pdPASS) {       // ไม่รอคิว เพื่อเน้น throughput
+        m.t_sent_us = esp_timer_get_time();
+
+        shard_stats_inc(&stats, STAT_NET_OFFERED);
+#if USE_FLOW_CONTROL
+        uint32_t shed0 = flow.shed;
+        bool ok = flow_send(&flow, &m);
+        shard_stats_add(&stats, STAT_NET_DROPPED, flow.shed - shed0);
+#else
+        bool ok = net_send(&m, 0) == pdPASS;                    // ไม่รอคิว เพื่อเน้น throughput
+        if (!ok) shard_stats_inc(&stats, STAT_NET_DROPPED);
+#endif
+        if (ok) {
             ESP_LOGI(TAG, "🌐 Network [%s]: %s (P:%d)", m.source, m.message, m.priority);
             blink_led(LED_NETWORK, 30);
         } else {
-            stats.network_dropped++;
             ESP_LOGW(TAG, "⚠️ Network queue full (dropped=%lu)",
-                     (unsigned long)stats.network_dropped);
+                     (unsigned long)shard_stats_sum(&stats, STAT_NET_DROPPED));
         }
+#if USE_FLOW_CONTROL
+        vTaskDelay(pdMS_TO_TICKS(NETWORK_PERIOD_MS + flow_backoff_ms(&flow)));
+#else
         vTaskDelay(pdMS_TO_TICKS(NETWORK_PERIOD_MS));           // ทุก 500 ms
+#endif
     }
 }
 
@@ -140,6 +437,7 @@ static void timer_task(void *pvParameters)
     ESP_LOGI(TAG, "Timer task started");
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(10000)); // ทุก 10 วินาที
+        timer_given_us = esp_timer_get_time();
         if (xSemaphoreGive(xTimerSemaphore) == pdPASS) {
             ESP_LOGI(TAG, "⏰ Timer: Periodic timer fired");
             blink_led(LED_TIMER, 80);
@@ -147,77 +445,183 @@ static void timer_task(void *pvParameters)
     }
 }
 
-// ======== Processor (Queue Sets) ========
+// ======== Processor (Queue Sets + dispatcher) ========
+static bool handle_sensor(event_source_t* src)
+{
+    sensor_data_t s;
+    if (sensor_receive(&s) != pdPASS) return false;
+    lat_hist_record_since(&src->latency, s.t_sent_us);
+    shard_stats_inc(&stats, STAT_SENSOR);
+#if USE_SENSOR_WINDOW
+    const sensor_data_t* w = &s;
+    if (w->temp_events & WIN_AGG_WINDOW) {
+        ESP_LOGI(TAG, "→ SENSOR %ds: T %.1f/%.1f/%.1f°C H %.1f/%.1f/%.1f%% (n=%lu) | %ds avg: T %.1f°C H %.1f%%",
+                 SENSOR_WINDOW_MS / 1000,
+                 sensor_pack_f10(w->temp_tumbling.min), sensor_pack_f10(w->temp_tumbling.mean),
+                 sensor_pack_f10(w->temp_tumbling.max),
+                 sensor_pack_f10(w->hum_tumbling.min), sensor_pack_f10(w->hum_tumbling.mean),
+                 sensor_pack_f10(w->hum_tumbling.max),
+                 (unsigned long)w->temp_tumbling.count,
+                 SENSOR_WINDOW_MS * SENSOR_SLIDE_PANES / 1000,
+                 sensor_pack_f10(w->temp_sliding.mean), sensor_pack_f10(w->hum_sliding.mean));
+    }
+    if (w->temp_events & WIN_AGG_RISE) ESP_LOGW(TAG, "⚠️ High temperature! (%.1f°C)", sensor_rec_temp(&w->rec));
+    if (w->temp_events & WIN_AGG_FALL) ESP_LOGI(TAG, "✓ Temperature back below %.1f°C", TEMP_CLEAR_C);
+    if (w->hum_events  & WIN_AGG_RISE) ESP_LOGW(TAG, "⚠️ High humidity! (%.1f%%)", sensor_rec_hum(&w->rec));
+    if (w->hum_events  & WIN_AGG_FALL) ESP_LOGI(TAG, "✓ Humidity back below %.1f%%", HUM_CLEAR_PCT);
+#else
+    float t = sensor_rec_temp(&s.rec), h = sensor_rec_hum(&s.rec);
+    ESP_LOGI(TAG, "→ SENSOR: T=%.1f°C, H=%.1f%%", t, h);
+    if (t > TEMP_HIGH_C)  ESP_LOGW(TAG, "⚠️ High temperature!");
+    if (h > HUM_HIGH_PCT) ESP_LOGW(TAG, "⚠️ High humidity!");
+#endif
+    return true;
+}
+
+static bool handle_user(event_source_t* src)
+{
+    const user_input_t* u = user_receive();
+    if (!u) return false;
+    lat_hist_record_since(&src->latency, u->t_sent_us);
+    shard_stats_inc(&stats, STAT_USER);
+    ESP_LOGI(TAG, "→ USER: Button %d (%lums)", u->button_id, (unsigned long)u->duration_ms);
+    switch (u->button_id) {
+        case 1: ESP_LOGI(TAG, "💡 Action: Toggle LED"); break;
+        case 2: ESP_LOGI(TAG, "📊 Action: Show status"); break;
+        case 3: ESP_LOGI(TAG, "⚙️ Action: Settings menu"); break;
+    }
+    user_release(u);
+    return true;
+}
+
+static bool handle_network(event_source_t* src)
+{
+    static network_message_t n;
+    if (net_receive(&n, 0) != pdPASS) return false;
+    lat_hist_record_since(&src->latency, n.t_sent_us);
+    shard_stats_inc(&stats, STAT_NETWORK);
+    if (n.priority >= 1 && n.priority <= NET_PRIO_LEVELS) {
+        lat_hist_record_since(&net_latency[n.priority - 1], n.t_sent_us);
+    }
+    ESP_LOGI(TAG, "→ NETWORK: [%s] %s (P:%d)", n.source, n.message, n.priority);
+    if (n.priority >= 4) ESP_LOGW(TAG, "🚨 High priority network message!");
+#if USE_FLOW_CONTROL
+    flow_grant(&net_flow, 1);                   // คืน credit เมื่อทำเสร็จ
+#endif
+    return true;
+}
+
+static bool handle_timer(event_source_t* src)
+{
+    if (xSemaphoreTake(xTimerSemaphore, 0) != pdPASS) return false;
+    lat_hist_record_since(&src->latency, timer_given_us);
+    shard_stats_inc(&stats, STAT_TIMER);
+    message_stats_t now = stats_read();
+    ESP_LOGI(TAG, "→ TIMER: Periodic maintenance");
+    ESP_LOGI(TAG, "📈 Stats - Sensor:%lu, User:%lu, Network:%lu, Timer:%lu | NetDropped:%lu",
+             (unsigned long)now.sensor_count,
+             (unsigned long)now.user_count,
+             (unsigned long)now.network_count,
+             (unsigned long)now.timer_count,
+             (unsigned long)now.network_dropped);
+    return true;
+}
+
 static void processor_task(void *pvParameters)
 {
-    QueueSetMemberHandle_t m;
-    sensor_data_t s; user_input_t u; network_message_t n;
+    int led = 0;
 
     ESP_LOGI(TAG, "Processor task started - waiting for events...");
     while (1) {
-        m = xQueueSelectFromSet(xQueueSet, portMAX_DELAY);
-        if (!m) continue;
-
-        gpio_set_level(LED_PROCESSOR, 1);
-
-        if (m == xSensorQueue) {
-            if (xQueueReceive(xSensorQueue, &s, 0) == pdPASS) {
-                stats.sensor_count++;
-                ESP_LOGI(TAG, "→ SENSOR: T=%.1f°C, H=%.1f%%", s.temperature, s.humidity);
-                if (s.temperature > 35.0f) ESP_LOGW(TAG, "⚠️ High temperature!");
-                if (s.humidity    > 60.0f) ESP_LOGW(TAG, "⚠️ High humidity!");
-            }
-        } else if (m == xUserQueue) {
-            if (xQueueReceive(xUserQueue, &u, 0) == pdPASS) {
-                stats.user_count++;
-                ESP_LOGI(TAG, "→ USER: Button %d (%dms)", u.button_id, u.duration_ms);
-                switch (u.button_id) {
-                    case 1: ESP_LOGI(TAG, "💡 Action: Toggle LED"); break;
-                    case 2: ESP_LOGI(TAG, "📊 Action: Show status"); break;
-                    case 3: ESP_LOGI(TAG, "⚙️ Action: Settings menu"); break;
-                }
-            }
-        } else if (m == xNetworkQueue) {
-            if (xQueueReceive(xNetworkQueue, &n, 0) == pdPASS) {
-                stats.network_count++;
-                ESP_LOGI(TAG, "→ NETWORK: [%s] %s (P:%d)", n.source, n.message, n.priority);
-                if (n.priority >= 4) ESP_LOGW(TAG, "🚨 High priority network message!");
-            }
-        } else if (m == xTimerSemaphore) {
-            if (xSemaphoreTake(xTimerSemaphore, 0) == pdPASS) {
-                stats.timer_count++;
-                ESP_LOGI(TAG, "→ TIMER: Periodic maintenance");
-                ESP_LOGI(TAG, "📈 Stats - Sensor:%lu, User:%lu, Network:%lu, Timer:%lu | NetDropped:%lu",
-                         (unsigned long)stats.sensor_count,
-                         (unsigned long)stats.user_count,
-                         (unsigned long)stats.network_count,
-                         (unsigned long)stats.timer_count,
-                         (unsigned long)stats.network_dropped);
-            }
-        }
+        // ไม่มี delay ต่อ event แล้ว: ตื่นมาทำทุกชิ้นที่ค้างใน set จนว่าง แล้วกลับไป select
+        if (event_dispatch_run_once(&dispatcher, portMAX_DELAY) == 0) continue;   // handle ค้าง
+        shard_stats_inc(&stats, STAT_WAKEUPS);
+        led ^= 1;
+        gpio_set_level(LED_PROCESSOR, led);
+    }
+}
+
+#if USE_PUBSUB
+// ======== Usage log (subscriber ตัวที่สองของ "user") ========
+// นับจำนวนครั้ง/เวลากดรวมต่อปุ่ม โดยไม่ต้องแตะ producer หรือ processor
+static uint32_t usage_presses[4];
+static uint32_t usage_ms[4];
 
-        // เวลาประมวลผล
-        vTaskDelay(pdMS_TO_TICKS(200));
-        gpio_set_level(LED_PROCESSOR, 0);
+static void usage_log_task(void *pvParameters)
+{
+    while (1) {
+        const user_input_t* u = pubsub_receive(xUsageQueue, portMAX_DELAY);
+        if (!u) continue;
+        if (u->button_id >= 1 && u->button_id <= 3) {
+            usage_presses[u->button_id]++;
+            usage_ms[u->button_id] += u->duration_ms;
+        }
+        pubsub_release(&broker, (void*)u);
     }
 }
+#endif
 
 // ======== Monitor ========
 static void monitor_task(void *pvParameters)
 {
+    message_stats_t last = {0};
     ESP_LOGI(TAG, "System monitor started");
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(15000));
+        message_stats_t now = stats_read();
+        uint32_t d_offered = now.network_offered - last.network_offered;
         ESP_LOGI(TAG, "\n═══ SYSTEM MONITOR (Network fast) ═══");
-        ESP_LOGI(TAG, "  Sensor Queue:  %u/5", (unsigned)uxQueueMessagesWaiting(xSensorQueue));
-        ESP_LOGI(TAG, "  User Queue:    %u/3", (unsigned)uxQueueMessagesWaiting(xUserQueue));
-        ESP_LOGI(TAG, "  Network Queue: %u/8", (unsigned)uxQueueMessagesWaiting(xNetworkQueue));
-        ESP_LOGI(TAG, "Stats → Sensor:%lu User:%lu Network:%lu Timer:%lu | NetDropped:%lu\n",
-                 (unsigned long)stats.sensor_count,
-                 (unsigned long)stats.user_count,
-                 (unsigned long)stats.network_count,
-                 (unsigned long)stats.timer_count,
-                 (unsigned long)stats.network_dropped);
+        queue_telemetry_dump(TAG, 15.0f);
+#if USE_SENSOR_WINDOW
+        ESP_LOGI(TAG, "  Sensor windows: samples=%lu windows=%lu crossings T/H=%lu/%lu",
+                 (unsigned long)temp_win.samples, (unsigned long)temp_win.windows,
+                 (unsigned long)temp_win.crossings, (unsigned long)hum_win.crossings);
+#endif
+        portENTER_CRITICAL(&sensor_hist_lock);
+        uint16_t hist_n    = sensor_hist.count;
+        uint32_t hist_span = sensor_hist_span_ticks(&sensor_hist);
+        uint32_t hist_gaps = sensor_hist.gaps;
+        portEXIT_CRITICAL(&sensor_hist_lock);
+        ESP_LOGI(TAG, "  Sensor history: %u/%u records in %lu B (%lu/KB, unpacked %lu/KB) span %.0fs gaps=%lu",
+                 (unsigned)hist_n, (unsigned)SENSOR_HISTORY_LEN, (unsigned long)sensor_hist_bytes(&sensor_hist),
+                 (unsigned long)sensor_pack_records_per_kb(sizeof(sensor_rec_t)),
+                 (unsigned long)sensor_pack_records_per_kb(sizeof(sensor_sample_t)),
+                 hist_span * portTICK_PERIOD_MS / 1000.0f, (unsigned long)hist_gaps);
+#if USE_PUBSUB
+        const pubsub_topic_t* ut = &broker.topics[topic_user];
+        ESP_LOGI(TAG, "  User pub/sub: published=%lu delivered=%lu dropped=%lu pool=%u/%u | presses B1/B2/B3=%lu/%lu/%lu (%lu/%lu/%lu ms)",
+                 (unsigned long)atomic_load(&ut->published), (unsigned long)atomic_load(&ut->delivered),
+                 (unsigned long)atomic_load(&ut->dropped),
+                 (unsigned)pubsub_in_use(&broker), (unsigned)broker.msg_count,
+                 (unsigned long)usage_presses[1], (unsigned long)usage_presses[2], (unsigned long)usage_presses[3],
+                 (unsigned long)usage_ms[1], (unsigned long)usage_ms[2], (unsigned long)usage_ms[3]);
+#endif
+#if USE_SENSOR_MAILBOX
+        ESP_LOGI(TAG, "  Sensor mailbox: writes=%lu overwritten=%lu read retries=%lu",
+                 (unsigned long)atomic_load(&xSensorBox.writes),
+                 (unsigned long)atomic_load(&xSensorBox.overwrites),
+                 (unsigned long)atomic_load(&xSensorBox.read_retries));
+#endif
+        ESP_LOGI(TAG, "Stats → Sensor:%lu User:%lu Network:%lu Timer:%lu | NetDropped:%lu | Wakeups:%lu\n",
+                 (unsigned long)now.sensor_count,
+                 (unsigned long)now.user_count,
+                 (unsigned long)now.network_count,
+                 (unsigned long)now.timer_count,
+                 (unsigned long)now.network_dropped,
+                 (unsigned long)now.processor_wakeups);
+        ESP_LOGI(TAG, "Network goodput: %.2f msg/s | drop rate: %.1f%% (%s)\n",
+                 (now.network_count - last.network_count) / 15.0f,
+                 d_offered ? 100.0f * (now.network_dropped - last.network_dropped) / d_offered : 0.0f,
+                 USE_FLOW_CONTROL ? flow_shed_name(NET_SHED_POLICY) : "drop on full");
+        event_dispatch_log(&dispatcher, TAG, 15.0f);
+        for (int p = NET_PRIO_LEVELS; p >= 1; p--) {
+            lat_hist_snapshot_t snap;
+            lat_hist_snapshot(&net_latency[p - 1], &snap, true);
+            ESP_LOGI(TAG, "  Network P%d latency: n=%lu p50=%.1fms p99=%.1fms max=%.1fms", p,
+                     (unsigned long)snap.count, snap.p50_us / 1000.0, snap.p99_us / 1000.0,
+                     snap.max_us / 1000.0);
+        }
+        last = now;
     }
 }
 
@@ -251,25 +655,61 @@ void app_main(void)
     init_led_pins();
 
     // Create members
-    xSensorQueue    = xQueueCreate(5, sizeof(sensor_data_t));
-    xUserQueue      = xQueueCreate(3, sizeof(user_input_t));
-    xNetworkQueue   = xQueueCreate(8, sizeof(network_message_t));
+#if USE_SENSOR_MAILBOX
+    bool sensor_ok  = mailbox_create(&xSensorBox, sizeof(sensor_data_t));
+    xSensorMember   = sensor_ok ? mailbox_set_member(&xSensorBox) : NULL;
+#else
+    xSensorQueue    = xQueueCreate(SENSOR_QUEUE_LEN, sizeof(sensor_data_t));
+    xSensorMember   = xSensorQueue;
+#endif
+#if USE_PUBSUB
+    // processor subscribe ก่อน -> ได้คิวที่ใช้เป็นสมาชิก queue set แทน xUserQueue เดิม
+    if (pubsub_create(&broker, sizeof(user_input_t), USER_POOL_MSGS)) {
+        topic_user  = pubsub_topic(&broker, "user");
+        xUserQueue  = pubsub_subscribe(&broker, topic_user, USER_QUEUE_LEN);
+        xUsageQueue = pubsub_subscribe(&broker, topic_user, USER_QUEUE_LEN);
+    }
+    bool user_ok    = xUserQueue && xUsageQueue;
+#else
+    xUserQueue      = xQueueCreate(USER_QUEUE_LEN, sizeof(user_input_t));
+    bool user_ok    = xUserQueue != NULL;
+#endif
+#if USE_PRIO_QUEUE
+    bool net_ok     = prio_queue_create(&xNetworkPrio, sizeof(network_message_t), NET_QUEUE_LEN);
+    xNetworkMember  = net_ok ? prio_queue_set_member(&xNetworkPrio) : NULL;
+#else
+    xNetworkQueue   = xQueueCreate(NET_QUEUE_LEN, sizeof(network_message_t));
+    xNetworkMember  = xNetworkQueue;
+#endif
     xTimerSemaphore = xSemaphoreCreateBinary();
 
-    // Queue set length = รวมความจุของสมาชิกทั้งหมด
-    const UBaseType_t qs_len = 5 + 3 + 8 + 1;
-    xQueueSet = xQueueCreateSet(qs_len);
+    xQueueSet = xQueueCreateSet(QUEUE_SET_LEN);
 
-    if (!xSensorQueue || !xUserQueue || !xNetworkQueue || !xTimerSemaphore || !xQueueSet) {
+    if (!xSensorMember || !user_ok || !xNetworkMember || !xTimerSemaphore || !xQueueSet) {
         ESP_LOGE(TAG, "Create queue/semaphore/set failed");
         return;
     }
 
-    // Add to set
-    configASSERT(xQueueAddToSet(xSensorQueue,    xQueueSet) == pdPASS);
-    configASSERT(xQueueAddToSet(xUserQueue,      xQueueSet) == pdPASS);
-    configASSERT(xQueueAddToSet(xNetworkQueue,   xQueueSet) == pdPASS);
-    configASSERT(xQueueAddToSet(xTimerSemaphore, xQueueSet) == pdPASS);
+    queue_telemetry_register(&tel_sensor,  "sensor",  NULL,         sensor_count,                 SENSOR_SET_SLOTS);
+    queue_telemetry_register(&tel_user,    "user",    xUserQueue,   queue_telemetry_xqueue_count, USER_QUEUE_LEN);
+    queue_telemetry_register(&tel_network, "network", NULL,         net_count,                    NET_QUEUE_LEN);
+
+    shard_stats_init(&stats);
+    sensor_hist_init(&sensor_hist, sensor_hist_buf, SENSOR_HISTORY_LEN);
+    win_agg_init(&temp_win, SENSOR_WINDOW_MS, SENSOR_SLIDE_PANES, TEMP_HIGH_C, TEMP_CLEAR_C);
+    win_agg_init(&hum_win,  SENSOR_WINDOW_MS, SENSOR_SLIDE_PANES, HUM_HIGH_PCT, HUM_CLEAR_PCT);
+
+    // Register sources (เพิ่มเข้า set ให้ด้วย)
+    event_dispatch_init(&dispatcher, xQueueSet);
+    configASSERT(event_dispatch_add(&dispatcher, "sensor",  xSensorMember,   handle_sensor,  NULL));
+    configASSERT(event_dispatch_add(&dispatcher, "user",    xUserQueue,      handle_user,    NULL));
+    configASSERT(event_dispatch_add(&dispatcher, "network", xNetworkMember,  handle_network, NULL));
+    configASSERT(event_dispatch_add(&dispatcher, "timer",   xTimerSemaphore, handle_timer,   NULL));
+
+#if USE_FLOW_CONTROL
+    flow_ctl_init(&net_flow, NULL, net_try_send, net_try_evict, NET_QUEUE_LEN, NET_SHED_POLICY);
+#endif
+    for (int p = 0; p < NET_PRIO_LEVELS; p++) lat_hist_init(&net_latency[p]);
 
     // Producers
     xTaskCreate(sensor_task,     "Sensor",    2048, NULL, 3, NULL);
@@ -279,7 +719,10 @@ void app_main(void)
 
     // Processor & Monitor
     xTaskCreate(processor_task,  "Processor", 3072, NULL, 4, NULL);
-    xTaskCreate(monitor_task,    "Monitor",   2048, NULL, 1, NULL);
+    xTaskCreate(monitor_task,    "Monitor",   3072, NULL, 1, NULL);
+#if USE_PUBSUB
+    xTaskCreate(usage_log_task,  "UsageLog",  2048, NULL, 2, NULL);
+#endif
 
     // Startup animation
     blink_led(LED_SENSOR, 80);
@@ -0,0 +1,124 @@
+// main/sensor_pack_bench.c — sensor record แบบ float (16 B) vs fixed-point + delta tick (8 B)
+//
+// สร้างตัวอย่างแบบเดียวกับ sensor_task ของ queue_sets (T 20.0–40.0, H 30.0–70.0, ห่าง 2–5 s)
+// แล้ววัดต่อ record:
+//   copy     = เก็บ sensor_sample_t ทั้งก้อน (แบบเดิม)
+//   pack     = sensor_pack_values (id/T/H -> x10)
+//   append   = sensor_hist_append (pack + delta tick + ring)
+//   unpack   = sensor_rec_temp/hum กลับเป็น float
+//   decode   = sensor_hist_decode ทั้ง ring (รวมการสะสม delta)
+// พร้อมตรวจ round trip: error ของ T/H และ tick ต้องตรงทุกตัว
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "sensor_pack.h"
+
+static const char *TAG = "PACK_BENCH";
+
+// ===== Config =====
+#define BENCH_RECORDS   1024            // = ขนาด history ที่ใช้วัด
+#define BENCH_ROUNDS    200
+#define TICK_MIN        200             // 2 s ที่ 100 Hz
+#define TICK_SPAN       300
+
+typedef enum { OP_COPY = 0, OP_PACK, OP_APPEND, OP_UNPACK, OP_DECODE, OP_COUNT } bench_op_t;
+static const char* const OP_NAMES[OP_COUNT] = { "copy", "pack", "append", "unpack", "decode" };
+static const size_t OP_BYTES[OP_COUNT] = {
+    sizeof(sensor_sample_t), sizeof(sensor_rec_t), sizeof(sensor_rec_t),
+    sizeof(sensor_rec_t), sizeof(sensor_rec_t),
+};
+
+static sensor_sample_t samples[BENCH_RECORDS];
+static sensor_sample_t raw_hist[BENCH_RECORDS];
+static sensor_sample_t decoded[BENCH_RECORDS];
+static sensor_rec_t    recs[BENCH_RECORDS];
+static sensor_rec_t    hist_buf[BENCH_RECORDS];
+static sensor_hist_t   hist;
+static volatile float  sink;
+
+static void make_samples(void) {
+    uint32_t tick = xTaskGetTickCount();
+    for (int i = 0; i < BENCH_RECORDS; i++) {
+        tick += TICK_MIN + esp_random() % TICK_SPAN;
+        samples[i].sensor_id   = 1;
+        samples[i].temperature = 20.0f + (float)(esp_random() % 200) / 10.0f;
+        samples[i].humidity    = 30.0f + (float)(esp_random() % 400) / 10.0f;
+        samples[i].timestamp   = tick;
+    }
+}
+
+// คืน ns ต่อ record
+static double run_op(bench_op_t op) {
+    int64_t dt = 0;
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        int64_t t0 = esp_timer_get_time();
+        switch (op) {
+        case OP_COPY:
+            for (int i = 0; i < BENCH_RECORDS; i++) raw_hist[i] = samples[i];
+            break;
+        case OP_PACK:
+            for (int i = 0; i < BENCH_RECORDS; i++) sensor_pack_values(&samples[i], &recs[i]);
+            break;
+        case OP_APPEND:
+            sensor_hist_init(&hist, hist_buf, BENCH_RECORDS);
+            for (int i = 0; i < BENCH_RECORDS; i++) sensor_hist_append(&hist, &samples[i], NULL);
+            break;
+        case OP_UNPACK: {
+            float acc = 0;
+            for (int i = 0; i < BENCH_RECORDS; i++) acc += sensor_rec_temp(&recs[i]) + sensor_rec_hum(&recs[i]);
+            sink = acc;
+            break;
+        }
+        case OP_DECODE:
+            sensor_hist_decode(&hist, decoded, BENCH_RECORDS);
+            break;
+        default:
+            break;
+        }
+        dt += esp_timer_get_time() - t0;
+        if ((r & 31) == 31) vTaskDelay(1);      // กัน task watchdog (ไม่นับรวม)
+    }
+    return (double)dt * 1000.0 / ((double)BENCH_ROUNDS * BENCH_RECORDS);
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "Sensor record encoding: %u records x %u rounds", BENCH_RECORDS, BENCH_ROUNDS);
+    make_samples();
+
+    double ns[OP_COUNT];
+    for (int op = 0; op < OP_COUNT; op++) ns[op] = run_op((bench_op_t)op);
+
+    // round trip (append/decode รอบสุดท้ายยังอยู่ใน hist/decoded)
+    float max_err = 0.0f;
+    uint32_t tick_errors = 0;
+    for (int i = 0; i < BENCH_RECORDS; i++) {
+        max_err = fmaxf(max_err, fabsf(decoded[i].temperature - samples[i].temperature));
+        max_err = fmaxf(max_err, fabsf(decoded[i].humidity - samples[i].humidity));
+        if (decoded[i].timestamp != samples[i].timestamp) tick_errors++;
+    }
+
+    printf("\n=== sensor record encoding (%u records) ===\n", BENCH_RECORDS);
+    printf("%-8s %10s %8s %10s\n", "op", "ns/record", "bytes", "records/KB");
+    for (int op = 0; op < OP_COUNT; op++) {
+        printf("%-8s %10.1f %8u %10lu\n", OP_NAMES[op], ns[op], (unsigned)OP_BYTES[op],
+               (unsigned long)sensor_pack_records_per_kb(OP_BYTES[op]));
+    }
+    printf("round trip: max T/H error %.3f, tick mismatches %lu, gaps %lu, clamped %lu\n",
+           max_err, (unsigned long)tick_errors, (unsigned long)hist.gaps, (unsigned long)hist.clamped);
+    printf("history of %u records: %u B packed vs %u B unpacked\n", BENCH_RECORDS,
+           (unsigned)(BENCH_RECORDS * sizeof(sensor_rec_t)), (unsigned)(BENCH_RECORDS * sizeof(sensor_sample_t)));
+
+    // summary,<op>,<ns_per_record>,<bytes_per_record>,<records_per_kb>
+    for (int op = 0; op < OP_COUNT; op++) {
+        printf("summary,%s,%.1f,%u,%lu\n", OP_NAMES[op], ns[op], (unsigned)OP_BYTES[op],
+               (unsigned long)sensor_pack_records_per_kb(OP_BYTES[op]));
+    }
+    if (max_err > 0.05f || tick_errors) ESP_LOGW(TAG, "round trip mismatch");
+    ESP_LOGI(TAG, "Benchmark done");
+}
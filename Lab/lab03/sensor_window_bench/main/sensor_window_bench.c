@@ -0,0 +1,274 @@
+// main/sensor_window_bench.c — processor wakeups/CPU: ส่งทุกตัวอย่าง vs รวมเป็นหน้าต่าง (win_agg)
+//
+// sensor 1 ตัวสร้าง BENCH_SAMPLES ตัวอย่างทุก 2–5 s แบบ queue_sets.c แต่ใช้นาฬิกาจำลอง (ไม่ต้องรอจริง)
+// -> หน้าต่าง 10 s ปิดตรงตามเวลาของตัวอย่าง
+//   uniform = สุ่มใหม่ทุกตัวอย่างแบบ queue_sets.c (T 20–40°C, H 30–70%) ข้ามเกณฑ์บ่อยมาก = กรณีแย่สุดของ windowed
+//   drift   = random walk ช้า ๆ รอบ 25°C/45% แบบ sensor จริง ข้ามเกณฑ์นาน ๆ ครั้ง
+//   per-sample = ส่งทุกตัวอย่าง processor ตื่น + format log + เช็คเกณฑ์ทุกครั้ง
+//   windowed   = win_agg_add ฝั่ง sensor ส่งเฉพาะตอนหน้าต่างปิด/ข้ามเกณฑ์ (เหตุการณ์ผ่านคิว ห้ามทับ)
+// processor prio สูงกว่า sensor, pinned core เดียวกัน -> ทุก send ปลุก processor 1 ครั้ง
+// เวลารวม / ตัวอย่าง = ต้นทุน CPU ต่อตัวอย่างรวม context switch; busy = เวลาที่ processor ใช้จริง
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "win_agg.h"
+
+static const char *TAG = "SENSOR_WIN_BENCH";
+
+// ===== Config =====
+#define BENCH_SAMPLES     20000
+#define QUEUE_DEPTH       5                 // SENSOR_QUEUE_LEN ใน queue_sets.c
+#define BENCH_CORE        1
+#define SENSOR_PRIO       3
+#define PROCESSOR_PRIO    4
+#define SAMPLE_MIN_MS     2000
+#define SAMPLE_SPAN_MS    3000
+#define WINDOW_MS         10000
+#define SLIDE_PANES       6
+#define TEMP_HIGH_C       35.0f
+#define TEMP_CLEAR_C      34.0f
+#define HUM_HIGH_PCT      60.0f
+#define HUM_CLEAR_PCT     58.0f
+#define LOG_LINE          128
+
+typedef enum { MODE_SAMPLE = 0, MODE_WINDOW, MODE_COUNT } bench_mode_t;
+static const char* const MODE_NAMES[MODE_COUNT] = { "per-sample", "windowed" };
+
+typedef enum { SIGNAL_UNIFORM = 0, SIGNAL_DRIFT, SIGNAL_COUNT } bench_signal_t;
+static const char* const SIGNAL_NAMES[SIGNAL_COUNT] = { "uniform", "drift" };
+
+typedef struct {
+    float      t;
+    float      h;
+    uint8_t    temp_events;
+    uint8_t    hum_events;
+    bool       stop;
+    win_stat_t temp_tumbling;
+    win_stat_t temp_sliding;
+    win_stat_t hum_tumbling;
+    win_stat_t hum_sliding;
+} sample_msg_t;
+
+typedef struct {
+    bench_mode_t     mode;
+    bench_signal_t   signal;
+    QueueHandle_t    q;
+    TaskHandle_t     notify;
+    int64_t          sim_us;                // เวลาจำลองของตัวอย่างสุดท้าย
+    uint32_t         events_sent;
+    _Atomic uint32_t events_handled;
+    _Atomic uint32_t wakeups;
+    _Atomic uint64_t busy_us;
+    _Atomic uint64_t log_bytes;
+} bench_ctx_t;
+
+typedef struct {
+    uint32_t wakeups;
+    double   wakeups_per_min;               // ต่อนาทีของเวลาจำลอง (= อัตราจริงบนบอร์ด)
+    double   us_per_sample;                 // เวลารวมทั้งสอง task / ตัวอย่าง
+    double   busy_us_per_wake;
+    double   cpu_ppm;                       // ต้นทุนต่อตัวอย่าง / ช่วงห่างเฉลี่ยของตัวอย่าง (ส่วนในล้าน)
+    uint64_t log_bytes;
+    uint32_t events_lost;
+} bench_result_t;
+
+static bench_ctx_t ctx;
+
+static inline uint32_t popcount8(uint8_t v) {
+    uint32_t n = 0;
+    for (; v; v &= (uint8_t)(v - 1)) n++;
+    return n;
+}
+
+// xorshift32: ทุก mode ได้ลำดับตัวอย่างเดียวกัน
+static inline uint32_t next_rand(uint32_t* s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+// ===== Sensor =====
+static inline float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// step ±0.3 ต่อตัวอย่าง
+static inline float walk(float v, uint32_t r, float lo, float hi) {
+    return clampf(v + (float)((int32_t)(r % 7) - 3) / 10.0f, lo, hi);
+}
+
+static void sensor_task(void *pv) {
+    static win_agg_t temp_win, hum_win;
+    win_agg_init(&temp_win, WINDOW_MS, SLIDE_PANES, TEMP_HIGH_C, TEMP_CLEAR_C);
+    win_agg_init(&hum_win,  WINDOW_MS, SLIDE_PANES, HUM_HIGH_PCT, HUM_CLEAR_PCT);
+
+    uint32_t seed = 0x2545F491u;
+    int64_t now_us = 0;
+    sample_msg_t m;
+    memset(&m, 0, sizeof(m));
+    m.t = 25.0f;
+    m.h = 45.0f;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        now_us += (int64_t)(SAMPLE_MIN_MS + next_rand(&seed) % SAMPLE_SPAN_MS) * 1000;
+        if (ctx.signal == SIGNAL_UNIFORM) {
+            m.t = 20.0f + (float)(next_rand(&seed) % 200) / 10.0f;
+            m.h = 30.0f + (float)(next_rand(&seed) % 400) / 10.0f;
+        } else {
+            m.t = walk(m.t, next_rand(&seed), 20.0f, 40.0f);
+            m.h = walk(m.h, next_rand(&seed), 30.0f, 70.0f);
+        }
+        if (ctx.mode == MODE_WINDOW) {
+            m.temp_events = (uint8_t)win_agg_add(&temp_win, m.t, now_us);
+            m.hum_events  = (uint8_t)win_agg_add(&hum_win, m.h, now_us);
+            if (m.temp_events == 0 && m.hum_events == 0) continue;
+            win_agg_tumbling(&temp_win, &m.temp_tumbling);
+            win_agg_sliding(&temp_win, &m.temp_sliding);
+            win_agg_tumbling(&hum_win, &m.hum_tumbling);
+            win_agg_sliding(&hum_win, &m.hum_sliding);
+            ctx.events_sent += popcount8(m.temp_events) + popcount8(m.hum_events);
+        }
+        xQueueSend(ctx.q, &m, portMAX_DELAY);
+    }
+    ctx.sim_us = now_us;
+    memset(&m, 0, sizeof(m));
+    m.stop = true;
+    xQueueSend(ctx.q, &m, portMAX_DELAY);
+    vTaskDelete(NULL);
+}
+
+// ===== Processor =====
+// งานต่อข้อความเหมือน handle_sensor ใน queue_sets.c (format บรรทัด log แทนการพิมพ์ออก UART)
+static void processor_task(void *pv) {
+    char line[LOG_LINE];
+    sample_msg_t m;
+    for (;;) {
+        xQueueReceive(ctx.q, &m, portMAX_DELAY);
+        if (m.stop) break;
+        int64_t t0 = esp_timer_get_time();
+        int n = 0;
+        if (ctx.mode == MODE_SAMPLE) {
+            n += snprintf(line, sizeof(line), "→ SENSOR: T=%.1f°C, H=%.1f%%", m.t, m.h);
+            if (m.t > TEMP_HIGH_C)  n += snprintf(line, sizeof(line), "⚠️ High temperature!");
+            if (m.h > HUM_HIGH_PCT) n += snprintf(line, sizeof(line), "⚠️ High humidity!");
+        } else {
+            if (m.temp_events & WIN_AGG_WINDOW) {
+                n += snprintf(line, sizeof(line), "→ SENSOR %ds: T %.1f/%.1f/%.1f°C H %.1f/%.1f/%.1f%% (n=%lu) | %ds avg: T %.1f°C H %.1f%%",
+                              WINDOW_MS / 1000, m.temp_tumbling.min, m.temp_tumbling.mean, m.temp_tumbling.max,
+                              m.hum_tumbling.min, m.hum_tumbling.mean, m.hum_tumbling.max,
+                              (unsigned long)m.temp_tumbling.count, WINDOW_MS * SLIDE_PANES / 1000,
+                              m.temp_sliding.mean, m.hum_sliding.mean);
+            }
+            if (m.temp_events & WIN_AGG_RISE) n += snprintf(line, sizeof(line), "⚠️ High temperature! (%.1f°C)", m.t);
+            if (m.temp_events & WIN_AGG_FALL) n += snprintf(line, sizeof(line), "✓ Temperature back below %.1f°C", TEMP_CLEAR_C);
+            if (m.hum_events  & WIN_AGG_RISE) n += snprintf(line, sizeof(line), "⚠️ High humidity! (%.1f%%)", m.h);
+            if (m.hum_events  & WIN_AGG_FALL) n += snprintf(line, sizeof(line), "✓ Humidity back below %.1f%%", HUM_CLEAR_PCT);
+            atomic_fetch_add(&ctx.events_handled, popcount8(m.temp_events) + popcount8(m.hum_events));
+        }
+        atomic_fetch_add(&ctx.wakeups, 1);
+        atomic_fetch_add(&ctx.log_bytes, (uint64_t)n);
+        atomic_fetch_add(&ctx.busy_us, (uint64_t)(esp_timer_get_time() - t0));
+    }
+    xTaskNotifyGive(ctx.notify);
+    vTaskDelete(NULL);
+}
+
+// ===== Gap check =====
+// ตัวอย่างที่ 1 s, 5 s แล้วหายไปถึง 26 s (หน้าต่าง 10 s): ตอน 26 s หน้าต่าง [1 s, 11 s) ปิด
+// และมี pane ว่าง [11 s, 21 s) ต่อท้าย -> tumbling ต้องยังได้หน้าต่างที่ปิด (2 ตัวอย่าง) ไม่ใช่ pane ว่าง
+static bool check_gap_window(void) {
+    win_agg_t w;
+    win_agg_init(&w, WINDOW_MS, SLIDE_PANES, TEMP_HIGH_C, TEMP_CLEAR_C);
+    win_agg_add(&w, 20.0f, 1000000);
+    win_agg_add(&w, 22.0f, 5000000);
+    uint32_t ev = win_agg_add(&w, 24.0f, 26000000);
+
+    win_stat_t tum, sld;
+    win_agg_tumbling(&w, &tum);
+    win_agg_sliding(&w, &sld);
+    bool ok = (ev & WIN_AGG_WINDOW) && tum.count == 2 && tum.mean == 21.0f && sld.count == 2;
+    ESP_LOGI(TAG, "gap window: ev=%lu tumbling count=%lu mean=%.1f sliding count=%lu -> %s",
+             (unsigned long)ev, (unsigned long)tum.count, tum.mean, (unsigned long)sld.count,
+             ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// ===== Runner =====
+static bool run_one(bench_signal_t signal, bench_mode_t mode, bench_result_t* r) {
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.mode = mode;
+    ctx.signal = signal;
+    ctx.notify = xTaskGetCurrentTaskHandle();
+    ctx.q = xQueueCreate(QUEUE_DEPTH, sizeof(sample_msg_t));
+    if (!ctx.q) return false;
+
+    int64_t t0 = esp_timer_get_time();
+    xTaskCreatePinnedToCore(processor_task, "sw_proc", 3072, NULL, PROCESSOR_PRIO, NULL, BENCH_CORE);
+    xTaskCreatePinnedToCore(sensor_task, "sw_sensor", 3072, NULL, SENSOR_PRIO, NULL, BENCH_CORE);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t dt = esp_timer_get_time() - t0;
+
+    double sim_min = (double)ctx.sim_us / 60e6;
+    double avg_gap_us = (double)ctx.sim_us / BENCH_SAMPLES;
+    r->wakeups = atomic_load(&ctx.wakeups);
+    r->wakeups_per_min = sim_min > 0 ? r->wakeups / sim_min : 0.0;
+    r->us_per_sample = (double)dt / BENCH_SAMPLES;
+    r->busy_us_per_wake = r->wakeups ? (double)atomic_load(&ctx.busy_us) / r->wakeups : 0.0;
+    r->cpu_ppm = avg_gap_us > 0 ? r->us_per_sample * 1e6 / avg_gap_us : 0.0;
+    r->log_bytes = atomic_load(&ctx.log_bytes);
+    r->events_lost = mode == MODE_WINDOW ? ctx.events_sent - atomic_load(&ctx.events_handled) : 0;
+
+    vTaskDelay(pdMS_TO_TICKS(10));      // ให้ sensor/processor ลบตัวเองเสร็จ
+    vQueueDelete(ctx.q);
+    return true;
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "Sensor dispatch: per-sample vs windowed (%u samples, window %u ms, core %u)",
+             BENCH_SAMPLES, WINDOW_MS, BENCH_CORE);
+    if (!check_gap_window()) ESP_LOGE(TAG, "win_agg returned the wrong pane after a sample gap");
+
+    bench_result_t res[SIGNAL_COUNT][MODE_COUNT];
+    memset(res, 0, sizeof(res));
+    for (int g = 0; g < SIGNAL_COUNT; g++) {
+        for (int m = 0; m < MODE_COUNT; m++) {
+            if (!run_one((bench_signal_t)g, (bench_mode_t)m, &res[g][m])) {
+                ESP_LOGE(TAG, "%s %s: setup failed", SIGNAL_NAMES[g], MODE_NAMES[m]);
+            }
+        }
+    }
+
+    printf("\n%-8s %-10s %9s %10s %10s %10s %9s %10s %6s\n", "signal",
+           "mode", "wakeups", "wakes/min", "us/sample", "busy/wake", "cpu ppm", "log bytes", "lost");
+    for (int g = 0; g < SIGNAL_COUNT; g++) {
+        for (int m = 0; m < MODE_COUNT; m++) {
+            const bench_result_t* r = &res[g][m];
+            printf("%-8s %-10s %9lu %10.2f %10.2f %10.2f %9.2f %10llu %6lu\n", SIGNAL_NAMES[g], MODE_NAMES[m],
+                   (unsigned long)r->wakeups, r->wakeups_per_min, r->us_per_sample, r->busy_us_per_wake,
+                   r->cpu_ppm, (unsigned long long)r->log_bytes, (unsigned long)r->events_lost);
+        }
+    }
+    for (int g = 0; g < SIGNAL_COUNT; g++) {
+        const bench_result_t* ps = &res[g][MODE_SAMPLE];
+        const bench_result_t* wn = &res[g][MODE_WINDOW];
+        printf("%s: windowed changes wakeups by %+.0f%%, CPU per sample by %+.0f%%\n", SIGNAL_NAMES[g],
+               ps->wakeups ? 100.0 * ((double)wn->wakeups / ps->wakeups - 1.0) : 0.0,
+               ps->us_per_sample > 0 ? 100.0 * (wn->us_per_sample / ps->us_per_sample - 1.0) : 0.0);
+    }
+    // summary,<signal>,<mode>,<wakeups>,<wakeups_per_min>,<us_per_sample>,<busy_us_per_wake>,<cpu_ppm>,<log_bytes>,<lost>
+    for (int g = 0; g < SIGNAL_COUNT; g++) {
+        for (int m = 0; m < MODE_COUNT; m++) {
+            const bench_result_t* r = &res[g][m];
+            printf("summary,%s,%s,%lu,%.2f,%.2f,%.2f,%.2f,%llu,%lu\n", SIGNAL_NAMES[g], MODE_NAMES[m],
+                   (unsigned long)r->wakeups, r->wakeups_per_min, r->us_per_sample, r->busy_us_per_wake,
+                   r->cpu_ppm, (unsigned long long)r->log_bytes, (unsigned long)r->events_lost);
+        }
+    }
+    ESP_LOGI(TAG, "Benchmark done");
+}
@@ -0,0 +1,162 @@
+// main/spsc_ring_bench.c — FreeRTOS queue vs lock-free SPSC ring
+//
+// producer 1 ตัว -> consumer 1 ตัว แบบเดียวกับ sender_task/receiver_task ใน basic_queue.c
+// วัด msgs/s ทั้งกรณีสอง task อยู่ core เดียวกัน และอยู่คนละ core
+// พร้อมจำนวนครั้งที่ต้อง block (ring เต็ม/ว่าง) ของฝั่ง ring
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "spsc_ring.h"
+
+static const char *TAG = "SPSC_BENCH";
+
+// ===== Config =====
+#define BENCH_MSGS      20000
+#define CHANNEL_DEPTH   8
+#define BENCH_PRIO      5
+#define MAX_ITEM        64
+
+// 4 = ค่า/pointer เดี่ยว, 60 = queue_message_t
+static const uint32_t ITEM_SIZES[] = { 4, 60 };
+#define SIZE_COUNT (sizeof(ITEM_SIZES) / sizeof(ITEM_SIZES[0]))
+
+typedef enum { CH_QUEUE = 0, CH_RING, CH_COUNT } channel_kind_t;
+static const char* const CH_NAMES[CH_COUNT] = { "queue", "spsc" };
+
+typedef struct {
+    const char* name;
+    BaseType_t  producer_core;
+    BaseType_t  consumer_core;
+} placement_t;
+
+static const placement_t PLACEMENTS[] = {
+    { "same-core",  1, 1 },
+    { "cross-core", 0, 1 },
+};
+#define PLACEMENT_COUNT (sizeof(PLACEMENTS) / sizeof(PLACEMENTS[0]))
+
+typedef struct {
+    channel_kind_t kind;
+    uint32_t       size;
+    QueueHandle_t  q;
+    spsc_ring_t    ring;
+    TaskHandle_t   notify;
+    uint32_t       errors;
+} bench_ctx_t;
+
+typedef struct {
+    double   msgs_per_s;
+    uint32_t full_waits;
+    uint32_t empty_waits;
+    uint32_t errors;
+} bench_result_t;
+
+static bench_ctx_t ctx;
+
+// ===== Producer / Consumer =====
+static void producer_task(void *pv) {
+    uint8_t item[MAX_ITEM];
+    for (uint32_t i = 0; i < BENCH_MSGS; i++) {
+        memcpy(item, &i, sizeof(i));
+        if (ctx.kind == CH_QUEUE) xQueueSend(ctx.q, item, portMAX_DELAY);
+        else                      spsc_ring_send(&ctx.ring, item, portMAX_DELAY);
+    }
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *pv) {
+    uint8_t item[MAX_ITEM];
+    for (uint32_t i = 0; i < BENCH_MSGS; i++) {
+        if (ctx.kind == CH_QUEUE) xQueueReceive(ctx.q, item, portMAX_DELAY);
+        else                      spsc_ring_receive(&ctx.ring, item, portMAX_DELAY);
+        uint32_t seq;
+        memcpy(&seq, item, sizeof(seq));
+        if (seq != i) ctx.errors++;     // ลำดับต้องตรงเป๊ะ (FIFO)
+    }
+    xTaskNotifyGive(ctx.notify);
+    vTaskDelete(NULL);
+}
+
+// ===== Runner =====
+static bool run_one(channel_kind_t kind, uint32_t size, const placement_t* pl, bench_result_t* r) {
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.kind = kind;
+    ctx.size = size;
+    ctx.notify = xTaskGetCurrentTaskHandle();
+
+    if (kind == CH_QUEUE) {
+        ctx.q = xQueueCreate(CHANNEL_DEPTH, size);
+        if (!ctx.q) return false;
+    } else if (!spsc_ring_create(&ctx.ring, size, CHANNEL_DEPTH)) {
+        return false;
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    xTaskCreatePinnedToCore(consumer_task, "spsc_cons", 3072, NULL, BENCH_PRIO, NULL, pl->consumer_core);
+    xTaskCreatePinnedToCore(producer_task, "spsc_prod", 3072, NULL, BENCH_PRIO, NULL, pl->producer_core);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t dt = esp_timer_get_time() - t0;
+
+    r->msgs_per_s  = dt > 0 ? (double)BENCH_MSGS * 1e6 / (double)dt : 0.0;
+    r->full_waits  = ctx.ring.full_waits;
+    r->empty_waits = ctx.ring.empty_waits;
+    r->errors      = ctx.errors;
+
+    vTaskDelay(pdMS_TO_TICKS(10));      // ให้ producer/consumer ลบตัวเองเสร็จ
+    if (kind == CH_QUEUE) vQueueDelete(ctx.q);
+    else                  spsc_ring_destroy(&ctx.ring);
+    return true;
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "SPSC ring vs FreeRTOS queue: %u msgs, depth %u", BENCH_MSGS, CHANNEL_DEPTH);
+
+    bench_result_t res[PLACEMENT_COUNT][SIZE_COUNT][CH_COUNT];
+    memset(res, 0, sizeof(res));
+
+    for (size_t p = 0; p < PLACEMENT_COUNT; p++) {
+        for (size_t s = 0; s < SIZE_COUNT; s++) {
+            for (int c = 0; c < CH_COUNT; c++) {
+                if (!run_one((channel_kind_t)c, ITEM_SIZES[s], &PLACEMENTS[p], &res[p][s][c])) {
+                    ESP_LOGE(TAG, "%s %s %u B: setup failed",
+                             PLACEMENTS[p].name, CH_NAMES[c], (unsigned)ITEM_SIZES[s]);
+                }
+            }
+        }
+    }
+
+    printf("\n=== SPSC ring vs queue (%u msgs, depth %u) ===\n", BENCH_MSGS, CHANNEL_DEPTH);
+    printf("%-11s %5s %12s %12s %8s %10s %10s\n",
+           "placement", "item", "queue msg/s", "spsc msg/s", "speedup", "full wait", "empty wait");
+    for (size_t p = 0; p < PLACEMENT_COUNT; p++) {
+        for (size_t s = 0; s < SIZE_COUNT; s++) {
+            const bench_result_t* q = &res[p][s][CH_QUEUE];
+            const bench_result_t* r = &res[p][s][CH_RING];
+            printf("%-11s %5u %12.0f %12.0f %7.2fx %10lu %10lu\n",
+                   PLACEMENTS[p].name, (unsigned)ITEM_SIZES[s], q->msgs_per_s, r->msgs_per_s,
+                   q->msgs_per_s > 0 ? r->msgs_per_s / q->msgs_per_s : 0.0,
+                   (unsigned long)r->full_waits, (unsigned long)r->empty_waits);
+            if (q->errors || r->errors) {
+                ESP_LOGW(TAG, "order errors: queue=%lu spsc=%lu",
+                         (unsigned long)q->errors, (unsigned long)r->errors);
+            }
+        }
+    }
+    // summary,<placement>,<channel>,<item>,<msgs/s>,<full_waits>,<empty_waits>,<errors>
+    for (size_t p = 0; p < PLACEMENT_COUNT; p++) {
+        for (size_t s = 0; s < SIZE_COUNT; s++) {
+            for (int c = 0; c < CH_COUNT; c++) {
+                const bench_result_t* r = &res[p][s][c];
+                printf("summary,%s,%s,%u,%.0f,%lu,%lu,%lu\n", PLACEMENTS[p].name, CH_NAMES[c],
+                       (unsigned)ITEM_SIZES[s], r->msgs_per_s, (unsigned long)r->full_waits,
+                       (unsigned long)r->empty_waits, (unsigned long)r->errors);
+            }
+        }
+    }
+    ESP_LOGI(TAG, "Benchmark done");
+}
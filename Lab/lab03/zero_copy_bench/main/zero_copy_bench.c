@@ -0,0 +1,170 @@
+// main/zero_copy_bench.c — by-value queue vs zero-copy channel
+//
+// ส่ง BENCH_MSGS ข้อความจาก producer ไป consumer (pinned core เดียวกัน, priority เท่ากัน)
+// ด้วย 2 แบบ แล้วเทียบ msgs/s และ bytes ที่คิวต้อง copy:
+//   by-value  = xQueueSend/xQueueReceive ของ struct ทั้งก้อน (เหมือน basic_queue, producer_consumer, queue_sets)
+//   zero-copy = ส่ง pointer ของบัฟเฟอร์จากพูล, consumer เป็นคน free
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "zc_channel.h"
+
+static const char *TAG = "ZC_BENCH";
+
+// ===== Config =====
+#define BENCH_MSGS      5000
+#define QUEUE_DEPTH     8
+#define POOL_BUFS       (QUEUE_DEPTH + 2)   // ในคิว + ที่ producer/consumer ถืออยู่
+#define BENCH_CORE      1
+#define BENCH_PRIO      5
+#define MAX_PAYLOAD     1024
+
+// 48 = product_t, 60 = queue_message_t, 124 = network_message_t
+static const size_t PAYLOAD_SIZES[] = { 16, 48, 60, 124, 256, 512, 1024 };
+#define SIZE_COUNT (sizeof(PAYLOAD_SIZES) / sizeof(PAYLOAD_SIZES[0]))
+
+typedef enum { MODE_BY_VALUE = 0, MODE_ZERO_COPY, MODE_COUNT } bench_mode_t;
+static const char* const MODE_NAMES[MODE_COUNT] = { "by-value", "zero-copy" };
+
+typedef struct {
+    bench_mode_t  mode;
+    size_t        size;
+    QueueHandle_t q;            // by-value
+    zc_pool_t     pool;         // zero-copy
+    zc_channel_t  ch;
+    TaskHandle_t  notify;
+    uint32_t      checksum;
+    uint32_t      errors;
+} bench_ctx_t;
+
+typedef struct {
+    double   msgs_per_s;
+    uint64_t bytes_copied;
+    uint32_t errors;
+} bench_result_t;
+
+static bench_ctx_t ctx;
+static uint8_t tx_buf[MAX_PAYLOAD];
+static uint8_t rx_buf[MAX_PAYLOAD];
+
+// ===== Producer / Consumer =====
+static void producer_task(void *pv) {
+    for (uint32_t i = 0; i < BENCH_MSGS; i++) {
+        if (ctx.mode == MODE_BY_VALUE) {
+            memset(tx_buf, (int)(i & 0xFF), ctx.size);
+            xQueueSend(ctx.q, tx_buf, portMAX_DELAY);
+        } else {
+            void* buf = zc_buf_alloc(&ctx.pool, portMAX_DELAY);
+            memset(buf, (int)(i & 0xFF), ctx.size);
+            zc_channel_send(&ctx.ch, &buf, portMAX_DELAY);
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+static void consumer_task(void *pv) {
+    for (uint32_t i = 0; i < BENCH_MSGS; i++) {
+        const uint8_t* p;
+        void* buf = NULL;
+        if (ctx.mode == MODE_BY_VALUE) {
+            xQueueReceive(ctx.q, rx_buf, portMAX_DELAY);
+            p = rx_buf;
+        } else {
+            buf = zc_channel_receive(&ctx.ch, portMAX_DELAY);
+            p = buf;
+        }
+        // แตะหัว/ท้าย payload ให้เหมือนการใช้งานจริง
+        if (p[0] != (uint8_t)i || p[ctx.size - 1] != (uint8_t)i) ctx.errors++;
+        ctx.checksum += p[0];
+        if (buf) zc_buf_free(&ctx.pool, buf);
+    }
+    xTaskNotifyGive(ctx.notify);
+    vTaskDelete(NULL);
+}
+
+// ===== Runner =====
+static bool run_one(bench_mode_t mode, size_t size, bench_result_t* r) {
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.mode = mode;
+    ctx.size = size;
+    ctx.notify = xTaskGetCurrentTaskHandle();
+
+    if (mode == MODE_BY_VALUE) {
+        ctx.q = xQueueCreate(QUEUE_DEPTH, size);
+        if (!ctx.q) return false;
+    } else {
+        if (!zc_pool_create(&ctx.pool, size, POOL_BUFS, MALLOC_CAP_8BIT)) return false;
+        if (!zc_channel_create(&ctx.ch, &ctx.pool, QUEUE_DEPTH)) {
+            zc_pool_destroy(&ctx.pool);
+            return false;
+        }
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    xTaskCreatePinnedToCore(consumer_task, "zc_cons", 3072, NULL, BENCH_PRIO, NULL, BENCH_CORE);
+    xTaskCreatePinnedToCore(producer_task, "zc_prod", 3072, NULL, BENCH_PRIO, NULL, BENCH_CORE);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t dt = esp_timer_get_time() - t0;
+
+    r->msgs_per_s = dt > 0 ? (double)BENCH_MSGS * 1e6 / (double)dt : 0.0;
+    r->bytes_copied = (uint64_t)BENCH_MSGS *
+        (mode == MODE_BY_VALUE ? 2 * size : zc_channel_bytes_copied_per_msg());
+    r->errors = ctx.errors + ctx.pool.bad_free;
+
+    vTaskDelay(pdMS_TO_TICKS(10));      // ให้ producer/consumer ลบตัวเองเสร็จ
+    if (mode == MODE_BY_VALUE) {
+        vQueueDelete(ctx.q);
+    } else {
+        zc_channel_destroy(&ctx.ch);
+        zc_pool_destroy(&ctx.pool);
+    }
+    return true;
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "Queue copy benchmark: by-value vs zero-copy");
+    ESP_LOGI(TAG, "%u msgs per run, depth %u, core %u, prio %u",
+             BENCH_MSGS, QUEUE_DEPTH, BENCH_CORE, BENCH_PRIO);
+
+    bench_result_t res[SIZE_COUNT][MODE_COUNT];
+    memset(res, 0, sizeof(res));
+
+    for (size_t s = 0; s < SIZE_COUNT; s++) {
+        for (int m = 0; m < MODE_COUNT; m++) {
+            if (!run_one((bench_mode_t)m, PAYLOAD_SIZES[s], &res[s][m])) {
+                ESP_LOGE(TAG, "%s %u B: setup failed", MODE_NAMES[m], (unsigned)PAYLOAD_SIZES[s]);
+            }
+        }
+    }
+
+    printf("\n=== by-value vs zero-copy (%u msgs) ===\n", BENCH_MSGS);
+    printf("%8s %12s %12s %14s %14s %8s\n",
+           "payload", "byval msg/s", "zc msg/s", "byval copied", "zc copied", "speedup");
+    for (size_t s = 0; s < SIZE_COUNT; s++) {
+        const bench_result_t* bv = &res[s][MODE_BY_VALUE];
+        const bench_result_t* zc = &res[s][MODE_ZERO_COPY];
+        printf("%8u %12.0f %12.0f %14llu %14llu %7.2fx\n",
+               (unsigned)PAYLOAD_SIZES[s], bv->msgs_per_s, zc->msgs_per_s,
+               (unsigned long long)bv->bytes_copied, (unsigned long long)zc->bytes_copied,
+               bv->msgs_per_s > 0 ? zc->msgs_per_s / bv->msgs_per_s : 0.0);
+        if (bv->errors || zc->errors) {
+            ESP_LOGW(TAG, "%u B: errors by-value=%lu zero-copy=%lu", (unsigned)PAYLOAD_SIZES[s],
+                     (unsigned long)bv->errors, (unsigned long)zc->errors);
+        }
+    }
+    // summary,<mode>,<payload>,<msgs/s>,<bytes_copied>,<errors>
+    for (size_t s = 0; s < SIZE_COUNT; s++) {
+        for (int m = 0; m < MODE_COUNT; m++) {
+            const bench_result_t* r = &res[s][m];
+            printf("summary,%s,%u,%.0f,%llu,%lu\n", MODE_NAMES[m], (unsigned)PAYLOAD_SIZES[s],
+                   r->msgs_per_s, (unsigned long long)r->bytes_copied, (unsigned long)r->errors);
+        }
+    }
+    ESP_LOGI(TAG, "Benchmark done");
+}
@@ -9,6 +9,7 @@
 #include "driver/gptimer.h"
 #include "esp_random.h"
 #include "esp_err.h"
+#include "shard_stats.h"
 
 static const char *TAG = "BINARY_SEM_E3";
 
@@ -40,7 +41,17 @@ typedef struct {
     uint32_t consumer_timeouts;
 } semaphore_stats_t;
 
-static semaphore_stats_t stats = {0, 0, 0, 0, 0};
+// producer/consumer/timer/button task เพิ่มค่าจากสอง core -> นับลง shard ต่อ core แล้วรวมตอนอ่าน
+enum { STAT_SENT, STAT_RECEIVED, STAT_TIMER, STAT_BUTTON, STAT_TIMEOUTS, STAT_COUNT };
+
+static shard_stats_t stats;
+
+static semaphore_stats_t stats_read(void)
+{
+    uint32_t v[STAT_COUNT];
+    shard_stats_read(&stats, v, STAT_COUNT);
+    return (semaphore_stats_t){ v[STAT_SENT], v[STAT_RECEIVED], v[STAT_TIMER], v[STAT_BUTTON], v[STAT_TIMEOUTS] };
+}
 
 // ================= ISR Callbacks ===================
 static bool IRAM_ATTR timer_callback(gptimer_handle_t timer,
@@ -74,7 +85,7 @@ static void producer_task(void *pvParameters)
         ESP_LOGI(TAG, "🔥 Producer: Generating event #%d", event_counter);
 
         if (xSemaphoreGive(xBinarySemaphore) == pdTRUE) {
-            stats.signals_sent++;
+            shard_stats_inc(&stats, STAT_SENT);
             ESP_LOGI(TAG, "✅ Producer: Event signaled");
             gpio_set_level(LED_PRODUCER, 1);
             vTaskDelay(pdMS_TO_TICKS(120));
@@ -93,16 +104,16 @@ static void consumer_task(void *pvParameters)
         ESP_LOGI(TAG, "🔍 Consumer: Waiting for event (<= %d ms)...", CONSUMER_TIMEOUT_MS);
 
         if (xSemaphoreTake(xBinarySemaphore, pdMS_TO_TICKS(CONSUMER_TIMEOUT_MS)) == pdTRUE) {
-            stats.signals_received++;
+            shard_stats_inc(&stats, STAT_RECEIVED);
             ESP_LOGI(TAG, "⚡ Consumer: Event received! Processing...");
             gpio_set_level(LED_CONSUMER, 1);
             vTaskDelay(pdMS_TO_TICKS(800 + (esp_random() % 1200))); // 0.8–2.0s
             gpio_set_level(LED_CONSUMER, 0);
             ESP_LOGI(TAG, "✓ Consumer: Event processed");
         } else {
-            stats.consumer_timeouts++;
+            shard_stats_inc(&stats, STAT_TIMEOUTS);
             ESP_LOGW(TAG, "⏰ Consumer: Timeout waiting for event (count=%lu)",
-                     (unsigned long)stats.consumer_timeouts);
+                     (unsigned long)shard_stats_sum(&stats, STAT_TIMEOUTS));
         }
     }
 }
@@ -114,20 +125,21 @@ static void timer_event_task(void *pvParameters)
     while (1)
     {
         if (xSemaphoreTake(xTimerSemaphore, portMAX_DELAY) == pdTRUE) {
-            stats.timer_events++;
+            shard_stats_inc(&stats, STAT_TIMER);
+            semaphore_stats_t now = stats_read();
             ESP_LOGI(TAG, "⏱️  Timer: Periodic event #%lu",
-                     (unsigned long)stats.timer_events);
+                     (unsigned long)now.timer_events);
             gpio_set_level(LED_TIMER, 1);
             vTaskDelay(pdMS_TO_TICKS(200));
             gpio_set_level(LED_TIMER, 0);
 
-            if (stats.timer_events % 5 == 0) {
+            if (now.timer_events % 5 == 0) {
                 ESP_LOGI(TAG, "📊 Stats - Sent:%lu, Received:%lu, Timeouts:%lu, Timer:%lu, Button:%lu",
-                         (unsigned long)stats.signals_sent,
-                         (unsigned long)stats.signals_received,
-                         (unsigned long)stats.consumer_timeouts,
-                         (unsigned long)stats.timer_events,
-                         (unsigned long)stats.button_presses);
+                         (unsigned long)now.signals_sent,
+                         (unsigned long)now.signals_received,
+                         (unsigned long)now.consumer_timeouts,
+                         (unsigned long)now.timer_events,
+                         (unsigned long)now.button_presses);
             }
         }
     }
@@ -140,13 +152,13 @@ static void button_event_task(void *pvParameters)
     while (1)
     {
         if (xSemaphoreTake(xButtonSemaphore, portMAX_DELAY) == pdTRUE) {
-            stats.button_presses++;
+            shard_stats_inc(&stats, STAT_BUTTON);
             ESP_LOGI(TAG, "🔘 Button: Press detected #%lu",
-                     (unsigned long)stats.button_presses);
+                     (unsigned long)shard_stats_sum(&stats, STAT_BUTTON));
             vTaskDelay(pdMS_TO_TICKS(250)); // debounce
             ESP_LOGI(TAG, "🚀 Button: Triggering immediate producer event");
             xSemaphoreGive(xBinarySemaphore);
-            stats.signals_sent++;
+            shard_stats_inc(&stats, STAT_SENT);
         }
     }
 }
@@ -158,6 +170,7 @@ static void monitor_task(void *pvParameters)
     while (1)
     {
         vTaskDelay(pdMS_TO_TICKS(15000));
+        semaphore_stats_t now = stats_read();
         ESP_LOGI(TAG, "\n═══ SEMAPHORE SYSTEM MONITOR (E3) ═══");
         ESP_LOGI(TAG, "Binary Available: %s",
                  uxSemaphoreGetCount(xBinarySemaphore) ? "YES" : "NO");
@@ -165,14 +178,14 @@ static void monitor_task(void *pvParameters)
         ESP_LOGI(TAG, "Button Count: %u", (unsigned)uxSemaphoreGetCount(xButtonSemaphore));
 
         ESP_LOGI(TAG, "Stats:");
-        ESP_LOGI(TAG, "  Producer Events : %lu", (unsigned long)stats.signals_sent);
-        ESP_LOGI(TAG, "  Consumer Events : %lu", (unsigned long)stats.signals_received);
-        ESP_LOGI(TAG, "  Consumer Timeouts: %lu", (unsigned long)stats.consumer_timeouts);
-        ESP_LOGI(TAG, "  Timer Events    : %lu", (unsigned long)stats.timer_events);
-        ESP_LOGI(TAG, "  Button Presses  : %lu", (unsigned long)stats.button_presses);
-
-        float efficiency = stats.signals_sent > 0 ?
-                           (float)stats.signals_received / (float)stats.signals_sent * 100.0f : 0.0f;
+        ESP_LOGI(TAG, "  Producer Events : %lu", (unsigned long)now.signals_sent);
+        ESP_LOGI(TAG, "  Consumer Events : %lu", (unsigned long)now.signals_received);
+        ESP_LOGI(TAG, "  Consumer Timeouts: %lu", (unsigned long)now.consumer_timeouts);
+        ESP_LOGI(TAG, "  Timer Events    : %lu", (unsigned long)now.timer_events);
+        ESP_LOGI(TAG, "  Button Presses  : %lu", (unsigned long)now.button_presses);
+
+        float efficiency = now.signals_sent > 0 ?
+                           (float)now.signals_received / (float)now.signals_sent * 100.0f : 0.0f;
         ESP_LOGI(TAG, "  System Efficiency: %.1f%%", efficiency);
         ESP_LOGI(TAG, "════════════════════════════════════\n");
     }
@@ -182,6 +195,7 @@ static void monitor_task(void *pvParameters)
 void app_main(void)
 {
     ESP_LOGI(TAG, "Experiment #3 (Short Timeout) Starting...");
+    shard_stats_init(&stats);
 
     // LEDs
     gpio_config_t io = {
@@ -8,6 +8,10 @@
 #include "esp_log.h"
 #include "driver/gpio.h"
 #include "esp_random.h"
+#include "shard_stats.h"
+#include "res_pool.h"
+#include "lat_hist.h"
+#include "esp_timer.h"
 
 static const char *TAG = "COUNTING_SEM_EXP3";
 
@@ -30,7 +34,23 @@ static const gpio_num_t LED_RESOURCE_PINS[MAX_RESOURCES] = {
 #define LED_SYSTEM   GPIO_NUM_19
 /* ========================================================= */
 
-SemaphoreHandle_t xCountingSemaphore;
+// counting semaphore + bitmap ของ slot ว่าง: take สำเร็จ = ได้ index ของ resource ทันที (O(1))
+// เดิม take แล้วค่อย scan resources[] หา !in_use แบบไม่มี lock -> สอง producer ที่ take พร้อมกันแย่ง slot เดียวกันได้
+static res_pool_t pool;
+
+// ลำดับการแจก resource
+// RES_POOL_BARGE = counting semaphore ปกติ: priority ก่อน แล้วแต่ใครตื่น/รันถึงก่อน (คนที่เพิ่งคืนวนมาแย่งต่อได้)
+// RES_POOL_FIFO  = ส่งต่อให้ผู้รอที่มาก่อนภายใน priority เดียวกัน (LoadGen priority สูงกว่ายังแซงได้)
+// ค่าเริ่มต้นคงพฤติกรรมเดิมของ lab (BARGE) -> เปลี่ยนเป็น RES_POOL_FIFO เพื่อดู wait/p99 ต่อผู้ขอที่เท่ากันขึ้น
+// เทียบสองโหมดต่อกันโดยไม่ต้อง reflash: res_pool_bench (ส่วน burst จำลอง lab นี้ ย่อเวลา 10 เท่า)
+#define POOL_MODE       RES_POOL_BARGE
+
+// wait time ต่อผู้ขอ (ช่องสุดท้าย = LoadGen) สะสมตลอดการรัน เพื่อเทียบ tail กับ timeout ระหว่างสองโหมด
+#define REQUESTERS      (NUM_PRODUCERS + 1)
+#define LOADGEN_ID      NUM_PRODUCERS
+
+static lat_hist_t       wait_hist[REQUESTERS];
+static _Atomic uint32_t timeouts_by[REQUESTERS];
 
 typedef struct {
     int  resource_id;
@@ -49,25 +69,39 @@ typedef struct {
     uint32_t resources_in_use;
 } system_stats_t;
 
-static system_stats_t stats = {0};
+// producer 8 ตัว + LoadGen บนสอง core -> นับลง shard ต่อ core แล้วรวมตอนอ่าน
+enum { STAT_REQUESTS, STAT_ACQUIRED, STAT_FAILED, STAT_IN_USE, STAT_COUNT };
+
+static shard_stats_t stats;
+
+static system_stats_t stats_read(void)
+{
+    uint32_t v[STAT_COUNT];
+    shard_stats_read(&stats, v, STAT_COUNT);
+    return (system_stats_t){ v[STAT_REQUESTS], v[STAT_ACQUIRED], v[STAT_FAILED], v[STAT_IN_USE] };
+}
 
 static inline void led_on(int idx){ if (idx>=0 && idx<MAX_RESOURCES) gpio_set_level(LED_RESOURCE_PINS[idx], 1); }
 static inline void led_off(int idx){ if (idx>=0 && idx<MAX_RESOURCES) gpio_set_level(LED_RESOURCE_PINS[idx], 0); }
 
-static int acquire_resource(const char* user_name)
+// คืน index ของ resource ที่ได้, -1 = หมดเวลา wait
+static int acquire_resource(int requester, const char* user_name, TickType_t wait)
 {
-    for (int i = 0; i < MAX_RESOURCES; i++) {
-        if (!resources[i].in_use) {
-            resources[i].in_use = true;
-            strncpy(resources[i].current_user, user_name, sizeof(resources[i].current_user)-1);
-            resources[i].current_user[sizeof(resources[i].current_user)-1] = '\0';
-            resources[i].usage_count++;
-            led_on(i);
-            stats.resources_in_use++;
-            return i;
-        }
+    int64_t t0 = esp_timer_get_time();
+    int i = res_pool_acquire(&pool, wait);
+    if (i < 0) {
+        atomic_fetch_add(&timeouts_by[requester], 1);
+        return -1;
     }
-    return -1;
+    lat_hist_record_since(&wait_hist[requester], t0);
+    // slot เป็นของเราคนเดียวจน release -> เขียนข้อมูลต่อ slot ได้โดยไม่ต้อง lock
+    resources[i].in_use = true;
+    strncpy(resources[i].current_user, user_name, sizeof(resources[i].current_user)-1);
+    resources[i].current_user[sizeof(resources[i].current_user)-1] = '\0';
+    resources[i].usage_count++;
+    led_on(i);
+    shard_stats_inc(&stats, STAT_IN_USE);
+    return i;
 }
 
 static void release_resource(int idx, uint32_t use_ms)
@@ -77,7 +111,8 @@ static void release_resource(int idx, uint32_t use_ms)
         resources[idx].total_usage_time_ms += use_ms;
         resources[idx].current_user[0] = '\0';
         led_off(idx);
-        if (stats.resources_in_use) stats.resources_in_use--;
+        shard_stats_sub(&stats, STAT_IN_USE, 1);
+        res_pool_release(&pool, idx);       // คืนหลังเคลียร์ข้อมูล slot เสร็จ
     }
 }
 
@@ -88,7 +123,7 @@ static void producer_task(void *pvParameters)
     ESP_LOGI(TAG, "%s started", name);
 
     while (1) {
-        stats.total_requests++;
+        shard_stats_inc(&stats, STAT_REQUESTS);
 
         // แสดงว่ามีคำขอเข้า queue
         gpio_set_level(LED_PRODUCER, 1);
@@ -98,27 +133,20 @@ static void producer_task(void *pvParameters)
         TickType_t t0 = xTaskGetTickCount();
 
         // รอสูงสุด 8 วินาที ให้เกิดโอกาส timeout ในบางช่วงโหลดสูง
-        if (xSemaphoreTake(xCountingSemaphore, pdMS_TO_TICKS(8000)) == pdTRUE) {
+        int idx = acquire_resource(id - 1, name, pdMS_TO_TICKS(8000));
+        if (idx >= 0) {
             uint32_t wait_ms = (xTaskGetTickCount() - t0) * portTICK_PERIOD_MS;
-            stats.successful_acquisitions++;
-
-            int idx = acquire_resource(name);
-            if (idx >= 0) {
-                // ใช้งานทรัพยากร 1–4 วินาที
-                uint32_t use_ms = 1000 + (esp_random() % 3000);
-                ESP_LOGI(TAG, "✓ %s: Acquired R%d (wait:%ums), using %ums",
-                         name, idx+1, wait_ms, use_ms);
-                vTaskDelay(pdMS_TO_TICKS(use_ms));
-                release_resource(idx, use_ms);
-                xSemaphoreGive(xCountingSemaphore);
-                ESP_LOGI(TAG, "✓ %s: Released R%d", name, idx+1);
-            } else {
-                // ป้องกันกรณีผิดพลาด
-                ESP_LOGE(TAG, "✗ %s: Took semaphore but no resource free!", name);
-                xSemaphoreGive(xCountingSemaphore);
-            }
+            shard_stats_inc(&stats, STAT_ACQUIRED);
+
+            // ใช้งานทรัพยากร 1–4 วินาที
+            uint32_t use_ms = 1000 + (esp_random() % 3000);
+            ESP_LOGI(TAG, "✓ %s: Acquired R%d (wait:%ums), using %ums",
+                     name, idx+1, wait_ms, use_ms);
+            vTaskDelay(pdMS_TO_TICKS(use_ms));
+            release_resource(idx, use_ms);
+            ESP_LOGI(TAG, "✓ %s: Released R%d", name, idx+1);
         } else {
-            stats.failed_acquisitions++;
+            shard_stats_inc(&stats, STAT_FAILED);
             ESP_LOGW(TAG, "⏰ %s: Timeout waiting for resource", name);
             // backoff เล็กน้อยก่อนลองใหม่
             vTaskDelay(pdMS_TO_TICKS(500 + (esp_random()%500)));
@@ -133,7 +161,7 @@ static void resource_monitor_task(void *pvParameters)
 {
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(5000));
-        int available = uxSemaphoreGetCount(xCountingSemaphore);
+        int available = res_pool_available(&pool);
         int used = MAX_RESOURCES - available;
 
         ESP_LOGI(TAG, "\n📊 RESOURCE POOL STATUS");
@@ -158,19 +186,40 @@ static void statistics_task(void *pvParameters)
 {
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(12000));
+        system_stats_t now = stats_read();
         ESP_LOGI(TAG, "\n📈 SYSTEM STATISTICS");
-        ESP_LOGI(TAG, "Total requests: %lu", stats.total_requests);
-        ESP_LOGI(TAG, "Successful acquisitions: %lu", stats.successful_acquisitions);
-        ESP_LOGI(TAG, "Failed acquisitions: %lu", stats.failed_acquisitions);
-        ESP_LOGI(TAG, "Current in use: %lu", stats.resources_in_use);
-        if (stats.total_requests) {
-            float ok = (float)stats.successful_acquisitions * 100.0f / (float)stats.total_requests;
+        ESP_LOGI(TAG, "Total requests: %lu", now.total_requests);
+        ESP_LOGI(TAG, "Successful acquisitions: %lu", now.successful_acquisitions);
+        ESP_LOGI(TAG, "Failed acquisitions: %lu", now.failed_acquisitions);
+        ESP_LOGI(TAG, "Current in use: %lu (peak %lu, CAS retries %lu)", now.resources_in_use,
+                 (unsigned long)atomic_load(&pool.peak_in_use), (unsigned long)atomic_load(&pool.cas_retries));
+        if (now.total_requests) {
+            float ok = (float)now.successful_acquisitions * 100.0f / (float)now.total_requests;
             ESP_LOGI(TAG, "Success rate: %.1f%%", ok);
         }
         for (int i = 0; i < MAX_RESOURCES; i++) {
             ESP_LOGI(TAG, "  R%d: %lu uses, %lums total",
                      i+1, resources[i].usage_count, resources[i].total_usage_time_ms);
         }
+        // wait time ต่อผู้ขอ (สะสม) -> producer ที่โดนแซงบ่อยจะมี p99/timeout โดดขึ้นมา
+        ESP_LOGI(TAG, "Wait per requester (%s):", res_pool_mode_name(POOL_MODE));
+        uint32_t worst_p99 = 0, total_timeouts = 0;
+        for (int r = 0; r < REQUESTERS; r++) {
+            lat_hist_snapshot_t w;
+            lat_hist_snapshot(&wait_hist[r], &w, false);
+            uint32_t to = atomic_load(&timeouts_by[r]);
+            char who[20];
+            if (r == LOADGEN_ID) snprintf(who, sizeof(who), "LoadGen");
+            else                 snprintf(who, sizeof(who), "Producer%d", r + 1);
+            ESP_LOGI(TAG, "  %-10s n=%-4lu p50=%5lums p99=%5lums max=%5lums timeouts=%lu", who,
+                     (unsigned long)w.count, (unsigned long)(w.p50_us / 1000), (unsigned long)(w.p99_us / 1000),
+                     (unsigned long)(w.max_us / 1000), (unsigned long)to);
+            if (r != LOADGEN_ID && w.p99_us > worst_p99) worst_p99 = w.p99_us;
+            total_timeouts += to;
+        }
+        ESP_LOGI(TAG, "Worst producer p99 wait: %lums | timeouts: %lu | handoffs: %lu",
+                 (unsigned long)(worst_p99 / 1000), (unsigned long)total_timeouts,
+                 (unsigned long)atomic_load(&pool.handoffs));
         ESP_LOGI(TAG, "────────────────────────────\n");
     }
 }
@@ -185,13 +234,10 @@ static void load_generator_task(void *pvParameters)
 
         for (int round = 0; round < 3; round++) {
             for (int i = 0; i < MAX_RESOURCES + 3; i++) {
-                if (xSemaphoreTake(xCountingSemaphore, pdMS_TO_TICKS(100)) == pdTRUE) {
-                    int idx = acquire_resource("LoadGen");
-                    if (idx >= 0) {
-                        vTaskDelay(pdMS_TO_TICKS(400));
-                        release_resource(idx, 400);
-                    }
-                    xSemaphoreGive(xCountingSemaphore);
+                int idx = acquire_resource(LOADGEN_ID, "LoadGen", pdMS_TO_TICKS(100));
+                if (idx >= 0) {
+                    vTaskDelay(pdMS_TO_TICKS(400));
+                    release_resource(idx, 400);
                 }
                 vTaskDelay(pdMS_TO_TICKS(150));
             }
@@ -205,7 +251,9 @@ static void load_generator_task(void *pvParameters)
 
 void app_main(void)
 {
-    ESP_LOGI(TAG, "Experiment 3: 3 Resources, 8 Producers");
+    ESP_LOGI(TAG, "Experiment 3: 3 Resources, 8 Producers (grant order: %s)", res_pool_mode_name(POOL_MODE));
+
+    shard_stats_init(&stats);
 
     // init resource table
     for (int i = 0; i < MAX_RESOURCES; i++) {
@@ -226,9 +274,10 @@ void app_main(void)
     gpio_set_level(LED_PRODUCER, 0);
     gpio_set_level(LED_SYSTEM, 0);
 
-    // Counting semaphore
-    xCountingSemaphore = xSemaphoreCreateCounting(MAX_RESOURCES, MAX_RESOURCES);
-    if (!xCountingSemaphore) { ESP_LOGE(TAG, "Create semaphore failed"); return; }
+    for (int r = 0; r < REQUESTERS; r++) lat_hist_init(&wait_hist[r]);
+
+    // Counting semaphore + bitmap
+    if (!res_pool_create(&pool, MAX_RESOURCES, POOL_MODE)) { ESP_LOGE(TAG, "Create semaphore failed"); return; }
 
     // Producers
     static int ids[NUM_PRODUCERS];
@@ -0,0 +1,366 @@
+// main/res_pool_bench.c — แจก resource จาก counting semaphore: scan เดิม vs bitmap O(1) vs FIFO handoff
+//
+// requester REQUESTERS ตัว (สลับ core 0/1, priority เท่ากัน) แย่ง resource RESOURCES ชิ้น
+// แต่ละรอบ: acquire -> ถือ HOLD_US -> release, ทำ OPS_PER_REQ รอบ
+//   scan       = take semaphore แล้ว scan in_use[] หา slot ว่างแบบไม่มี lock (เหมือน acquire_resource เดิม)
+//   scan+mutex = scan เหมือนกันแต่อยู่ใต้ mutex (ถูกต้อง แต่ O(n) + lock)
+//   bitmap     = res_pool: take แล้วจอง bit ด้วย ctz + CAS
+//   fifo       = res_pool แบบ RES_POOL_FIFO: release ส่ง slot ให้ผู้รอที่มาก่อนโดยตรง
+// collisions = slot ที่มีเจ้าของมากกว่า 1 คนพร้อมกัน (ต้องเป็น 0 ถ้าถูกต้อง)
+// fairness   = ค่าเฉลี่ย wait ของ requester ที่แย่ที่สุดเทียบกับที่ดีที่สุด (ห่างมาก = ไม่ fair)
+//
+// burst: จำลอง counting_semaphores.c ย่อเวลาลง 10 เท่า แล้วรัน barge กับ fifo ต่อกัน (ไม่ต้องแก้ POOL_MODE แล้ว flash ใหม่)
+//   producer BURST_PRODUCERS ตัว acquire แบบมี timeout แย่ง BURST_RESOURCES ชิ้น
+//   + LoadGen priority สูงกว่ายิงเป็นชุดแบบ load_generator_task -> วัด p99 wait และ timeout ต่อผู้ขอ
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "esp_random.h"
+#include "res_pool.h"
+#include "lat_hist.h"
+
+static const char *TAG = "RES_POOL_BENCH";
+
+// ===== Config =====
+#define RESOURCES       32
+#define REQUESTERS      64
+#define OPS_PER_REQ     200
+#define HOLD_US         20
+#define BENCH_PRIO      5
+#define REQ_STACK       2048
+
+// burst (ค่าใน counting_semaphores.c / 10)
+#define BURST_RESOURCES     3               // MAX_RESOURCES
+#define BURST_PRODUCERS     8               // NUM_PRODUCERS
+#define BURST_RUN_MS        20000           // LoadGen ยิงราว 6 ชุด (รอบละ ~3.2 s)
+#define PROD_TIMEOUT_MS     800
+#define PROD_USE_MIN_MS     100
+#define PROD_USE_SPAN_MS    300
+#define PROD_GAP_MIN_MS     200
+#define PROD_GAP_SPAN_MS    300
+#define PROD_PRIO           3
+#define LOADGEN_PRIO        4
+#define LOADGEN_PERIOD_MS   2000
+#define LOADGEN_TIMEOUT_MS  10
+#define LOADGEN_HOLD_MS     40
+#define LOADGEN_GAP_MS      15
+#define LOADGEN_ROUND_MS    70
+#define BURST_REQUESTERS    (BURST_PRODUCERS + 1)
+#define BURST_LOADGEN_ID    BURST_PRODUCERS
+
+typedef enum { MODE_SCAN = 0, MODE_SCAN_MUTEX, MODE_BITMAP, MODE_FIFO, MODE_COUNT } bench_mode_t;
+static const char* const MODE_NAMES[MODE_COUNT] = { "scan", "scan+mutex", "bitmap", "fifo" };
+
+static inline bool uses_pool(bench_mode_t m) { return m == MODE_BITMAP || m == MODE_FIFO; }
+
+typedef struct {
+    bench_mode_t      mode;
+    SemaphoreHandle_t sem;                  // scan modes
+    SemaphoreHandle_t mutex;
+    volatile bool     in_use[RESOURCES];
+    res_pool_t        pool;                 // bitmap / fifo
+    _Atomic uint32_t  owners[RESOURCES];    // ตรวจว่ามีเจ้าของซ้อนกันไหม
+    _Atomic uint32_t  collisions;
+    _Atomic uint32_t  no_slot;              // take ได้แต่ scan ไม่เจอ slot ว่าง
+    _Atomic uint32_t  scan_steps;
+    _Atomic uint32_t  done;
+    TaskHandle_t      notify;
+    lat_hist_t        acquire_lat;
+    uint64_t          wait_sum_us[REQUESTERS];  // เขียนโดย requester เจ้าของช่องเท่านั้น
+} bench_ctx_t;
+
+typedef struct {
+    double   ops_per_s;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+    uint32_t collisions;
+    uint32_t no_slot;
+    double   avg_scan;
+    uint32_t cas_retries;
+    double   worst_avg_us;          // requester ที่รอเฉลี่ยนานสุด
+    double   best_avg_us;
+} bench_result_t;
+
+static bench_ctx_t ctx;
+
+// ===== Acquire / Release =====
+static int scan_slot(void) {
+    for (int i = 0; i < RESOURCES; i++) {
+        atomic_fetch_add_explicit(&ctx.scan_steps, 1, memory_order_relaxed);
+        if (!ctx.in_use[i]) {
+            ctx.in_use[i] = true;
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int bench_acquire(void) {
+    if (uses_pool(ctx.mode)) return res_pool_acquire(&ctx.pool, portMAX_DELAY);
+
+    xSemaphoreTake(ctx.sem, portMAX_DELAY);
+    if (ctx.mode == MODE_SCAN_MUTEX) xSemaphoreTake(ctx.mutex, portMAX_DELAY);
+    int slot = scan_slot();
+    if (ctx.mode == MODE_SCAN_MUTEX) xSemaphoreGive(ctx.mutex);
+    if (slot < 0) {
+        atomic_fetch_add_explicit(&ctx.no_slot, 1, memory_order_relaxed);
+        xSemaphoreGive(ctx.sem);
+    }
+    return slot;
+}
+
+static void bench_release(int slot) {
+    if (uses_pool(ctx.mode)) {
+        res_pool_release(&ctx.pool, slot);
+        return;
+    }
+    ctx.in_use[slot] = false;
+    xSemaphoreGive(ctx.sem);
+}
+
+static void requester_task(void *pv) {
+    int id = (int)(intptr_t)pv;
+    for (int i = 0; i < OPS_PER_REQ; i++) {
+        int64_t t0 = esp_timer_get_time();
+        int slot = bench_acquire();
+        if (slot < 0) continue;
+        uint32_t waited = (uint32_t)(esp_timer_get_time() - t0);
+        lat_hist_record(&ctx.acquire_lat, waited);
+        ctx.wait_sum_us[id] += waited;
+
+        if (atomic_fetch_add(&ctx.owners[slot], 1) != 0) atomic_fetch_add(&ctx.collisions, 1);
+        esp_rom_delay_us(HOLD_US);
+        atomic_fetch_sub(&ctx.owners[slot], 1);
+
+        bench_release(slot);
+        taskYIELD();
+    }
+    if (atomic_fetch_add(&ctx.done, 1) + 1 == REQUESTERS) xTaskNotifyGive(ctx.notify);
+    vTaskDelete(NULL);
+}
+
+// ===== Burst (timeout-bounded) =====
+typedef struct {
+    res_pool_t        pool;
+    volatile bool     stop;
+    _Atomic uint32_t  done;
+    TaskHandle_t      notify;
+    lat_hist_t        wait_hist[BURST_REQUESTERS];
+    _Atomic uint32_t  timeouts_by[BURST_REQUESTERS];
+} burst_ctx_t;
+
+typedef struct {
+    uint32_t acquired;
+    uint32_t timeouts;              // producer ทั้งหมด
+    uint32_t worst_p99_ms;          // producer ที่ p99 แย่สุด
+    uint32_t worst_max_ms;
+    uint32_t loadgen_ok;
+    uint32_t loadgen_timeouts;
+    uint32_t handoffs;
+} burst_result_t;
+
+static burst_ctx_t bctx;
+
+static int burst_acquire(int requester, uint32_t timeout_ms) {
+    int64_t t0 = esp_timer_get_time();
+    int slot = res_pool_acquire(&bctx.pool, pdMS_TO_TICKS(timeout_ms));
+    if (slot < 0) atomic_fetch_add(&bctx.timeouts_by[requester], 1);
+    else          lat_hist_record_since(&bctx.wait_hist[requester], t0);
+    return slot;
+}
+
+static void burst_finish(void) {
+    if (atomic_fetch_add(&bctx.done, 1) + 1 == BURST_REQUESTERS) xTaskNotifyGive(bctx.notify);
+    vTaskDelete(NULL);
+}
+
+static void burst_producer_task(void *pv) {
+    int id = (int)(intptr_t)pv;
+    while (!bctx.stop) {
+        int slot = burst_acquire(id, PROD_TIMEOUT_MS);
+        if (slot >= 0) {
+            vTaskDelay(pdMS_TO_TICKS(PROD_USE_MIN_MS + esp_random() % PROD_USE_SPAN_MS));
+            res_pool_release(&bctx.pool, slot);
+        }
+        vTaskDelay(pdMS_TO_TICKS(PROD_GAP_MIN_MS + esp_random() % PROD_GAP_SPAN_MS));
+    }
+    burst_finish();
+}
+
+static void burst_loadgen_task(void *pv) {
+    while (!bctx.stop) {
+        vTaskDelay(pdMS_TO_TICKS(LOADGEN_PERIOD_MS));
+        for (int round = 0; round < 3 && !bctx.stop; round++) {
+            for (int i = 0; i < BURST_RESOURCES + 3; i++) {
+                int slot = burst_acquire(BURST_LOADGEN_ID, LOADGEN_TIMEOUT_MS);
+                if (slot >= 0) {
+                    vTaskDelay(pdMS_TO_TICKS(LOADGEN_HOLD_MS));
+                    res_pool_release(&bctx.pool, slot);
+                }
+                vTaskDelay(pdMS_TO_TICKS(LOADGEN_GAP_MS));
+            }
+            vTaskDelay(pdMS_TO_TICKS(LOADGEN_ROUND_MS));
+        }
+    }
+    burst_finish();
+}
+
+static bool run_burst(res_pool_mode_t mode, burst_result_t* r) {
+    memset(&bctx, 0, sizeof(bctx));
+    bctx.notify = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < BURST_REQUESTERS; i++) lat_hist_init(&bctx.wait_hist[i]);
+    if (!res_pool_create(&bctx.pool, BURST_RESOURCES, mode)) return false;
+
+    for (int i = 0; i < BURST_PRODUCERS; i++) {
+        xTaskCreate(burst_producer_task, "rp_prod", REQ_STACK, (void*)(intptr_t)i, PROD_PRIO, NULL);
+    }
+    xTaskCreate(burst_loadgen_task, "rp_load", REQ_STACK, NULL, LOADGEN_PRIO, NULL);
+    vTaskDelay(pdMS_TO_TICKS(BURST_RUN_MS));
+    bctx.stop = true;
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);    // ทุก acquire มี timeout -> จบภายในไม่กี่ร้อย ms
+
+    for (int i = 0; i < BURST_REQUESTERS; i++) {
+        lat_hist_snapshot_t w;
+        lat_hist_snapshot(&bctx.wait_hist[i], &w, false);
+        uint32_t to = atomic_load(&bctx.timeouts_by[i]);
+        if (i == BURST_LOADGEN_ID) {
+            r->loadgen_ok = w.count;
+            r->loadgen_timeouts = to;
+            continue;
+        }
+        r->acquired += w.count;
+        r->timeouts += to;
+        if (w.p99_us / 1000 > r->worst_p99_ms) r->worst_p99_ms = w.p99_us / 1000;
+        if (w.max_us / 1000 > r->worst_max_ms) r->worst_max_ms = w.max_us / 1000;
+    }
+    r->handoffs = atomic_load(&bctx.pool.handoffs);
+
+    vTaskDelay(pdMS_TO_TICKS(50));
+    res_pool_destroy(&bctx.pool);
+    return true;
+}
+
+// ===== Runner =====
+static bool run_one(bench_mode_t mode, bench_result_t* r) {
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.mode = mode;
+    ctx.notify = xTaskGetCurrentTaskHandle();
+    lat_hist_init(&ctx.acquire_lat);
+
+    if (uses_pool(mode)) {
+        if (!res_pool_create(&ctx.pool, RESOURCES, mode == MODE_FIFO ? RES_POOL_FIFO : RES_POOL_BARGE)) return false;
+    } else {
+        ctx.sem = xSemaphoreCreateCounting(RESOURCES, RESOURCES);
+        ctx.mutex = xSemaphoreCreateMutex();
+        if (!ctx.sem || !ctx.mutex) {
+            if (ctx.sem) vSemaphoreDelete(ctx.sem);
+            if (ctx.mutex) vSemaphoreDelete(ctx.mutex);
+            return false;
+        }
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    for (int i = 0; i < REQUESTERS; i++) {
+        xTaskCreatePinnedToCore(requester_task, "rp_req", REQ_STACK, (void*)(intptr_t)i, BENCH_PRIO, NULL,
+                                i % portNUM_PROCESSORS);
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t dt = esp_timer_get_time() - t0;
+
+    uint32_t ops = REQUESTERS * OPS_PER_REQ - atomic_load(&ctx.no_slot);
+    lat_hist_snapshot_t snap;
+    lat_hist_snapshot(&ctx.acquire_lat, &snap, false);
+    r->ops_per_s = dt > 0 ? (double)ops * 1e6 / (double)dt : 0.0;
+    r->p50_us = snap.p50_us;
+    r->p99_us = snap.p99_us;
+    r->max_us = snap.max_us;
+    r->collisions = atomic_load(&ctx.collisions);
+    r->no_slot = atomic_load(&ctx.no_slot);
+    r->avg_scan = uses_pool(mode) ? 0.0 : (double)atomic_load(&ctx.scan_steps) / (REQUESTERS * OPS_PER_REQ);
+    r->cas_retries = uses_pool(mode) ? atomic_load(&ctx.pool.cas_retries) : 0;
+    r->best_avg_us = -1.0;
+    for (int i = 0; i < REQUESTERS; i++) {
+        double avg = (double)ctx.wait_sum_us[i] / OPS_PER_REQ;
+        if (avg > r->worst_avg_us) r->worst_avg_us = avg;
+        if (r->best_avg_us < 0 || avg < r->best_avg_us) r->best_avg_us = avg;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(50));      // ให้ requester ลบตัวเองเสร็จ (idle คืน stack)
+    if (uses_pool(mode)) {
+        res_pool_destroy(&ctx.pool);
+    } else {
+        vSemaphoreDelete(ctx.sem);
+        vSemaphoreDelete(ctx.mutex);
+    }
+    return true;
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "Resource pool benchmark: %u resources, %u requesters x %u ops, hold %u us",
+             RESOURCES, REQUESTERS, OPS_PER_REQ, HOLD_US);
+
+    bench_result_t res[MODE_COUNT];
+    memset(res, 0, sizeof(res));
+    for (int m = 0; m < MODE_COUNT; m++) {
+        if (!run_one((bench_mode_t)m, &res[m])) ESP_LOGE(TAG, "%s: setup failed", MODE_NAMES[m]);
+    }
+
+    printf("\n=== %u resources / %u requesters ===\n", RESOURCES, REQUESTERS);
+    printf("%-11s %10s %7s %7s %8s %10s %8s %9s %8s %10s %10s\n",
+           "mode", "ops/s", "p50 us", "p99 us", "max us", "collisions", "no slot", "avg scan", "CAS retry",
+           "worst avg", "best avg");
+    for (int m = 0; m < MODE_COUNT; m++) {
+        const bench_result_t* r = &res[m];
+        printf("%-11s %10.0f %7lu %7lu %8lu %10lu %8lu %9.1f %8lu %10.1f %10.1f\n", MODE_NAMES[m], r->ops_per_s,
+               (unsigned long)r->p50_us, (unsigned long)r->p99_us, (unsigned long)r->max_us,
+               (unsigned long)r->collisions, (unsigned long)r->no_slot, r->avg_scan,
+               (unsigned long)r->cas_retries, r->worst_avg_us, r->best_avg_us);
+    }
+    // summary,<mode>,<ops/s>,<p50_us>,<p99_us>,<max_us>,<collisions>,<no_slot>,<avg_scan>,<cas_retries>,<worst_avg_us>,<best_avg_us>
+    for (int m = 0; m < MODE_COUNT; m++) {
+        const bench_result_t* r = &res[m];
+        printf("summary,%s,%.0f,%lu,%lu,%lu,%lu,%lu,%.1f,%lu,%.1f,%.1f\n", MODE_NAMES[m], r->ops_per_s,
+               (unsigned long)r->p50_us, (unsigned long)r->p99_us, (unsigned long)r->max_us,
+               (unsigned long)r->collisions, (unsigned long)r->no_slot, r->avg_scan,
+               (unsigned long)r->cas_retries, r->worst_avg_us, r->best_avg_us);
+    }
+
+    // barge vs fifo ภายใต้ LoadGen burst (acquire มี timeout)
+    static const res_pool_mode_t BURST_MODES[] = { RES_POOL_BARGE, RES_POOL_FIFO };
+    const size_t burst_count = sizeof(BURST_MODES) / sizeof(BURST_MODES[0]);
+    burst_result_t bres[sizeof(BURST_MODES) / sizeof(BURST_MODES[0])];
+    memset(bres, 0, sizeof(bres));
+    for (size_t m = 0; m < burst_count; m++) {
+        if (!run_burst(BURST_MODES[m], &bres[m])) ESP_LOGE(TAG, "burst %s: setup failed", res_pool_mode_name(BURST_MODES[m]));
+    }
+
+    printf("\n=== burst: %u resources / %u producers + LoadGen, timeout %u ms, %u ms ===\n",
+           BURST_RESOURCES, BURST_PRODUCERS, PROD_TIMEOUT_MS, BURST_RUN_MS);
+    printf("%-6s %9s %9s %12s %12s %8s %11s %9s\n",
+           "mode", "acquired", "timeouts", "worst p99ms", "worst max ms", "load ok", "load t/out", "handoffs");
+    for (size_t m = 0; m < burst_count; m++) {
+        const burst_result_t* r = &bres[m];
+        printf("%-6s %9lu %9lu %12lu %12lu %8lu %11lu %9lu\n", res_pool_mode_name(BURST_MODES[m]),
+               (unsigned long)r->acquired, (unsigned long)r->timeouts, (unsigned long)r->worst_p99_ms,
+               (unsigned long)r->worst_max_ms, (unsigned long)r->loadgen_ok, (unsigned long)r->loadgen_timeouts,
+               (unsigned long)r->handoffs);
+    }
+    // summary,burst-<mode>,<acquired>,<timeouts>,<worst_p99_ms>,<worst_max_ms>,<loadgen_ok>,<loadgen_timeouts>,<handoffs>
+    for (size_t m = 0; m < burst_count; m++) {
+        const burst_result_t* r = &bres[m];
+        printf("summary,burst-%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n", res_pool_mode_name(BURST_MODES[m]),
+               (unsigned long)r->acquired, (unsigned long)r->timeouts, (unsigned long)r->worst_p99_ms,
+               (unsigned long)r->worst_max_ms, (unsigned long)r->loadgen_ok, (unsigned long)r->loadgen_timeouts,
+               (unsigned long)r->handoffs);
+    }
+    ESP_LOGI(TAG, "Benchmark done");
+}
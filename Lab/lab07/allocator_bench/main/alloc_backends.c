@@ -0,0 +1,219 @@
+#include <stdlib.h>
+#include <string.h>
+#ifdef __GLIBC__
+#include <malloc.h>         // malloc_usable_size()
+#endif
+#include "alloc_backends.h"
+#include "tlsf_arena.h"
+#include "buddy_arena.h"
+
+// ===== 1) System heap (host malloc) =====
+// ไม่มี arena ให้วัด fragmentation ได้ ใช้เป็นเส้นฐานด้าน throughput
+static size_t sys_used = 0;
+
+static bool sys_init(size_t arena_bytes) { (void)arena_bytes; sys_used = 0; return true; }
+static void sys_deinit(void) {}
+
+static size_t sys_block_size(void* p, size_t fallback) {
+#ifdef __GLIBC__
+    (void)fallback;
+    return malloc_usable_size(p);
+#else
+    return fallback;
+#endif
+}
+
+static void* sys_alloc(size_t size) {
+    void* p = malloc(size);
+    if (p) sys_used += sys_block_size(p, size);
+    return p;
+}
+
+static void sys_release(void* ptr) {
+    if (!ptr) return;
+    sys_used -= sys_block_size(ptr, 0);
+    free(ptr);
+}
+
+static void sys_usage(backend_usage_t* out) {
+    memset(out, 0, sizeof(*out));
+    out->used_bytes = sys_used;
+}
+
+const alloc_backend_t backend_sys = {
+    "sys", sys_init, sys_deinit, sys_alloc, sys_release, sys_usage
+};
+
+// ===== 2) TLSF arena (โมเดล heap_caps_malloc บนบอร์ด) =====
+static tlsf_arena_t g_tlsf;
+static void*        g_tlsf_mem = NULL;
+static size_t       g_tlsf_bytes = 0;
+
+static bool tlsf_init(size_t arena_bytes) {
+    g_tlsf_mem = malloc(arena_bytes);
+    g_tlsf_bytes = arena_bytes;
+    return g_tlsf_mem && tlsf_arena_init(&g_tlsf, g_tlsf_mem, arena_bytes);
+}
+
+static void tlsf_deinit(void) {
+    free(g_tlsf_mem);
+    g_tlsf_mem = NULL;
+}
+
+static void* tlsf_alloc(size_t size) { return tlsf_arena_malloc(&g_tlsf, size); }
+static void  tlsf_release(void* p)   { tlsf_arena_free(&g_tlsf, p); }
+
+static void tlsf_usage(backend_usage_t* out) {
+    memset(out, 0, sizeof(*out));
+    out->arena_bytes  = g_tlsf_bytes;
+    out->used_bytes   = g_tlsf.used_bytes;
+    out->free_bytes   = g_tlsf.free_bytes;
+    out->largest_free = tlsf_arena_largest_free(&g_tlsf);
+}
+
+const alloc_backend_t backend_tlsf = {
+    "tlsf", tlsf_init, tlsf_deinit, tlsf_alloc, tlsf_release, tlsf_usage
+};
+
+// ===== 3) Pools (port ของ memory_pools.c) =====
+// config/ header/ magic เหมือนบนบอร์ด; หน่วยความจำพูลจองจาก TLSF arena
+// และ fallback ไป TLSF เหมือน smart_pool_malloc() -> heap_caps_malloc()
+typedef struct memory_block {
+    struct memory_block* next;
+    uint32_t magic;
+    uint32_t pool_id;
+    uint64_t alloc_time;
+} memory_block_t;
+
+typedef struct {
+    size_t          block_size;
+    size_t          block_count;
+    uint8_t*        pool_memory;
+    memory_block_t* free_list;
+    uint32_t        pool_id;
+} bench_pool_t;
+
+#define POOL_COUNT        4
+#define POOL_ALIGNMENT    4
+#define POOL_MAGIC_FREE   0xDEADBEEF
+#define POOL_MAGIC_ALLOC  0xCAFEBABE
+
+static const size_t POOL_CFG[POOL_COUNT][2] = {
+    {   64, 32 },   // Small
+    {  256, 16 },   // Medium
+    { 1024,  8 },   // Large
+    { 4096,  4 },   // Huge
+};
+
+static bench_pool_t g_pools[POOL_COUNT];
+static uint32_t     g_pool_fallbacks = 0;
+
+static inline size_t pool_total_block_size(const bench_pool_t* p) {
+    size_t aligned = (p->block_size + POOL_ALIGNMENT - 1) & ~(size_t)(POOL_ALIGNMENT - 1);
+    return sizeof(memory_block_t) + aligned;
+}
+
+static bool pools_init(size_t arena_bytes) {
+    if (!tlsf_init(arena_bytes)) return false;
+    g_pool_fallbacks = 0;
+    for (int i = 0; i < POOL_COUNT; i++) {
+        bench_pool_t* p = &g_pools[i];
+        memset(p, 0, sizeof(*p));
+        p->block_size  = POOL_CFG[i][0];
+        p->block_count = POOL_CFG[i][1];
+        p->pool_id     = (uint32_t)i + 1;
+
+        size_t total_block = pool_total_block_size(p);
+        p->pool_memory = tlsf_arena_malloc(&g_tlsf, total_block * p->block_count);
+        if (!p->pool_memory) return false;
+        for (size_t k = 0; k < p->block_count; k++) {
+            memory_block_t* blk = (memory_block_t*)(p->pool_memory + k * total_block);
+            blk->magic = POOL_MAGIC_FREE;
+            blk->pool_id = p->pool_id;
+            blk->next = p->free_list;
+            p->free_list = blk;
+        }
+    }
+    return true;
+}
+
+static void* pools_alloc(size_t size) {
+    size_t req = size + 16; // margin เท่ากับ smart_pool_malloc
+    for (int i = 0; i < POOL_COUNT; i++) {
+        bench_pool_t* p = &g_pools[i];
+        if (req <= p->block_size && p->free_list) {
+            memory_block_t* blk = p->free_list;
+            p->free_list = blk->next;
+            blk->magic = POOL_MAGIC_ALLOC;
+            return (uint8_t*)blk + sizeof(memory_block_t);
+        }
+    }
+    void* hp = tlsf_arena_malloc(&g_tlsf, size);
+    if (hp) g_pool_fallbacks++;
+    return hp;
+}
+
+static void pools_release(void* ptr) {
+    if (!ptr) return;
+    // บนบอร์ดเช็ค magic อย่างเดียว; ที่นี่เช็คช่วง address ก่อนเพื่อไม่อ่าน header ของบล็อก TLSF
+    for (int i = 0; i < POOL_COUNT; i++) {
+        bench_pool_t* p = &g_pools[i];
+        uint8_t* end = p->pool_memory + pool_total_block_size(p) * p->block_count;
+        if ((uint8_t*)ptr > p->pool_memory && (uint8_t*)ptr < end) {
+            memory_block_t* blk = (memory_block_t*)((uint8_t*)ptr - sizeof(memory_block_t));
+            if (blk->magic == POOL_MAGIC_ALLOC && blk->pool_id == p->pool_id) {
+                blk->magic = POOL_MAGIC_FREE;
+                blk->next = p->free_list;
+                p->free_list = blk;
+            }
+            return;
+        }
+    }
+    tlsf_arena_free(&g_tlsf, ptr);
+}
+
+static void pools_usage(backend_usage_t* out) {
+    tlsf_usage(out);
+    out->fallbacks = g_pool_fallbacks;
+}
+
+const alloc_backend_t backend_pools = {
+    "pools", pools_init, tlsf_deinit, pools_alloc, pools_release, pools_usage
+};
+
+// ===== 4) Buddy arena =====
+// side table ของ buddy คิดรวมในงบ arena เดียวกัน (ตัดจากท้าย region)
+#define BUDDY_MIN_LOG2  6   // บล็อกเล็กสุด 64 B
+
+static buddy_arena_t g_buddy;
+static uint8_t*      g_buddy_mem = NULL;
+static size_t        g_buddy_bytes = 0;
+
+static bool buddy_init(size_t arena_bytes) {
+    g_buddy_mem = malloc(arena_bytes);
+    g_buddy_bytes = arena_bytes;
+    if (!g_buddy_mem) return false;
+    size_t meta = buddy_arena_meta_size(arena_bytes, BUDDY_MIN_LOG2);
+    return buddy_arena_init(&g_buddy, g_buddy_mem, arena_bytes - meta, BUDDY_MIN_LOG2,
+                            g_buddy_mem + arena_bytes - meta);
+}
+
+static void buddy_deinit(void) {
+    free(g_buddy_mem);
+    g_buddy_mem = NULL;
+}
+
+static void* buddy_alloc(size_t size) { return buddy_arena_malloc(&g_buddy, size); }
+static void  buddy_release(void* p)   { buddy_arena_free(&g_buddy, p); }
+
+static void buddy_usage(backend_usage_t* out) {
+    memset(out, 0, sizeof(*out));
+    out->arena_bytes  = g_buddy_bytes;
+    out->free_bytes   = g_buddy.free_bytes;
+    out->used_bytes   = g_buddy_bytes - g_buddy.free_bytes;   // รวม meta + เศษที่ไม่ลง 2^k
+    out->largest_free = buddy_arena_largest_free(&g_buddy);
+}
+
+const alloc_backend_t backend_buddy = {
+    "buddy", buddy_init, buddy_deinit, buddy_alloc, buddy_release, buddy_usage
+};
@@ -0,0 +1,30 @@
+#ifndef ALLOC_BACKENDS_H
+#define ALLOC_BACKENDS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    size_t   arena_bytes;   // งบ RAM ของ backend (0 = ไม่จำกัด)
+    size_t   used_bytes;    // payload + header + internal fragmentation
+    size_t   free_bytes;
+    size_t   largest_free;
+    uint32_t fallbacks;     // pools: จำนวนครั้งที่หลุดไป heap
+} backend_usage_t;
+
+typedef struct {
+    const char* name;
+    bool  (*init)(size_t arena_bytes);
+    void  (*deinit)(void);
+    void* (*alloc)(size_t size);
+    void  (*release)(void* ptr);
+    void  (*usage)(backend_usage_t* out);
+} alloc_backend_t;
+
+extern const alloc_backend_t backend_sys;     // malloc ของ host (อ้างอิงเท่านั้น)
+extern const alloc_backend_t backend_tlsf;    // จำลอง heap_caps (TLSF) บน arena
+extern const alloc_backend_t backend_pools;   // pools จาก memory_pools.c + fallback TLSF
+extern const alloc_backend_t backend_buddy;   // buddy arena
+
+#endif
@@ -0,0 +1,154 @@
+#include <stdlib.h>
+#include <string.h>
+#include "alloc_trace.h"
+
+// ===== พารามิเตอร์เดียวกับบนบอร์ด =====
+// heap_management.c
+static const uint32_t NORMAL_SIZES[] = { 256, 512, 1024, 2048, 4096 };
+#define LEAK_PROB_PERCENT   35
+#define LEAK_MIN_SIZE       1024
+#define LEAK_MAX_SIZE       8192
+#define LEAK_BUCKET_MAX     64
+#define REPORT_INTERVAL_MS  7000
+// memory_optimization.c
+static const uint32_t REGION_SIZES[] = { 1024, 2048, 4096, 8192, 16384 };
+#define REGION_SLOTS        16
+#define REGION_PERIOD_MS    15000
+
+static const char* const KIND_NAMES[TRACE_KIND_COUNT] = { "normal", "leak", "region", "mixed" };
+
+const char* alloc_trace_kind_name(trace_kind_t kind) {
+    return (kind < TRACE_KIND_COUNT) ? KIND_NAMES[kind] : "?";
+}
+
+// xorshift32: trace เดิมทุกครั้งที่ใช้ seed เดิม (แทน esp_random)
+static uint32_t rnd(alloc_trace_t* t) {
+    uint32_t x = t->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return t->rng = x;
+}
+
+static bool push_op(alloc_trace_t* t, uint8_t op, uint32_t time_ms, uint32_t id, uint32_t size) {
+    if (t->count == t->cap) {
+        size_t ncap = t->cap ? t->cap * 2 : 4096;
+        trace_op_t* n = realloc(t->ops, ncap * sizeof(trace_op_t));
+        if (!n) return false;
+        t->ops = n;
+        t->cap = ncap;
+    }
+    trace_op_t* o = &t->ops[t->count];
+    o->op = op;
+    o->time_ms = time_ms;
+    o->id = id;
+    o->size = size;
+    o->seq = (uint32_t)t->count;
+    t->count++;
+    return true;
+}
+
+static uint32_t new_alloc(alloc_trace_t* t, uint32_t time_ms, uint32_t size) {
+    uint32_t id = t->alloc_count++;
+    push_op(t, TRACE_OP_ALLOC, time_ms, id, size);
+    return id;
+}
+
+// ===== Generators =====
+// normal_workload_task: จอง -> ถือ 50–150ms -> คืน -> พัก 80–200ms
+static void gen_normal(alloc_trace_t* t, uint32_t end_ms) {
+    const int N = sizeof(NORMAL_SIZES) / sizeof(NORMAL_SIZES[0]);
+    uint32_t now = 0;
+    while (now < end_ms) {
+        uint32_t id = new_alloc(t, now, NORMAL_SIZES[rnd(t) % N]);
+        now += 50 + (rnd(t) % 100);
+        push_op(t, TRACE_OP_FREE, now, id, 0);
+        now += 80 + (rnd(t) % 120);
+    }
+}
+
+// leak_generator_task + reporter_task (กู้คืนบางส่วนทุก ๆ 4 รอบรายงาน)
+static void gen_leak(alloc_trace_t* t, uint32_t end_ms) {
+    uint32_t bucket[LEAK_BUCKET_MAX];
+    int bucket_n = 0;
+    uint32_t next_leak = 0, next_report = REPORT_INTERVAL_MS, report_tick = 0;
+
+    while (next_leak < end_ms || next_report < end_ms) {
+        if (next_leak <= next_report) {
+            uint32_t now = next_leak;
+            uint32_t sz = LEAK_MIN_SIZE + (rnd(t) % (LEAK_MAX_SIZE - LEAK_MIN_SIZE + 1));
+            bool will_leak = (rnd(t) % 100) < LEAK_PROB_PERCENT;
+            uint32_t id = new_alloc(t, now, sz);
+            if (will_leak && bucket_n < LEAK_BUCKET_MAX) {
+                bucket[bucket_n++] = id;
+            } else {
+                now += 150 + (rnd(t) % 200);
+                push_op(t, TRACE_OP_FREE, now, id, 0);
+            }
+            next_leak = now + 300 + (rnd(t) % 400);
+        } else {
+            if ((report_tick++ % 4) == 3 && bucket_n > 0) {
+                int to_recover = 1 + (int)(rnd(t) % (uint32_t)bucket_n);
+                for (int i = 0; i < to_recover && bucket_n > 0; i++) {
+                    push_op(t, TRACE_OP_FREE, next_report + 20 * (uint32_t)i, bucket[--bucket_n], 0);
+                }
+            }
+            next_report += REPORT_INTERVAL_MS;
+        }
+    }
+}
+
+// region_monitor_task: ทุก 15s สลับ จอง/คืน 16 ช่องตาม pattern 1/2/4/8/16 KB
+static void gen_region(alloc_trace_t* t, uint32_t end_ms) {
+    const int N = sizeof(REGION_SIZES) / sizeof(REGION_SIZES[0]);
+    uint32_t slot_id[REGION_SLOTS];
+    bool     slot_used[REGION_SLOTS] = { false };
+
+    for (uint32_t now = 0; now < end_ms; now += REGION_PERIOD_MS) {
+        for (int i = 0; i < REGION_SLOTS; i++) {
+            if (!slot_used[i]) {
+                slot_id[i] = new_alloc(t, now, REGION_SIZES[i % N]);
+                slot_used[i] = true;
+            } else {
+                push_op(t, TRACE_OP_FREE, now, slot_id[i], 0);
+                slot_used[i] = false;
+            }
+        }
+    }
+}
+
+static int cmp_op(const void* a, const void* b) {
+    const trace_op_t* x = a;
+    const trace_op_t* y = b;
+    if (x->time_ms != y->time_ms) return (x->time_ms < y->time_ms) ? -1 : 1;
+    return (x->seq < y->seq) ? -1 : (x->seq > y->seq);
+}
+
+bool alloc_trace_generate(alloc_trace_t* t, trace_kind_t kind, uint32_t duration_s, uint32_t seed) {
+    memset(t, 0, sizeof(*t));
+    t->name = alloc_trace_kind_name(kind);
+    t->rng = seed ? seed : 0x2545F491u;
+    uint32_t end_ms = duration_s * 1000u;
+
+    switch (kind) {
+        case TRACE_NORMAL: gen_normal(t, end_ms); break;
+        case TRACE_LEAK:   gen_leak(t, end_ms);   break;
+        case TRACE_REGION: gen_region(t, end_ms); break;
+        case TRACE_MIXED:
+            gen_normal(t, end_ms);
+            gen_leak(t, end_ms);
+            gen_region(t, end_ms);
+            break;
+        default: return false;
+    }
+    if (!t->ops) return false;
+
+    // เรียงตามเวลา; op ที่เวลาเท่ากันคงลำดับตอนสร้าง
+    qsort(t->ops, t->count, sizeof(trace_op_t), cmp_op);
+    return true;
+}
+
+void alloc_trace_release(alloc_trace_t* t) {
+    free(t->ops);
+    memset(t, 0, sizeof(*t));
+}
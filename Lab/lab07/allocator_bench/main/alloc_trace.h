@@ -0,0 +1,45 @@
+#ifndef ALLOC_TRACE_H
+#define ALLOC_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// ===== Allocation trace =====
+// ลำดับ alloc/free ตามเวลาจำลองบนบอร์ด; id = ลำดับการ alloc (ใช้จับคู่กับ free)
+
+typedef enum {
+    TRACE_OP_ALLOC = 0,
+    TRACE_OP_FREE
+} trace_op_kind_t;
+
+typedef struct {
+    uint32_t time_ms;
+    uint32_t id;
+    uint32_t size;      // ใช้เฉพาะ ALLOC
+    uint32_t seq;       // ลำดับตอนสร้าง (ให้ sort แบบ stable)
+    uint8_t  op;
+} trace_op_t;
+
+typedef enum {
+    TRACE_NORMAL = 0,   // normal_workload_task   (heap_management.c)
+    TRACE_LEAK,         // leak_generator_task + reporter recovery (heap_management.c)
+    TRACE_REGION,       // region_monitor_task stress 1/2/4/8/16 KB (memory_optimization.c)
+    TRACE_MIXED,        // ทั้งสามรันพร้อมกัน
+    TRACE_KIND_COUNT
+} trace_kind_t;
+
+typedef struct {
+    const char* name;
+    trace_op_t* ops;
+    size_t      count;
+    size_t      cap;
+    uint32_t    alloc_count;    // = จำนวน id
+    uint32_t    rng;
+} alloc_trace_t;
+
+bool alloc_trace_generate(alloc_trace_t* t, trace_kind_t kind, uint32_t duration_s, uint32_t seed);
+void alloc_trace_release(alloc_trace_t* t);
+const char* alloc_trace_kind_name(trace_kind_t kind);
+
+#endif
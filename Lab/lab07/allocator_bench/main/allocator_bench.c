@@ -0,0 +1,236 @@
+// main/allocator_bench.c — Host allocator replay benchmark (target = linux)
+//
+//   idf.py --preview set-target linux
+//   idf.py build
+//   ./build/allocator_bench.elf > bench.csv
+//
+// สร้าง trace การจอง/คืนหน่วยความจำแบบเดียวกับ normal_workload_task, leak_generator_task
+// (heap_management.c) และ stress ของ region_monitor_task (memory_optimization.c)
+// แล้ว replay กับ allocator แต่ละแบบภายใต้งบ RAM เท่ากัน:
+//   sys   = malloc ของ host (baseline ด้าน throughput)
+//   tlsf  = โมเดล heap_caps_malloc บนบอร์ด (ESP-IDF ใช้ TLSF)
+//   pools = พูลจาก memory_pools.c + fallback heap
+//   buddy = buddy arena
+// รายงาน throughput, latency p50/p99/max, peak footprint และ fragmentation ตามเวลา
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+#include "alloc_trace.h"
+#include "alloc_backends.h"
+
+static const char *TAG = "ALLOC_BENCH";
+
+// ===== Config =====
+#define ARENA_BYTES        (256 * 1024)    // ประมาณ internal heap ที่เหลือบน ESP32
+#define SIM_DURATION_S     3600            // เวลาจำลองบนบอร์ด 1 ชั่วโมง
+#define TRACE_SEED         12345
+#define THROUGHPUT_PASSES  20              // replay ซ้ำเพื่อวัด ops/s
+#define SERIES_POINTS      12              // จุด fragmentation ต่อ trace
+
+static const alloc_backend_t* const BACKENDS[] = {
+    &backend_sys, &backend_tlsf, &backend_pools, &backend_buddy
+};
+#define BACKEND_COUNT (sizeof(BACKENDS) / sizeof(BACKENDS[0]))
+
+typedef struct {
+    double   ops_per_s;
+    uint32_t p50_ns;
+    uint32_t p99_ns;
+    uint32_t max_ns;
+    size_t   peak_used;
+    size_t   peak_live;     // ขนาดที่ผู้ใช้ขอ (ไม่รวม overhead)
+    uint32_t fails;
+    uint32_t fallbacks;
+    float    frag_end_pct;
+    float    frag_max_pct;
+} bench_result_t;
+
+// ใช้ clock ของ host ตรง ๆ (ns) เพราะ esp_timer ละเอียดแค่ μs
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// นิยามเดียวกับ memory_optimization.c: 1 - largest_free / total_free
+static float frag_pct(const backend_usage_t* u) {
+    if (u->free_bytes == 0 || u->largest_free == 0) return 0.0f;
+    return (1.0f - (float)u->largest_free / (float)u->free_bytes) * 100.0f;
+}
+
+// ===== Replay =====
+// pass วัดละเอียด: จับเวลาทีละ op + เก็บ footprint/fragmentation
+static bool replay_instrumented(const alloc_backend_t* be, const alloc_trace_t* tr,
+                                void** live, uint32_t* sizes, uint32_t* lat, bench_result_t* r)
+{
+    if (!be->init(ARENA_BYTES)) {
+        ESP_LOGE(TAG, "%s: init failed", be->name);
+        return false;
+    }
+    memset(live, 0, tr->alloc_count * sizeof(void*));
+
+    size_t live_bytes = 0;
+    size_t sample_every = tr->count / SERIES_POINTS + 1;
+    backend_usage_t u;
+
+    for (size_t i = 0; i < tr->count; i++) {
+        const trace_op_t* op = &tr->ops[i];
+        uint64_t t0 = now_ns();
+        if (op->op == TRACE_OP_ALLOC) {
+            live[op->id] = be->alloc(op->size);
+        } else {
+            be->release(live[op->id]);
+        }
+        lat[i] = (uint32_t)(now_ns() - t0);
+
+        if (op->op == TRACE_OP_ALLOC) {
+            if (live[op->id]) {
+                sizes[op->id] = op->size;
+                live_bytes += op->size;
+                if (live_bytes > r->peak_live) r->peak_live = live_bytes;
+            } else {
+                r->fails++;
+            }
+            be->usage(&u);
+            if (u.used_bytes > r->peak_used) r->peak_used = u.used_bytes;
+        } else if (live[op->id]) {
+            live_bytes -= sizes[op->id];
+            live[op->id] = NULL;
+        }
+
+        if ((i % sample_every) == 0 || i + 1 == tr->count) {
+            be->usage(&u);
+            float f = frag_pct(&u);
+            if (f > r->frag_max_pct) r->frag_max_pct = f;
+            r->frag_end_pct = f;
+            // series,<trace>,<backend>,<sim_s>,<live>,<used>,<free>,<largest>,<frag%>
+            printf("series,%s,%s,%u,%u,%u,%u,%u,%.1f\n",
+                   tr->name, be->name, (unsigned)(op->time_ms / 1000),
+                   (unsigned)live_bytes, (unsigned)u.used_bytes, (unsigned)u.free_bytes,
+                   (unsigned)u.largest_free, f);
+        }
+    }
+    be->usage(&u);
+    r->fallbacks = u.fallbacks;
+
+    // คืนของที่ยังค้าง (leak bucket) ก่อนปิด backend
+    for (uint32_t id = 0; id < tr->alloc_count; id++) {
+        if (live[id]) be->release(live[id]);
+    }
+    be->deinit();
+
+    qsort(lat, tr->count, sizeof(uint32_t), cmp_u32);
+    r->p50_ns = lat[tr->count / 2];
+    r->p99_ns = lat[(tr->count * 99) / 100];
+    r->max_ns = lat[tr->count - 1];
+    return true;
+}
+
+// pass วัด throughput: ไม่มี instrumentation ใน loop
+static void replay_throughput(const alloc_backend_t* be, const alloc_trace_t* tr,
+                              void** live, bench_result_t* r)
+{
+    uint64_t total_ns = 0;
+    for (int pass = 0; pass < THROUGHPUT_PASSES; pass++) {
+        if (!be->init(ARENA_BYTES)) return;
+        memset(live, 0, tr->alloc_count * sizeof(void*));
+
+        uint64_t t0 = now_ns();
+        for (size_t i = 0; i < tr->count; i++) {
+            const trace_op_t* op = &tr->ops[i];
+            if (op->op == TRACE_OP_ALLOC) {
+                live[op->id] = be->alloc(op->size);
+            } else {
+                be->release(live[op->id]);
+                live[op->id] = NULL;
+            }
+        }
+        total_ns += now_ns() - t0;
+
+        for (uint32_t id = 0; id < tr->alloc_count; id++) {
+            if (live[id]) be->release(live[id]);
+        }
+        be->deinit();
+    }
+    r->ops_per_s = total_ns ? (double)tr->count * THROUGHPUT_PASSES * 1e9 / (double)total_ns : 0.0;
+}
+
+static void run_trace(trace_kind_t kind) {
+    alloc_trace_t tr;
+    if (!alloc_trace_generate(&tr, kind, SIM_DURATION_S, TRACE_SEED)) {
+        ESP_LOGE(TAG, "trace %s: generate failed", alloc_trace_kind_name(kind));
+        return;
+    }
+
+    void**    live  = calloc(tr.alloc_count, sizeof(void*));
+    uint32_t* sizes = calloc(tr.alloc_count, sizeof(uint32_t));
+    uint32_t* lat   = malloc(tr.count * sizeof(uint32_t));
+    bench_result_t res[BACKEND_COUNT];
+    memset(res, 0, sizeof(res));
+
+    if (!live || !sizes || !lat) {
+        ESP_LOGE(TAG, "trace %s: out of memory", tr.name);
+    } else {
+        ESP_LOGI(TAG, "trace %s: %u ops, %u allocs", tr.name, (unsigned)tr.count, (unsigned)tr.alloc_count);
+        for (size_t b = 0; b < BACKEND_COUNT; b++) {
+            if (replay_instrumented(BACKENDS[b], &tr, live, sizes, lat, &res[b])) {
+                replay_throughput(BACKENDS[b], &tr, live, &res[b]);
+            }
+        }
+
+        printf("\n=== trace: %s (arena %u KB, %u s simulated) ===\n",
+               tr.name, (unsigned)(ARENA_BYTES / 1024), (unsigned)SIM_DURATION_S);
+        printf("%-6s %12s %8s %8s %9s %10s %10s %6s %6s %9s %9s\n",
+               "alloc", "ops/s", "p50 ns", "p99 ns", "max ns",
+               "peak used", "peak live", "fails", "fback", "frag end", "frag max");
+        for (size_t b = 0; b < BACKEND_COUNT; b++) {
+            const bench_result_t* r = &res[b];
+            printf("%-6s %12.0f %8u %8u %9u %10u %10u %6u %6u %8.1f%% %8.1f%%\n",
+                   BACKENDS[b]->name, r->ops_per_s, r->p50_ns, r->p99_ns, r->max_ns,
+                   (unsigned)r->peak_used, (unsigned)r->peak_live, r->fails, r->fallbacks,
+                   r->frag_end_pct, r->frag_max_pct);
+        }
+        // summary,<trace>,<backend>,<ops/s>,<p50>,<p99>,<max>,<peak_used>,<peak_live>,<fails>,<fallbacks>,<frag_end>,<frag_max>
+        for (size_t b = 0; b < BACKEND_COUNT; b++) {
+            const bench_result_t* r = &res[b];
+            printf("summary,%s,%s,%.0f,%u,%u,%u,%u,%u,%u,%u,%.1f,%.1f\n",
+                   tr.name, BACKENDS[b]->name, r->ops_per_s, r->p50_ns, r->p99_ns, r->max_ns,
+                   (unsigned)r->peak_used, (unsigned)r->peak_live, r->fails, r->fallbacks,
+                   r->frag_end_pct, r->frag_max_pct);
+        }
+        printf("\n");
+    }
+
+    free(live);
+    free(sizes);
+    free(lat);
+    alloc_trace_release(&tr);
+}
+
+void app_main(void)
+{
+    ESP_LOGI(TAG, "Allocator replay benchmark: sys vs tlsf vs pools vs buddy");
+    ESP_LOGI(TAG, "arena=%u bytes, duration=%us, seed=%u",
+             (unsigned)ARENA_BYTES, (unsigned)SIM_DURATION_S, (unsigned)TRACE_SEED);
+
+    for (int k = 0; k < TRACE_KIND_COUNT; k++) {
+        run_trace((trace_kind_t)k);
+    }
+
+    ESP_LOGI(TAG, "Benchmark done");
+    fflush(stdout);
+    exit(0);
+}
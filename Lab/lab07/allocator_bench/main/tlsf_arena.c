@@ -0,0 +1,195 @@
+#include <string.h>
+#include "tlsf_arena.h"
+
+// ===== Block layout =====
+// [prev_phys | size+flags | payload ...] ; บล็อกว่างเก็บ next/prev free ไว้ใน payload
+struct tlsf_block {
+    tlsf_block_t* prev_phys;    // ใช้ได้เมื่อบล็อกก่อนหน้าว่าง (PREV_FREE)
+    size_t        size;         // ขนาด payload | flags
+    tlsf_block_t* next_free;    // เฉพาะบล็อกว่าง
+    tlsf_block_t* prev_free;
+};
+
+#define BLOCK_FREE       ((size_t)1)
+#define BLOCK_PREV_FREE  ((size_t)2)
+#define BLOCK_FLAGS      (BLOCK_FREE | BLOCK_PREV_FREE)
+
+#define HDR_SIZE         offsetof(tlsf_block_t, next_free)
+#define MIN_PAYLOAD      (sizeof(tlsf_block_t) - HDR_SIZE)
+#define ALIGN_SIZE       ((size_t)1 << TLSF_ALIGN_LOG2)
+#define SMALL_BLOCK      ((size_t)1 << TLSF_FL_SHIFT)
+
+static inline size_t align_up(size_t x)  { return (x + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1); }
+static inline size_t align_down(size_t x){ return x & ~(ALIGN_SIZE - 1); }
+
+static inline size_t blk_size(const tlsf_block_t* b)   { return b->size & ~BLOCK_FLAGS; }
+static inline bool   blk_is_free(const tlsf_block_t* b){ return (b->size & BLOCK_FREE) != 0; }
+static inline void   blk_set_size(tlsf_block_t* b, size_t s) { b->size = s | (b->size & BLOCK_FLAGS); }
+
+static inline tlsf_block_t* blk_next(const tlsf_block_t* b) {
+    return (tlsf_block_t*)((uint8_t*)b + HDR_SIZE + blk_size(b));
+}
+static inline void* blk_payload(const tlsf_block_t* b) { return (uint8_t*)b + HDR_SIZE; }
+static inline tlsf_block_t* blk_from_ptr(const void* p) { return (tlsf_block_t*)((uint8_t*)p - HDR_SIZE); }
+
+static inline int fls_sz(size_t x) { return (int)(sizeof(size_t) * 8 - 1) - __builtin_clzl((unsigned long)x); }
+static inline int ffs_u32(uint32_t x) { return __builtin_ctz(x); }
+
+// ===== Size -> (fl, sl) =====
+static void mapping_insert(size_t size, int* fl, int* sl) {
+    if (size < SMALL_BLOCK) {
+        *fl = 0;
+        *sl = (int)(size / (SMALL_BLOCK / TLSF_SL_COUNT));
+    } else {
+        int f = fls_sz(size);
+        *sl = (int)(size >> (f - TLSF_SL_LOG2)) ^ (int)TLSF_SL_COUNT;
+        *fl = f - (TLSF_FL_SHIFT - 1);
+    }
+}
+
+// ปัดขึ้นให้บล็อกแรกใน list ใช้ได้ทันที (good-fit, O(1))
+static void mapping_search(size_t size, int* fl, int* sl) {
+    if (size >= SMALL_BLOCK) {
+        size += ((size_t)1 << (fls_sz(size) - TLSF_SL_LOG2)) - 1;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+// ===== Free lists =====
+static void list_insert(tlsf_arena_t* a, tlsf_block_t* b) {
+    int fl, sl;
+    mapping_insert(blk_size(b), &fl, &sl);
+    b->prev_free = NULL;
+    b->next_free = a->blocks[fl][sl];
+    if (b->next_free) b->next_free->prev_free = b;
+    a->blocks[fl][sl] = b;
+    a->fl_bitmap     |= (1u << fl);
+    a->sl_bitmap[fl] |= (1u << sl);
+    a->free_bytes += blk_size(b);
+}
+
+static void list_remove(tlsf_arena_t* a, tlsf_block_t* b) {
+    int fl, sl;
+    mapping_insert(blk_size(b), &fl, &sl);
+    if (b->prev_free) b->prev_free->next_free = b->next_free;
+    else              a->blocks[fl][sl] = b->next_free;
+    if (b->next_free) b->next_free->prev_free = b->prev_free;
+    if (!a->blocks[fl][sl]) {
+        a->sl_bitmap[fl] &= ~(1u << sl);
+        if (!a->sl_bitmap[fl]) a->fl_bitmap &= ~(1u << fl);
+    }
+    a->free_bytes -= blk_size(b);
+}
+
+static tlsf_block_t* find_suitable(tlsf_arena_t* a, int fl, int sl) {
+    if (fl >= TLSF_FL_COUNT) return NULL;
+    uint32_t sl_map = a->sl_bitmap[fl] & (~0u << sl);
+    if (!sl_map) {
+        uint32_t fl_map = (fl + 1 < 32) ? (a->fl_bitmap & (~0u << (fl + 1))) : 0;
+        if (!fl_map) return NULL;
+        fl = ffs_u32(fl_map);
+        sl_map = a->sl_bitmap[fl];
+    }
+    return a->blocks[fl][ffs_u32(sl_map)];
+}
+
+// ===== Public API =====
+bool tlsf_arena_init(tlsf_arena_t* a, void* mem, size_t bytes) {
+    memset(a, 0, sizeof(*a));
+    uintptr_t start = ((uintptr_t)mem + ALIGN_SIZE - 1) & ~(uintptr_t)(ALIGN_SIZE - 1);
+    size_t usable = align_down(bytes - (size_t)(start - (uintptr_t)mem));
+    // บล็อกแรก + sentinel (ขนาด 0, สถานะ used) ท้าย region
+    if (usable < 2 * HDR_SIZE + MIN_PAYLOAD) return false;
+    size_t payload = usable - 2 * HDR_SIZE;
+    if (payload >= ((size_t)1 << TLSF_FL_MAX)) payload = ((size_t)1 << TLSF_FL_MAX) - ALIGN_SIZE;
+
+    a->base = (uint8_t*)start;
+    a->size = usable;
+
+    tlsf_block_t* first = (tlsf_block_t*)a->base;
+    first->prev_phys = NULL;
+    first->size = payload | BLOCK_FREE;
+
+    tlsf_block_t* sentinel = blk_next(first);
+    sentinel->prev_phys = first;
+    sentinel->size = 0 | BLOCK_PREV_FREE;
+
+    list_insert(a, first);
+    return true;
+}
+
+void* tlsf_arena_malloc(tlsf_arena_t* a, size_t size) {
+    size_t adjust = align_up(size < MIN_PAYLOAD ? MIN_PAYLOAD : size);
+    int fl, sl;
+    mapping_search(adjust, &fl, &sl);
+    tlsf_block_t* b = find_suitable(a, fl, sl);
+    if (!b) {
+        a->fail_count++;
+        return NULL;
+    }
+    list_remove(a, b);
+
+    // split ถ้าเศษที่เหลือพอทำเป็นบล็อกใหม่
+    size_t have = blk_size(b);
+    if (have >= adjust + HDR_SIZE + MIN_PAYLOAD) {
+        blk_set_size(b, adjust);
+        tlsf_block_t* rem = blk_next(b);
+        rem->prev_phys = b;
+        rem->size = (have - adjust - HDR_SIZE) | BLOCK_FREE;   // บล็อกก่อนหน้า (b) กำลังจะ used
+        blk_next(rem)->prev_phys = rem;
+        blk_next(rem)->size |= BLOCK_PREV_FREE;
+        list_insert(a, rem);
+    } else {
+        blk_next(b)->size &= ~BLOCK_PREV_FREE;
+    }
+    b->size &= ~BLOCK_FREE;
+
+    a->used_bytes += blk_size(b) + HDR_SIZE;
+    if (a->used_bytes > a->peak_used) a->peak_used = a->used_bytes;
+    a->alloc_count++;
+    return blk_payload(b);
+}
+
+void tlsf_arena_free(tlsf_arena_t* a, void* ptr) {
+    if (!ptr) return;
+    tlsf_block_t* b = blk_from_ptr(ptr);
+    a->used_bytes -= blk_size(b) + HDR_SIZE;
+    b->size |= BLOCK_FREE;
+
+    // coalesce กับบล็อกก่อนหน้า
+    if (b->size & BLOCK_PREV_FREE) {
+        tlsf_block_t* prev = b->prev_phys;
+        list_remove(a, prev);
+        blk_set_size(prev, blk_size(prev) + HDR_SIZE + blk_size(b));
+        b = prev;
+    }
+    // coalesce กับบล็อกถัดไป
+    tlsf_block_t* next = blk_next(b);
+    if (blk_is_free(next)) {
+        list_remove(a, next);
+        blk_set_size(b, blk_size(b) + HDR_SIZE + blk_size(next));
+        next = blk_next(b);
+    }
+    next->prev_phys = b;
+    next->size |= BLOCK_PREV_FREE;
+    list_insert(a, b);
+}
+
+size_t tlsf_arena_block_size(const void* ptr) {
+    return ptr ? blk_size(blk_from_ptr(ptr)) : 0;
+}
+
+size_t tlsf_arena_largest_free(const tlsf_arena_t* a) {
+    if (!a->fl_bitmap) return 0;
+    int fl = fls_sz(a->fl_bitmap);
+    int sl = fls_sz(a->sl_bitmap[fl]);
+    size_t best = 0;
+    for (const tlsf_block_t* b = a->blocks[fl][sl]; b; b = b->next_free) {
+        if (blk_size(b) > best) best = blk_size(b);
+    }
+    return best;
+}
+
+size_t tlsf_arena_overhead(void) {
+    return HDR_SIZE;
+}
@@ -0,0 +1,42 @@
+#ifndef TLSF_ARENA_H
+#define TLSF_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// TLSF (Two-Level Segregated Fit) บน region เดียว
+// ใช้จำลอง heap ของ ESP-IDF (multi_heap ใช้ TLSF ตั้งแต่ v5.0) บน host
+// ให้วัด footprint/fragmentation ได้ภายใต้งบ RAM เท่ากับ allocator ตัวอื่น
+
+#define TLSF_SL_LOG2     5                          // 32 second-level lists
+#define TLSF_SL_COUNT    (1u << TLSF_SL_LOG2)
+#define TLSF_ALIGN_LOG2  3                          // 8-byte alignment
+#define TLSF_FL_SHIFT    (TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_FL_MAX      24                         // region สูงสุด 16 MB
+#define TLSF_FL_COUNT    (TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+
+typedef struct tlsf_block tlsf_block_t;
+
+typedef struct {
+    uint8_t*      base;
+    size_t        size;
+    uint32_t      fl_bitmap;
+    uint32_t      sl_bitmap[TLSF_FL_COUNT];
+    tlsf_block_t* blocks[TLSF_FL_COUNT][TLSF_SL_COUNT];
+    // stats
+    size_t        free_bytes;     // payload ที่ว่างรวม
+    size_t        used_bytes;     // payload + header ของบล็อกที่ถูกจอง
+    size_t        peak_used;
+    uint32_t      alloc_count;
+    uint32_t      fail_count;
+} tlsf_arena_t;
+
+bool   tlsf_arena_init(tlsf_arena_t* a, void* mem, size_t bytes);
+void*  tlsf_arena_malloc(tlsf_arena_t* a, size_t size);
+void   tlsf_arena_free(tlsf_arena_t* a, void* ptr);
+size_t tlsf_arena_block_size(const void* ptr);          // payload ที่ได้จริง
+size_t tlsf_arena_largest_free(const tlsf_arena_t* a);
+size_t tlsf_arena_overhead(void);                        // header ต่อบล็อก
+
+#endif
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_heap_caps.h"
+#include "handle_heap.h"
+
+static const char *TAG = "HANDLE_HEAP_LAB";
+
+// ===== Config =====
+#define HEAP_BYTES          (64 * 1024)     // จองครั้งเดียวตอนบูต
+#define MAX_HANDLES         64
+#define STRESS_SLOTS        12
+#define MIN_BUF             512
+#define MAX_BUF             (8 * 1024)
+#define BIG_PROBE           (16 * 1024)     // บัฟเฟอร์ใหญ่ที่ต้องการช่องต่อเนื่อง
+#define PINNED_EVERY        8               // 1 ใน 8 ถูก lock ค้างไว้ (เช่นกำลังส่ง DMA)
+
+#define COMPACTOR_PRIORITY  1               // ต่ำกว่างานจริงทั้งหมด
+#define COMPACTOR_PERIOD_MS 500
+#define FRAG_THRESHOLD_PCT  30.0f
+
+static handle_heap_t hheap;
+
+typedef struct {
+    hh_handle_t h;
+    uint32_t    size;
+    uint8_t     pattern;
+    bool        pinned;         // lock ค้างไว้ -> compactor ย้ายไม่ได้
+    uint8_t     ttl;            // จำนวนรอบก่อน unlock
+} slot_t;
+
+static slot_t slots[STRESS_SLOTS];
+static uint32_t verify_errors = 0;
+
+static inline uint32_t rand_range(uint32_t lo, uint32_t hi) {
+    return lo + esp_random() % (hi - lo + 1);
+}
+
+static float frag_pct(const handle_heap_stats_t* st) {
+    if (st->free_bytes == 0 || st->largest_free == 0) return 0.0f;
+    return (1.0f - (float)st->largest_free / (float)st->free_bytes) * 100.0f;
+}
+
+// เขียน pattern ตอนจอง ตรวจตอนคืน: ยืนยันว่าข้อมูลยังถูกต้องหลังถูกย้าย
+static bool fill_slot(slot_t* s) {
+    uint8_t* p = handle_heap_lock(&hheap, s->h);
+    if (!p) return false;
+    memset(p, s->pattern, s->size);
+    if (!s->pinned) handle_heap_unlock(&hheap, s->h);
+    return true;
+}
+
+static void check_and_free(slot_t* s) {
+    uint8_t* p = handle_heap_lock(&hheap, s->h);
+    if (p) {
+        for (uint32_t i = 0; i < s->size; i++) {
+            if (p[i] != s->pattern) { verify_errors++; break; }
+        }
+        handle_heap_unlock(&hheap, s->h);
+    }
+    if (s->pinned) handle_heap_unlock(&hheap, s->h);
+    handle_heap_free(&hheap, s->h);
+    memset(s, 0, sizeof(*s));
+}
+
+// ===== Stress: จอง/คืนขนาดสุ่มจนพื้นที่ว่างแตกเป็นชิ้น =====
+static void stress_task(void *pv) {
+    uint32_t round = 0;
+    while (1) {
+        round++;
+        for (int i = 0; i < STRESS_SLOTS; i++) {
+            slot_t* s = &slots[i];
+            if (s->h) {
+                if (s->pinned && s->ttl && --s->ttl == 0) {
+                    handle_heap_unlock(&hheap, s->h);
+                    s->pinned = false;
+                }
+                if ((esp_random() % 3) == 0) check_and_free(s);
+                continue;
+            }
+            if ((esp_random() % 2) == 0) continue;
+
+            s->size = rand_range(MIN_BUF, MAX_BUF);
+            s->h = handle_heap_alloc(&hheap, s->size);
+            if (s->h == HH_INVALID_HANDLE) {
+                memset(s, 0, sizeof(*s));
+                continue;
+            }
+            s->pattern = (uint8_t)(round + i);
+            s->pinned = (esp_random() % PINNED_EVERY) == 0;
+            s->ttl = s->pinned ? (uint8_t)rand_range(2, 6) : 0;
+            fill_slot(s);
+        }
+
+        // ลองจองบัฟเฟอร์ใหญ่เป็นระยะ: สำเร็จได้ก็ต่อเมื่อมีช่องว่างต่อเนื่องพอ
+        if ((round % 20) == 0) {
+            hh_handle_t big = handle_heap_alloc(&hheap, BIG_PROBE);
+            if (big) handle_heap_free(&hheap, big);
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+// ===== Report =====
+static void report_task(void *pv) {
+    handle_heap_stats_t st;
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(5000));
+        handle_heap_get_stats(&hheap, &st);
+
+        printf("\n═══ HANDLE HEAP REPORT ═══\n");
+        printf("Region:        %u bytes, used %u, free %u\n",
+               (unsigned)st.total_bytes, (unsigned)st.used_bytes, (unsigned)st.free_bytes);
+        printf("Blocks:        %lu total, %lu free, %lu locked, %lu handles live\n",
+               (unsigned long)st.blocks, (unsigned long)st.free_blocks,
+               (unsigned long)st.locked_blocks, (unsigned long)st.live_handles);
+        printf("Largest free:  %u bytes (frag %.1f%%)\n",
+               (unsigned)st.largest_free, frag_pct(&st));
+        printf("Compaction:    %lu runs, %llu bytes moved\n",
+               (unsigned long)st.compactions, (unsigned long long)st.bytes_moved);
+        printf("Last run:      largest free %u -> %u bytes\n",
+               (unsigned)st.last_largest_before, (unsigned)st.last_largest_after);
+        printf("Alloc fails:   %lu, verify errors: %lu\n",
+               (unsigned long)st.alloc_fail, (unsigned long)verify_errors);
+        printf("System heap:   largest free %u bytes (เทียบ heap_caps)\n",
+               (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+        printf("══════════════════════════\n");
+
+        if (verify_errors) ESP_LOGE(TAG, "Data mismatch after move!");
+    }
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "🚀 Handle-based heap with background compaction");
+
+    // จอง region ก้อนเดียวตอนบูต ก่อนที่ heap จะถูกหั่นเป็นชิ้น
+    if (!handle_heap_create(&hheap, HEAP_BYTES, MAX_HANDLES, MALLOC_CAP_8BIT)) {
+        ESP_LOGE(TAG, "Handle heap create failed");
+        return;
+    }
+    if (!handle_heap_start_compactor(&hheap, COMPACTOR_PRIORITY, COMPACTOR_PERIOD_MS, FRAG_THRESHOLD_PCT)) {
+        ESP_LOGW(TAG, "Compactor not started, compaction only on demand");
+    }
+    ESP_LOGI(TAG, "Region %u bytes, %u handles, compactor prio %u, threshold %.0f%%",
+             (unsigned)HEAP_BYTES, MAX_HANDLES, COMPACTOR_PRIORITY, FRAG_THRESHOLD_PCT);
+
+    xTaskCreate(stress_task, "hh_stress", 3072, NULL, 4, NULL);
+    xTaskCreate(report_task, "hh_report", 3072, NULL, 3, NULL);
+}
@@ -8,6 +8,7 @@
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "esp_heap_caps.h"
+#include "buddy_arena.h"
 
 static const char *TAG = "MEM_REGION_EXP4";
 
@@ -19,6 +20,14 @@ static const char *TAG = "MEM_REGION_EXP4";
 #define UTIL_WARN_PCT         85.0f
 #define FRAG_WARN_PCT         60.0f
 
+// Buddy arena สำหรับบัฟเฟอร์ 2^n (1 = ใช้ arena, 0 = ใช้ heap ตรง ๆ เหมือนเดิม)
+#define USE_BUDDY_ARENA       1
+#define BUDDY_ARENA_BYTES     (96 * 1024)   // จองครั้งเดียวตอนบูต = 64K + 32K
+#define BUDDY_MIN_LOG2        10            // บล็อกเล็กสุด 1 KB (บัฟเฟอร์เล็กสุดของ stress)
+
+static buddy_arena_t buddy;
+static bool buddy_ready = false;
+
 typedef struct {
     const char *name;
     uint32_t caps;
@@ -112,6 +121,24 @@ static void print_region_report(void) {
     ESP_LOGI(TAG, "=====================================\n");
 }
 
+// บัฟเฟอร์ stress: ใช้ buddy arena ก่อน ถ้าเต็มค่อยตกไป heap
+static void *stress_alloc(size_t sz) {
+    if (buddy_ready) {
+        void *p = buddy_arena_malloc(&buddy, sz);
+        if (p) return p;
+        ESP_LOGW(TAG, "Buddy arena full for %u bytes, fallback to heap", (unsigned)sz);
+    }
+    // พยายาม INTERNAL ก่อน ถ้าไม่มีให้ลอง 8BIT
+    void *p = heap_caps_malloc(sz, MALLOC_CAP_INTERNAL);
+    if (!p) p = heap_caps_malloc(sz, MALLOC_CAP_8BIT);
+    return p;
+}
+
+static void stress_free(void *p) {
+    if (buddy_ready && buddy_arena_owns(&buddy, p)) buddy_arena_free(&buddy, p);
+    else heap_caps_free(p);
+}
+
 // ภารกิจหลัก: สแกนซ้ำทุกช่วงเวลา + stress เล็กน้อยเพื่อสังเกต fragmentation
 static void region_monitor_task(void *arg) {
     // บัฟเฟอร์ชั่วคราวสำหรับ stress (จะจอง/คืนแบบสลับขนาด เพื่อสร้าง/สังเกต fragmentation)
@@ -130,19 +157,20 @@ static void region_monitor_task(void *arg) {
         for (int i = 0; i < 16; ++i) {
             if (stress_ptrs[i] == NULL) {
                 size_t sz = pattern_sizes[i % pattern_len];
-                // พยายาม INTERNAL ก่อน ถ้าไม่มีให้ลอง 8BIT
-                void *p = heap_caps_malloc(sz, MALLOC_CAP_INTERNAL);
-                if (!p) p = heap_caps_malloc(sz, MALLOC_CAP_8BIT);
+                void *p = stress_alloc(sz);
                 if (p) {
                     memset(p, 0xCD, sz < 64 ? sz : 64);
                     stress_ptrs[i] = p;
                 }
             } else {
-                heap_caps_free(stress_ptrs[i]);
+                stress_free(stress_ptrs[i]);
                 stress_ptrs[i] = NULL;
             }
         }
 
+        // 3) มุมมองต่อ order ของ buddy arena (ดูว่าเหลือบล็อกขนาดไหนบ้าง)
+        if (buddy_ready) buddy_arena_log_orders(&buddy, TAG);
+
         gpio_set_level(LED_OPTIMIZATION, 0);
         vTaskDelay(pdMS_TO_TICKS(15000)); // เว้น 15 วิ แล้ววนใหม่
     }
@@ -160,6 +188,17 @@ void app_main(void) {
     ESP_LOGI(TAG, "🚀 Experiment 4: Memory Region Analysis & Fragmentation Monitor");
     ESP_LOGI(TAG, "LED19 = analyzing, LED18 = alert (high util/fragmentation)");
 
+#if USE_BUDDY_ARENA
+    // จอง arena ก้อนเดียวตอนบูต ก่อนที่ heap จะถูกหั่นเป็นชิ้น
+    buddy_ready = buddy_arena_create(&buddy, BUDDY_ARENA_BYTES, BUDDY_MIN_LOG2, MALLOC_CAP_INTERNAL);
+    if (buddy_ready) {
+        ESP_LOGI(TAG, "Buddy arena: %u bytes, min block %u bytes",
+                 (unsigned)buddy.size, 1u << BUDDY_MIN_LOG2);
+    } else {
+        ESP_LOGW(TAG, "Buddy arena alloc failed, stress uses heap directly");
+    }
+#endif
+
     // สร้าง task หลัก
     xTaskCreate(region_monitor_task, "region_mon", 4096, NULL, 5, NULL);
 }